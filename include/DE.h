@@ -8,20 +8,85 @@
 #include <utility>
 #include <memory>
 #include <limits>
+#include <functional>
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+#include <chrono>
 
+#include "surrogate.h"
+#include "trace.h"
+#include "random_stream.h"
+#include "thread_pool.h"
+#include "population_stats.h"
+#include "restart.h"
+#include "local_search.h"
+#include "initializer.h"
+#include "dynamic.h"
+#include "cancellation.h"
+#include "perf_counters.h"
 
 
 namespace DE
 {
+    /* VectorView: read-only pointer + length view of an agent (no copy) */
+    class VectorView{
+        private:
+            const double* ptr;
+            unsigned int length;
+
+        public:
+            VectorView(const double* data, unsigned int size) : ptr(data), length(size) {}
+            VectorView(const std::vector<double>& agent) : ptr(agent.data()), length(static_cast<unsigned int>(agent.size())) {}
+
+            const double* data() const { return ptr; }
+            unsigned int size() const { return length; }
+            double operator[](unsigned int i) const { return ptr[i]; }
+            const double* begin() const { return ptr; }
+            const double* end() const { return ptr + length; }
+
+            // 需要std::vector時才複製
+            std::vector<double> ToVector() const
+            {
+                return std::vector<double>(ptr, ptr + length);
+            }
+    };
+
     /* Class-1: Optimize */
     class Optimize{
     public:
         // Forward declaration of Constraint structure
         struct Constraint;
+        struct NonlinearConstraint;
 
         virtual double EvaluateCost(std::vector<double> input) const = 0;
+        // Zero-copy evaluation used by the optimizer. The default copies the
+        // view into the vector overload, so existing subclasses keep working;
+        // override it to read the agent in place.
+        virtual double EvaluateCostView(VectorView input) const
+        {
+            return EvaluateCost(input.ToVector());
+        }
+        // Bounded evaluation: the optimizer only needs the cost if it is at most
+        // threshold. An objective that accumulates its cost may stop as soon as
+        // the cost provably exceeds threshold and return +infinity ("worse than
+        // threshold"); otherwise it must return the exact cost. The default
+        // ignores the threshold.
+        virtual double EvaluateCostBounded(VectorView input, double /*threshold*/) const
+        {
+            return EvaluateCostView(input);
+        }
         virtual unsigned int numOfParameters() const = 0;
         virtual std::vector<Constraint> getConstraints() const = 0;
+        // General inequality/equality constraints, evaluated separately from the cost (default: none)
+        virtual std::vector<NonlinearConstraint> getNonlinearConstraints() const;
+        // Version of the data behind the cost. An objective whose cost changes
+        // over time (e.g. streaming data) returns a new value after every
+        // change; see EnableDynamicObjective. The default never changes.
+        virtual unsigned long long dataVersion() const
+        {
+            return 0;
+        }
         virtual ~Optimize() {};
     };
     
@@ -50,13 +115,259 @@ namespace DE
             }
             return true;   
         }
+
+        // 取樣範圍 (沒有constraint的維度用[-unboundedScale, unboundedScale])
+        double SampleLower(double unboundedScale) const
+        {
+            return isConstrained ? lower : -unboundedScale;
+        }
+
+        double SampleUpper(double unboundedScale) const
+        {
+            return isConstrained ? upper : unboundedScale;
+        }
     };
 
+    // Nonlinear constraint: g(x) <= 0 (Inequality) or |h(x)| <= tolerance (Equality)
+    struct Optimize::NonlinearConstraint
+    {
+        enum Type { Inequality, Equality };
+
+        std::function<double(const std::vector<double>&)> function;
+        Type type;
+        // 相對的evaluation成本 便宜的constraint會先被evaluation
+        double cost;
+        double tolerance;
+
+        NonlinearConstraint(std::function<double(const std::vector<double>&)> function,
+                            Type type = Inequality,
+                            double cost = 1.0,
+                            double tolerance = 0.0) :
+            function(function),
+            type(type),
+            cost(cost),
+            tolerance(tolerance)
+        {
+            assert(function != nullptr && "Constraint function must be defined");
+            assert(tolerance >= 0 && "Tolerance must be non-negative");
+        }
+
+        // 0代表符合constraint 否則回傳違反的量
+        double Violation(const std::vector<double>& agent) const
+        {
+            double value = function(agent);
+            if (type == Equality){
+                return std::max(0.0, std::fabs(value) - tolerance);
+            }
+            return std::max(0.0, value);
+        }
+    };
+
+    inline std::vector<Optimize::NonlinearConstraint> Optimize::getNonlinearConstraints() const
+    {
+        return std::vector<NonlinearConstraint>();
+    }
+
+    // Total violation of constraints (in order); false once it exceeds bound
+    inline bool SumViolations(const std::vector<Optimize::NonlinearConstraint>& constraints,
+                              const std::vector<double>& agent, double bound, double& violation)
+    {
+        violation = 0;
+        for (const auto& c : constraints){
+            violation += c.Violation(agent);
+            if (violation > bound){
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /* SeparableOptimize: cost = ConstantTerm() + sum of numOfTerms() terms */
+    /*
+        * Every parameter belongs to exactly one term (TermOfParameter) and a
+        * term only reads its own parameters. The optimizer keeps the term
+        * values of every individual and, for a trial, recomputes only the
+        * terms whose parameters differ from the parent. The terms are added
+        * in index order starting from 0, so EvaluateCostView (which does the
+        * same) returns exactly the same value as the incremental update.
+    */
+    class SeparableOptimize : public Optimize{
+    public:
+        // number of terms (default: one per parameter, fully separable)
+        virtual unsigned int numOfTerms() const
+        {
+            return numOfParameters();
+        }
+        // term that parameter i belongs to (default: term i)
+        virtual unsigned int TermOfParameter(unsigned int i) const
+        {
+            return i;
+        }
+        // value of term t for the agent input
+        virtual double EvaluateTerm(unsigned int t, VectorView input) const = 0;
+        virtual double ConstantTerm() const
+        {
+            return 0.0;
+        }
+
+        double EvaluateCost(std::vector<double> input) const override
+        {
+            return EvaluateCostView(input);
+        }
+
+        double EvaluateCostView(VectorView input) const override
+        {
+            double val = 0;
+            for (unsigned int t = 0; t < numOfTerms(); t++){
+                val += EvaluateTerm(t, input);
+            }
+            return val + ConstantTerm();
+        }
+    };
+
+    // Selection rule used when the objective has nonlinear constraints
+    /*
+        * FeasibilityRules (Deb): a feasible agent beats an infeasible one, two
+        *   feasible agents are compared by cost, two infeasible agents by
+        *   total violation.
+        * EpsilonConstrained: like FeasibilityRules, but a violation up to
+        *   epsilon counts as feasible; epsilon shrinks to 0 over
+        *   controlGenerations generations.
+    */
+    enum class ConstraintHandling { FeasibilityRules, EpsilonConstrained };
+
+    /* Evaluator: evaluates a whole batch of agents at once */
+    /*
+        * When DifferentialEvolution is given an evaluator it switches to
+        * generation-synchronous updates: all trials of a generation are built
+        * from the current population, evaluated as one batch and then selected
+        * in index order.
+    */
+    class Evaluator{
+    public:
+        // costs[i] must receive the cost of agents[i]
+        virtual void EvaluateBatch(const std::vector<std::vector<double>>& agents, std::vector<double>& costs) = 0;
+        virtual ~Evaluator() {};
+    };
+
+    // Evaluate the batch one agent after another in the calling thread
+    class SerialEvaluator : public Evaluator
+    {
+        private:
+            const Optimize& costFunction;
+
+        public:
+            SerialEvaluator(const Optimize& costFunction) : costFunction(costFunction) {}
+
+            void EvaluateBatch(const std::vector<std::vector<double>>& agents, std::vector<double>& costs) override
+            {
+                costs.resize(agents.size());
+                for (size_t i = 0; i < agents.size(); i++){
+                    costs[i] = costFunction.EvaluateCostView(agents[i]);
+                }
+            }
+    };
+
+    // Hand the whole batch to one function as a row-major (n x dim) matrix
+    // (e.g. a NumPy-vectorized Python objective: one call per generation)
+    class VectorizedEvaluator : public Evaluator
+    {
+        public:
+            // func(matrix, n, dim, costs): costs[i] must receive the cost of row i
+            using Function = std::function<void(const double*, size_t, unsigned int, double*)>;
+
+        private:
+            unsigned int dim;
+            Function func;
+            std::vector<double> matrix;
+
+        public:
+            VectorizedEvaluator(unsigned int dim, Function func) : dim(dim), func(std::move(func)) {}
+
+            void EvaluateBatch(const std::vector<std::vector<double>>& agents, std::vector<double>& costs) override
+            {
+                costs.resize(agents.size());
+                if (agents.empty()){
+                    return;
+                }
+                matrix.resize(agents.size() * dim);
+                for (size_t i = 0; i < agents.size(); i++){
+                    assert(agents[i].size() == dim);
+                    std::copy(agents[i].begin(), agents[i].end(), matrix.begin() + i * dim);
+                }
+                func(matrix.data(), agents.size(), dim, costs.data());
+            }
+    };
+
+    // DE/rand/1/bin trial Y for target k from the first populationSize agents
+    // 在Agent的精度下計算 (float population: float運算)
+    template <class Agent, class Rng>
+    void RandOneBinTrial(const std::vector<Agent>& population, int populationSize, int k,
+                         double F, double CR, Agent& Y, Rng& rng)
+    {
+        // 產生一個uniform distribution 範圍是0~populationSize
+        std::uniform_real_distribution<double> dist(0,populationSize);
+
+        // 挑選三個不同的individuals a,b,c 初始化=k
+        int a = k;
+        int b = k;
+        int c = k;
+
+        // 確保a,b,c不相等(透過generator產生隨機數),break while 如果a,b,c不相等且a,b,c不等於k
+        while(a == k || b == k || c == k || a == b || a == c || b == c){
+            // a,b,c are random numbers 範圍在0~populationSize
+            a = dist(rng);
+            b = dist(rng);
+            c = dist(rng);
+        }
+
+        // 對所有維度sample一個範圍0-1的值 先暫存在Y (不需要另外配置X)
+        int numOfParameters = static_cast<int>(population[k].size());
+        std::uniform_real_distribution<double> distR(0,numOfParameters);
+        int R = distR(rng);
+        Y.resize(numOfParameters); //Y代表new individuals(X)
+        std::uniform_real_distribution<double> distX(0,1);
+        for (auto& x : Y){
+            x = distX(rng);
+        }
+
+        // 交叉 (在Real的精度下計算)
+        const auto f = static_cast<typename Agent::value_type>(F);
+        for(int i=0; i<numOfParameters; i++)
+        {
+            // Y[i]剛剛被初始化為0~1的隨機值
+            if (Y[i] < CR || i == R){
+                // Form intermediate solutions : Z=a+F*(b-c) // 隨機選三個individuals a,b,c 並進行交叉
+                Y[i] = population[a][i] + f*(population[b][i] - population[c][i]);
+            }
+            // 如果Y[i] >= CR且i != R就不進行交叉
+            else{
+                Y[i] = population[k][i];
+            }
+        }
+    }
+
     /* Class-2: DifferentialEvolution */
-    class DifferentialEvolution{
+    /*
+        * Objective is the static type of the cost function. It must provide
+        * EvaluateCostView, numOfParameters, getConstraints and
+        * getNonlinearConstraints like Optimize. DifferentialEvolution
+        * (Objective = Optimize) dispatches through the virtual functions;
+        * with a final objective type such as FunctionObjective<Fn> the
+        * calls are resolved at compile time and the objective can be inlined
+        * into the evaluation loop.
+        * Real is the storage type of the population and of the trials
+        * (double or float). Mutation and crossover run in Real; an agent is
+        * widened to double where it leaves the optimizer (objective,
+        * constraints, surrogate, trace, evaluators and local search).
+        * float halves the memory and bandwidth of large populations.
+    */
+    template <class Objective, class Real = double>
+    class BasicDifferentialEvolution{
         
         private:
-            const Optimize& costFunction;
+            using Agent = std::vector<Real>;
+            const Objective& costFunction;
             unsigned int populationSize;
             double F;
             double CR;
@@ -66,12 +377,12 @@ namespace DE
             // number of parameters
             unsigned int numOfParameters;
             // std::function
-            std::function<void(const DifferentialEvolution&)> callBack;
-            std::function<bool(const DifferentialEvolution&)> TerminateCondition;
+            std::function<void(const BasicDifferentialEvolution&)> callBack;
+            std::function<bool(const BasicDifferentialEvolution&)> TerminateCondition;
             // std random number generator
             std::default_random_engine generator;
-            // defien population double vector
-            std::vector<std::vector<double>> population;
+            // defien population vector (Real: double or float)
+            std::vector<Agent> population;
             // min cost of each agent in population
             std::vector<double> piCost;
             // constraint vector
@@ -79,27 +390,1252 @@ namespace DE
             // static lower and upper bound
             static constexpr double lowerConstraint = -std::numeric_limits<double>::infinity();
             static constexpr double upperConstraint = std::numeric_limits<double>::infinity();
+            // number of real cost evaluations
+            unsigned long long numOfEvaluations;
+            // surrogate model (nullptr代表不使用surrogate-assisted mode)
+            std::unique_ptr<SurrogateModel> surrogate;
+            // 每個target產生幾個候選trial
+            unsigned int surrogateCandidates;
+            // 預測不會贏過target的trial是否直接跳過真正的evaluation
+            bool surrogateScreen;
+            // 被surrogate跳過的evaluation次數
+            unsigned long long surrogateSkipped;
+            // batch evaluator (nullptr代表在目前的thread逐一evaluation)
+            Evaluator* evaluator;
+            // 目前是第幾個generation (InitializePopulation為第0代)
+            unsigned int generation;
+            // evaluation trace recorder (nullptr代表不記錄)
+            TraceRecorder* trace;
+            // nonlinear constraints 依成本由小到大排序
+            std::vector<Optimize::NonlinearConstraint> nonlinearConstraints;
+            // 每個individuals違反nonlinear constraint的總量
+            std::vector<double> piViolation;
+            ConstraintHandling constraintHandling;
+            // epsilon-constrained: 目前的epsilon 初始值 以及控制的generation數
+            double epsilon;
+            double epsilon0;
+            unsigned int epsilonGenerations;
+            double epsilonExponent;
+            // 在呼叫objective前就被constraint淘汰的trial數
+            unsigned long long constraintRejected;
+            // deterministic parallel mode: 每個individuals的亂數由(seed, generation, index)決定
+            bool deterministic;
+            ThreadPool* pool;
+            int randomSeed;
+            // deterministic mode的trial buffer
+            std::vector<Agent> trials;
+            // 是否把target的cost當作threshold傳給objective (EvaluateCostBounded)
+            bool boundedEvaluation;
+            // 提早結束(回傳+inf)的evaluation次數
+            unsigned long long numOfAborted;
+            // separable objective (nullptr代表不是SeparableOptimize)
+            const SeparableOptimize* separable;
+            bool incrementalEvaluation;
+            // 每個parameter屬於哪個term
+            std::vector<unsigned int> termOf;
+            // 每個individuals的term值 (空的代表未知 下次重新計算全部)
+            std::vector<std::vector<double>> piTerms;
+            // serial mode中trial的term值與dirty flag buffer
+            std::vector<double> trialTerms;
+            std::vector<char> dirtyTerms;
+            // deterministic mode中每個trial的term值
+            std::vector<std::vector<double>> trialTermsBuffer;
+            // 實際計算過的term數
+            unsigned long long numOfTermEvaluations;
+            // centroid, variance, bounding box, cost spread (每次替換時更新)
+            BasicPopulationStatistics<Real> statistics;
+            // restart (IPOP/BIPOP): 是否啟用 以及設定
+            bool restarts;
+            RestartConfig restartConfig;
+            // constructor給的population大小 (第一個run)
+            unsigned int basePopulationSize;
+            std::vector<RestartRecord> restartHistory;
+            // 目前的run: 上次改善時的cost與generation, 開始時的多樣性與evaluation數
+            double stagnationCost;
+            unsigned int stagnationGeneration;
+            double startDiversity;
+            unsigned long long runEvaluations;
+            // BIPOP: large regime的restart次數 兩個regime用掉的evaluation 目前是否為small regime
+            unsigned int numOfLargeRestarts;
+            unsigned long long largeBudget;
+            unsigned long long smallBudget;
+            bool smallRegime;
+            // 跨restart的最佳individuals (空的代表還沒初始化)
+            std::vector<double> globalBestAgent;
+            double globalBestCost;
+            double globalBestViolation;
+            // 初始population的取樣方式 以及沒有constraint的維度的取樣範圍
+            Initialization initialization;
+            double unboundedScale;
+            // polishing: 是否在run中/結束時polish 以及設定
+            bool polishing;
+            PolishConfig polishConfig;
+            // local search用掉的evaluation數 (也算在numOfEvaluations中)
+            unsigned long long numOfPolishEvaluations;
+            // population是否已經初始化 (dynamic mode的OptimizeStep接續目前的population)
+            bool initialized;
+            // dynamic objective: 是否啟用 設定 以及上次看到的data version
+            bool dynamic;
+            DynamicConfig dynamicConfig;
+            unsigned long long dataVersion;
+            // stale[k]: piCost[k]是舊資料上的cost (空的代表沒有stale的individuals)
+            std::vector<char> stale;
+            int numOfStale;
+            // 看到的資料變動次數 以及因資料變動而做的evaluation數
+            unsigned long long numOfDataChanges;
+            unsigned long long numOfReevaluations;
+            // deadline與cancellation: 在trial之間檢查 (nullptr / hasDeadline=false代表不檢查)
+            CancellationToken* cancellation;
+            bool hasDeadline;
+            std::chrono::steady_clock::time_point deadline;
+            // 上一次呼叫為什麼提早結束 以及回傳時超過deadline多少秒
+            StopReason stopReason;
+            double deadlineOvershoot;
+            // profiling: 每個phase的時間與hardware counters (nullptr代表不量測)
+            std::unique_ptr<PerfProfile> profile;
+
+            
+            
+            // agent的double版本: double storage直接回傳agent 否則複製到buffer
+            static const std::vector<double>& Widen(const std::vector<double>& agent, std::vector<double>&)
+            {
+                return agent;
+            }
+
+            template <class T>
+            static const std::vector<double>& Widen(const std::vector<T>& agent, std::vector<double>& buffer)
+            {
+                buffer.assign(agent.begin(), agent.end());
+                return buffer;
+            }
+
+            // 把維度i的值存成Real (float時捨入後仍留在constraint的範圍內)
+            Real Narrow(unsigned int i, double value) const
+            {
+                Real x = static_cast<Real>(value);
+                if constexpr (!std::is_same_v<Real, double>){
+                    if (constraints[i].isConstrained){
+                        if (x > constraints[i].upper){
+                            x = std::nextafter(x, static_cast<Real>(constraints[i].lower));
+                        }
+                        if (x < constraints[i].lower){
+                            x = std::nextafter(x, static_cast<Real>(constraints[i].upper));
+                        }
+                    }
+                }
+                return x;
+            }
+
+            void RecordTrace(int k, const Agent& agent, double cost, bool accepted)
+            {
+                std::vector<double> buffer;
+                trace->Record(generation, k, Widen(agent, buffer).data(), cost, accepted);
+            }
+
+            // 檢查某個individuals是否符合constraint
+            bool CheckConstraints(const Agent& agent) const
+            {
+                // 對individuals的每個維度value進行檢查
+                // 檢查會先看isConstrained是否為true true代表還沒限制範圍
+                // 一旦有限制範圍就會檢查是否在範圍內
+                // 這個function會回傳true代表individuals符合constraint false代表不符合
+                for (int i = 0; i < agent.size(); i++)
+                {
+                    if (!constraints[i].Check(agent[i]))
+                    {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            // 依目前的規則(feasibility rules / epsilon) 判斷(costA, violationA)是否比(costB, violationB)好
+            bool Better(double costA, double violationA, double costB, double violationB) const
+            {
+                if ((violationA <= epsilon && violationB <= epsilon) || violationA == violationB){
+                    return costA < costB;
+                }
+                return violationA < violationB;
+            }
+
+            // 依成本順序evaluation nonlinear constraints
+            // 一旦違反量超過bound就停止(這個trial一定會輸) 回傳false
+            template <class Vec>
+            bool EvaluateViolation(const Vec& agent, double bound, double& violation) const
+            {
+                violation = 0;
+                if (nonlinearConstraints.empty()){
+                    return true;
+                }
+                std::vector<double> buffer;
+                return SumViolations(nonlinearConstraints, Widen(agent, buffer), bound, violation);
+            }
+
+            // Cheap-first evaluation of a trial for target k
+            // 回傳false代表trial在objective之前就被constraint淘汰
+            // objective只對(epsilon-)feasible的trial呼叫 其他trial的cost為+inf
+            bool EvaluateTrial(int k, const Agent& Y, double& cost, double& violation)
+            {
+                if (!EvaluateViolation(Y, std::max(epsilon, piViolation[k]), violation)){
+                    constraintRejected++;
+                    return false;
+                }
+                if (violation <= epsilon){
+                    cost = EvaluateTrialCost(k, Y, trialTerms);
+                }
+                else{
+                    cost = std::numeric_limits<double>::infinity();
+                    trialTerms.clear();
+                }
+                return true;
+            }
+
+            // trial取代population[k] (trial收回原本的individuals) 並更新統計量
+            // terms: trial的term值 (nullptr代表未知)
+            void Accept(int k, Agent& trial, double cost, double violation, std::vector<double>* terms)
+            {
+                double oldCost = piCost[k];
+                population[k].swap(trial);
+                if (terms){
+                    piTerms[k].swap(*terms);
+                }
+                else{
+                    piTerms[k].clear();
+                }
+                piCost[k] = cost;
+                piViolation[k] = violation;
+                statistics.Replaced(trial, population[k], oldCost, cost);
+                MarkFresh(k);
+            }
+
+            bool IsStale(int k) const
+            {
+                return !stale.empty() && stale[k];
+            }
+
+            void MarkFresh(int k)
+            {
+                if (IsStale(k)){
+                    stale[k] = 0;
+                    if (--numOfStale == 0){
+                        stale.clear();
+                    }
+                }
+            }
+
+            // stale的individuals k在新資料上的cost (evaluation已計數)
+            void Refreshed(int k, double cost)
+            {
+                statistics.Replaced(population[k], population[k], piCost[k], cost);
+                piCost[k] = cost;
+                piTerms[k].clear();
+                if (trace && std::isfinite(cost)){
+                    RecordTrace(k, population[k], cost, true);
+                }
+                MarkFresh(k);
+            }
+
+            // stale的target只需要知道是否比它的trial好: trial的cost作為bounded evaluation的上限
+            double RefreshThreshold(double trialCost) const
+            {
+                if (!boundedEvaluation || surrogate){
+                    return std::numeric_limits<double>::infinity();
+                }
+                return trialCost;
+            }
+
+            // serial mode: 在新資料上重新evaluation stale的target k
+            void RefreshTarget(int k, double trialCost)
+            {
+                double cost = std::numeric_limits<double>::infinity();
+                if (piViolation[k] <= epsilon){
+                    double threshold = RefreshThreshold(trialCost);
+                    cost = EvaluateAgent(population[k], threshold);
+                    numOfReevaluations++;
+                }
+                Refreshed(k, cost);
+            }
+
+            // epsilon level: epsilon0 * (1 - t/Tc)^cp, 0 after Tc generations
+            void UpdateEpsilon()
+            {
+                if (constraintHandling != ConstraintHandling::EpsilonConstrained || generation >= epsilonGenerations){
+                    epsilon = 0;
+                    return;
+                }
+                epsilon = epsilon0 * std::pow(1.0 - static_cast<double>(generation) / epsilonGenerations, epsilonExponent);
+            }
+
+            // 找出目前最好的individuals
+            // (stale的individuals的cost是舊資料上的 不參與比較)
+            void UpdateBestAgent()
+            {
+                int oneBestAgentIndex = -1;
+                for (int k = 0; k < populationSize; k++){
+                    if (IsStale(k)){
+                        continue;
+                    }
+                    if (oneBestAgentIndex < 0 ||
+                        Better(piCost[k], piViolation[k], piCost[oneBestAgentIndex], piViolation[oneBestAgentIndex])){
+                        oneBestAgentIndex = k;
+                    }
+                }
+                assert(oneBestAgentIndex >= 0 && "At least one individual has a current cost");
+                minCost = piCost[oneBestAgentIndex];
+                bestAgentIndex = oneBestAgentIndex;
+            }
+
+            // trial for target k只有在cost低於這個值時才會被選上
+            // 目標infeasible時 (epsilon-)feasible的trial一定會贏 不需要cost
+            // surrogate需要真正的cost 所以不設上限
+            double Threshold(int k) const
+            {
+                if (!boundedEvaluation || surrogate || piViolation[k] > epsilon || IsStale(k)){
+                    return std::numeric_limits<double>::infinity();
+                }
+                return piCost[k];
+            }
+
+            // 呼叫objective (threshold有限時用bounded evaluation)
+            double CallObjective(const Agent& agent, double threshold) const
+            {
+                // float storage: 每個thread重複使用同一個double buffer
+                thread_local std::vector<double> buffer;
+                const std::vector<double>& x = Widen(agent, buffer);
+                if (threshold == std::numeric_limits<double>::infinity()){
+                    return costFunction.EvaluateCostView(x);
+                }
+                return costFunction.EvaluateCostBounded(x, threshold);
+            }
+
+            // 計數 並把真正的cost餵給surrogate model
+            void CountEvaluation(const Agent& agent, double cost, double threshold)
+            {
+                numOfEvaluations++;
+                if (cost == std::numeric_limits<double>::infinity() && threshold < cost){
+                    numOfAborted++;
+                }
+                else if (surrogate){
+                    std::vector<double> buffer;
+                    surrogate->Add(Widen(agent, buffer), cost);
+                }
+            }
+
+            // 真正呼叫cost function 並把結果餵給surrogate model
+            double EvaluateAgent(const Agent& agent,
+                                 double threshold = std::numeric_limits<double>::infinity())
+            {
+                double cost = CallObjective(agent, threshold);
+                CountEvaluation(agent, cost, threshold);
+                return cost;
+            }
+
+            // 沒有evaluator時separable objective使用incremental evaluation
+            bool Incremental() const
+            {
+                return separable && incrementalEvaluation && !evaluator;
+            }
+
+            // 計算agent的cost及term值: 只重新計算與parent (piTerms[parent]) 不同的term
+            // parent < 0 或parent的term未知時計算全部term; computed回傳計算過的term數
+            double EvaluateTerms(int parent, const Agent& agent, std::vector<double>& terms,
+                                 std::vector<char>& dirty, unsigned long long& computed) const
+            {
+                unsigned int n = separable->numOfTerms();
+                std::vector<double> buffer;
+                const std::vector<double>& x = Widen(agent, buffer);
+                if (parent < 0 || piTerms[parent].size() != n){
+                    terms.resize(n);
+                    for (unsigned int t = 0; t < n; t++){
+                        terms[t] = separable->EvaluateTerm(t, x);
+                    }
+                    computed += n;
+                }
+                else{
+                    terms = piTerms[parent];
+                    dirty.assign(n, 0);
+                    const Agent& old = population[parent];
+                    for (unsigned int i = 0; i < numOfParameters; i++){
+                        if (agent[i] != old[i]){
+                            dirty[termOf[i]] = 1;
+                        }
+                    }
+                    for (unsigned int t = 0; t < n; t++){
+                        if (dirty[t]){
+                            terms[t] = separable->EvaluateTerm(t, x);
+                            computed++;
+                        }
+                    }
+                }
+                // 與SeparableOptimize::EvaluateCostView相同的加總順序
+                double val = 0;
+                for (unsigned int t = 0; t < n; t++){
+                    val += terms[t];
+                }
+                return val + separable->ConstantTerm();
+            }
+
+            // trial Y for target k的cost (incremental時terms收到trial的term值 否則清空)
+            double EvaluateTrialCost(int k, const Agent& Y, std::vector<double>& terms)
+            {
+                if (!Incremental()){
+                    terms.clear();
+                    return EvaluateAgent(Y, Threshold(k));
+                }
+                double cost = EvaluateTerms(k, Y, terms, dirtyTerms, numOfTermEvaluations);
+                CountEvaluation(Y, cost, std::numeric_limits<double>::infinity());
+                return cost;
+            }
+
+            // 把batch交給evaluator (float storage先轉成double)
+            void CallEvaluator(const std::vector<Agent>& agents, std::vector<double>& costs)
+            {
+                costs.resize(agents.size());
+                if constexpr (std::is_same_v<Real, double>){
+                    evaluator->EvaluateBatch(agents, costs);
+                }
+                else{
+                    std::vector<std::vector<double>> wide(agents.size());
+                    for (size_t i = 0; i < agents.size(); i++){
+                        wide[i].assign(agents[i].begin(), agents[i].end());
+                    }
+                    evaluator->EvaluateBatch(wide, costs);
+                }
+            }
+
+            // 用evaluator一次evaluation整個batch
+            void EvaluateAgents(const std::vector<Agent>& agents, std::vector<double>& costs)
+            {
+                CallEvaluator(agents, costs);
+                numOfEvaluations += agents.size();
+                if (surrogate){
+                    std::vector<double> buffer;
+                    for (size_t i = 0; i < agents.size(); i++){
+                        surrogate->Add(Widen(agents[i], buffer), costs[i]);
+                    }
+                }
+            }
+
+            // 對target k產生一個trial Y (mutation + crossover)
+            // rng: generator (serial mode) 或 StreamRandom (deterministic mode)
+            template <class Rng>
+            void MakeTrial(int k, Agent& Y, Rng& rng) const
+            {
+                RandOneBinTrial(population, populationSize, k, F, CR, Y, rng);
+            }
+
+            // 產生trial直到符合constraint為止(等同原本的k--重新選擇)
+            template <class Rng>
+            void MakeValidTrial(int k, Agent& Y, Rng& rng) const
+            {
+                do{
+                    MakeTrial(k, Y, rng);
+                } while (shouldCheckConstraint && !CheckConstraints(Y));
+            }
+
+            // 產生target k的trial 回傳這個trial是否需要真正的evaluation
+            template <class Rng>
+            bool ScreenTrial(int k, Agent& Y, Agent& candidate, Rng& rng) const
+            {
+                if (!(surrogate && surrogate->Ready())){
+                    MakeValidTrial(k, Y, rng);
+                    return true;
+                }
+                // Surrogate-assisted: 產生多個候選trial 只把預測最好的送去真正evaluation
+                double bestPredicted = std::numeric_limits<double>::infinity();
+                std::vector<double> buffer;
+                for (unsigned int m = 0; m < surrogateCandidates; m++){
+                    MakeValidTrial(k, candidate, rng);
+                    double predicted = surrogate->Predict(Widen(candidate, buffer));
+                    if (m == 0 || predicted < bestPredicted){
+                        bestPredicted = predicted;
+                        Y.swap(candidate);
+                    }
+                }
+                // 預測不會贏過piCost[k]的trial不需要付出真正evaluation的成本
+                return !(surrogateScreen && !(bestPredicted < piCost[k]));
+            }
+
+            bool MakeScreenedTrial(int k, Agent& Y, Agent& candidate)
+            {
+                if (!ScreenTrial(k, Y, candidate, generator)){
+                    surrogateSkipped++;
+                    return false;
+                }
+                return true;
+            }
+
+            // deadline已過或token已取消 (worker thread也可以呼叫)
+            bool Expired() const
+            {
+                return (cancellation && cancellation->IsCancelled()) ||
+                       (hasDeadline && std::chrono::steady_clock::now() >= deadline);
+            }
+
+            // 由呼叫的thread在trial之間檢查 並記錄停止的原因
+            bool StopRequested()
+            {
+                if (stopReason != StopReason::Completed){
+                    return true;
+                }
+                if (cancellation && cancellation->Poll()){
+                    stopReason = StopReason::Cancelled;
+                }
+                else if (hasDeadline && std::chrono::steady_clock::now() >= deadline){
+                    stopReason = StopReason::Deadline;
+                }
+                return stopReason != StopReason::Completed;
+            }
+
+            // 因deadline停止時 量測回傳時超過deadline的時間
+            void MeasureOvershoot()
+            {
+                if (stopReason == StopReason::Deadline){
+                    deadlineOvershoot = std::chrono::duration<double>(std::chrono::steady_clock::now() - deadline).count();
+                }
+            }
+
+            // 0..n-1平行執行 (見ParallelFor)
+            template <class Task>
+            void ForEachIndex(int n, const Task& task)
+            {
+                ParallelFor(pool, n, task);
+            }
+
+            // Deterministic generation-synchronous version of SelectAndCross
+            /*
+                * Trial k is built from the previous generation with the stream
+                * StreamRandom(seed, generation, k), then screened, checked and
+                * evaluated in parallel. Counters, the surrogate archive, the
+                * trace, selection and the best index are updated afterwards in
+                * index order, so the result does not depend on the number of
+                * threads.
+            */
+            void SelectAndCrossDeterministic()
+            {
+                enum Status : char { Skipped, Rejected, Evaluated, Infeasible, Stopped };
+                trials.resize(populationSize);
+                std::vector<char> status(populationSize);
+                std::vector<double> costs(populationSize);
+                std::vector<double> violations(populationSize);
+                std::vector<double> thresholds(populationSize);
+                std::vector<unsigned long long> termCounts(populationSize, 0);
+                bool incremental = Incremental();
+                trialTermsBuffer.resize(populationSize);
+                // stale的target在新資料上的cost (見RefreshThreshold)
+                std::vector<double> targetCosts(populationSize, std::numeric_limits<double>::infinity());
+
+                ForEachIndex(populationSize, [&](int k){
+                    // deadline或cancel之後的trial不再產生
+                    if (Expired()){
+                        status[k] = Stopped;
+                        return;
+                    }
+                    // 每個worker thread量測自己的counters
+                    PhaseRecorder phases(profile.get());
+                    phases.Enter(ProfilePhase::TrialConstruction);
+                    StreamRandom rng(static_cast<uint64_t>(static_cast<int64_t>(randomSeed)), generation, k);
+                    Agent candidate;
+                    if (!ScreenTrial(k, trials[k], candidate, rng)){
+                        status[k] = Skipped;
+                        return;
+                    }
+                    phases.Enter(ProfilePhase::Evaluation);
+                    if (!EvaluateViolation(trials[k], std::max(epsilon, piViolation[k]), violations[k])){
+                        status[k] = Rejected;
+                        return;
+                    }
+                    if (violations[k] <= epsilon){
+                        status[k] = Evaluated;
+                        thresholds[k] = evaluator || incremental ? std::numeric_limits<double>::infinity() : Threshold(k);
+                        if (incremental){
+                            std::vector<char> dirty;
+                            costs[k] = EvaluateTerms(k, trials[k], trialTermsBuffer[k], dirty, termCounts[k]);
+                        }
+                        else if (!evaluator){
+                            costs[k] = CallObjective(trials[k], thresholds[k]);
+                        }
+                    }
+                    else{
+                        status[k] = Infeasible;
+                        costs[k] = std::numeric_limits<double>::infinity();
+                        trialTermsBuffer[k].clear();
+                    }
+                    if (!incremental){
+                        trialTermsBuffer[k].clear();
+                    }
+                    if (IsStale(k) && !evaluator && piViolation[k] <= epsilon){
+                        targetCosts[k] = CallObjective(population[k], RefreshThreshold(costs[k]));
+                    }
+                });
+
+                PhaseRecorder phases(profile.get());
+                // 有evaluator時 (epsilon-)feasible的trial依index順序組成一個batch
+                if (evaluator){
+                    phases.Enter(ProfilePhase::Evaluation);
+                    std::vector<Agent> batch;
+                    std::vector<int> targets;
+                    for (int k = 0; k < populationSize; k++){
+                        if (status[k] == Evaluated){
+                            batch.push_back(trials[k]);
+                            targets.push_back(k);
+                        }
+                    }
+                    // stale的target放在同一個batch的後面
+                    size_t numOfTrials = batch.size();
+                    for (int k = 0; k < populationSize; k++){
+                        if ((status[k] == Evaluated || status[k] == Infeasible) && IsStale(k) && piViolation[k] <= epsilon){
+                            batch.push_back(population[k]);
+                            targets.push_back(k);
+                        }
+                    }
+                    std::vector<double> batchCosts;
+                    CallEvaluator(batch, batchCosts);
+                    for (size_t t = 0; t < targets.size(); t++){
+                        (t < numOfTrials ? costs : targetCosts)[targets[t]] = batchCosts[t];
+                    }
+                }
+
+                if (cancellation || hasDeadline){
+                    StopRequested();
+                }
+
+                // 依index順序更新
+                phases.Enter(ProfilePhase::Selection);
+                for (int k = 0; k < populationSize; k++){
+                    if (status[k] == Stopped){
+                        continue;
+                    }
+                    if (status[k] == Skipped){
+                        surrogateSkipped++;
+                        continue;
+                    }
+                    if (status[k] == Rejected){
+                        constraintRejected++;
+                        continue;
+                    }
+                    if (status[k] == Evaluated){
+                        CountEvaluation(trials[k], costs[k], thresholds[k]);
+                        numOfTermEvaluations += termCounts[k];
+                    }
+                    if (IsStale(k)){
+                        if (piViolation[k] <= epsilon){
+                            CountEvaluation(population[k], targetCosts[k],
+                                            evaluator ? std::numeric_limits<double>::infinity() : RefreshThreshold(costs[k]));
+                            numOfReevaluations++;
+                        }
+                        Refreshed(k, targetCosts[k]);
+                    }
+                    bool accepted = Better(costs[k], violations[k], piCost[k], piViolation[k]);
+                    if (trace && std::isfinite(costs[k])){
+                        RecordTrace(k, trials[k], costs[k], accepted);
+                    }
+                    if (accepted){
+                        Accept(k, trials[k], costs[k], violations[k], &trialTermsBuffer[k]);
+                    }
+                }
+
+                // 追蹤最小的cost (依index順序)
+                UpdateBestAgent();
+                phases.Stop();
+            }
+
+            // Generation-synchronous version of SelectAndCross used with an evaluator
+            void SelectAndCrossBatch()
+            {
+                // 先用目前的population產生所有trial
+                std::vector<Agent> trials;
+                std::vector<int> targets;
+                trials.reserve(populationSize);
+                targets.reserve(populationSize);
+                // 便宜的nonlinear constraint先在這裡檢查 只有(epsilon-)feasible的trial進入batch
+                std::vector<double> violations;
+                std::vector<Agent> infeasible;
+                std::vector<int> infeasibleTargets;
+                std::vector<double> infeasibleViolations;
+                Agent Y(numOfParameters);
+                Agent candidate(numOfParameters);
+                PhaseRecorder phases(profile.get());
+                phases.Enter(ProfilePhase::TrialConstruction);
+                for (int k = 0; k < populationSize; k++){
+                    // deadline或cancel: 只evaluation已經產生的trial
+                    if (StopRequested()){
+                        break;
+                    }
+                    if (!MakeScreenedTrial(k, Y, candidate)){
+                        continue;
+                    }
+                    double violation;
+                    if (!EvaluateViolation(Y, std::max(epsilon, piViolation[k]), violation)){
+                        constraintRejected++;
+                        continue;
+                    }
+                    if (violation <= epsilon){
+                        trials.push_back(Y);
+                        targets.push_back(k);
+                        violations.push_back(violation);
+                    }
+                    else{
+                        infeasible.push_back(Y);
+                        infeasibleTargets.push_back(k);
+                        infeasibleViolations.push_back(violation);
+                    }
+                }
+
+                // stale的target (有trial的) 與trial在同一個batch中重新evaluation
+                size_t numOfTrials = trials.size();
+                std::vector<int> refresh;
+                if (numOfStale){
+                    std::vector<char> hasTrial(populationSize, 0);
+                    for (int k : targets){
+                        hasTrial[k] = 1;
+                    }
+                    for (int k : infeasibleTargets){
+                        hasTrial[k] = 1;
+                    }
+                    for (int k = 0; k < populationSize; k++){
+                        if (hasTrial[k] && IsStale(k)){
+                            refresh.push_back(k);
+                            if (piViolation[k] <= epsilon){
+                                trials.push_back(population[k]);
+                            }
+                        }
+                    }
+                }
+
+                // 一次evaluation整個batch
+                std::vector<double> costs;
+                phases.Enter(ProfilePhase::Evaluation);
+                EvaluateAgents(trials, costs);
+                phases.Enter(ProfilePhase::Selection);
+                numOfReevaluations += trials.size() - numOfTrials;
+                size_t next = numOfTrials;
+                for (int k : refresh){
+                    Refreshed(k, piViolation[k] <= epsilon ? costs[next++] : std::numeric_limits<double>::infinity());
+                }
+                trials.resize(numOfTrials);
+                costs.resize(numOfTrials);
+
+                // 不需要objective的infeasible trial cost為+inf
+                for (size_t t = 0; t < infeasible.size(); t++){
+                    trials.push_back(infeasible[t]);
+                    targets.push_back(infeasibleTargets[t]);
+                    violations.push_back(infeasibleViolations[t]);
+                    costs.push_back(std::numeric_limits<double>::infinity());
+                }
+
+                // 依index順序做selection (每個target最多只有一個trial)
+                for (size_t t = 0; t < trials.size(); t++){
+                    int k = targets[t];
+                    bool accepted = Better(costs[t], violations[t], piCost[k], piViolation[k]);
+                    if (trace && std::isfinite(costs[t])){
+                        RecordTrace(k, trials[t], costs[t], accepted);
+                    }
+                    if (accepted){
+                        // batch evaluation不計算term值
+                        Accept(k, trials[t], costs[t], violations[t], nullptr);
+                    }
+                }
+
+                // 追蹤最小的cost
+                UpdateBestAgent();
+                phases.Stop();
+            }
+
+            // Default serial version of SelectAndCross: each trial replaces its target immediately
+            void SelectAndCrossSerial()
+            {
+                // local MinCost
+                double MinCost = piCost[0];
+                // local bestAgentIndex
+                int oneBestAgentIndex = 0;
+
+                // trial與surrogate候選的buffer
+                Agent Y(numOfParameters); //Y代表new individuals(X)
+                Agent candidate(numOfParameters);
+                PhaseRecorder phases(profile.get());
+
+                // 選擇和交叉,跑過所有的individuals
+                for(int k = 0; k < populationSize; k++){
+
+                    // std::cout << "SAC: " << k << std::endl;
+
+                    // deadline或cancel: 停在這個trial之前
+                    if (StopRequested()){
+                        break;
+                    }
+
+                    // 產生trial 並檢查是否符合constraint
+                    // 剛開始CheckConstraints是true表示還沒開始限縮範圍
+                    // 一旦開始限縮範圍就會檢查是否符合constraint 若不符合就重新選擇individuals
+                    double newCost, newViolation;
+                    phases.Enter(ProfilePhase::TrialConstruction);
+                    bool made = MakeScreenedTrial(k, Y, candidate);
+                    phases.Enter(ProfilePhase::Evaluation);
+                    // 決定現在更新的individuals是否比原本的individuals好 先評估cost fo Y
+                    // (會先檢查nonlinear constraint 一定會輸的trial不呼叫objective)
+                    if (made && EvaluateTrial(k, Y, newCost, newViolation)){
+                        // std::cout << "Evaluated new cost: " << newCost << " for individual " << k << std::endl;
+                        // stale的target: 以trial的cost為上限重新evaluation
+                        if (IsStale(k)){
+                            RefreshTarget(k, newCost);
+                        }
+                        phases.Enter(ProfilePhase::Selection);
+                        bool accepted = Better(newCost, newViolation, piCost[k], piViolation[k]);
+                        if (trace && std::isfinite(newCost)){
+                            RecordTrace(k, Y, newCost, accepted);
+                        }
+
+                        // 檢查cost是否小於每個individuals的cost
+                        if (accepted){
+                            // 更新現在的individuals為Y 以及它的cost (Y收回舊的individuals 下一個trial會覆寫)
+                            Accept(k, Y, newCost, newViolation, &trialTerms);
+                        }
+                    }
+                    // 追蹤最小的cost
+                    phases.Enter(ProfilePhase::Selection);
+                    if (Better(piCost[k], piViolation[k], MinCost, piViolation[oneBestAgentIndex])){
+                        MinCost = piCost[k];
+                        oneBestAgentIndex = k;
+                    }                    
+                }
+                phases.Stop();
+                
+                minCost = MinCost;
+                bestAgentIndex = oneBestAgentIndex;
+                // 還有stale的individuals (或提早停止) 時重新找best
+                if (numOfStale || stopReason != StopReason::Completed){
+                    UpdateBestAgent();
+                }
+                // std::cout << "Min Cost" << minCost << std::endl;
+                // std::cout << "Best Agent Index" << bestAgentIndex << std::endl;
+            }
+
+            // 維度i的取樣範圍 (沒有constraint的維度用[-unboundedScale, unboundedScale])
+            double SampleLower(unsigned int i) const
+            {
+                return constraints[i].SampleLower(unboundedScale);
+            }
+
+            double SampleUpper(unsigned int i) const
+            {
+                return constraints[i].SampleUpper(unboundedScale);
+            }
+
+            // 取樣population的前n個individuals (opposition: 以及後n個opposite)
+            void SampleAgents(unsigned int n)
+            {
+                SampleUnitCube(initialization, n, numOfParameters, generator, [this](unsigned int k, unsigned int i, double u){
+                    population[k][i] = Narrow(i, SampleLower(i) + (SampleUpper(i) - SampleLower(i)) * u);
+                });
+                if (initialization == Initialization::Opposition){
+                    for (unsigned int k = 0; k < n; k++){
+                        for (unsigned int i = 0; i < numOfParameters; i++){
+                            population[n + k][i] = Narrow(i, SampleLower(i) + SampleUpper(i) - population[k][i]);
+                        }
+                    }
+                }
+            }
+
+            // 每個individuals違反nonlinear constraint的量
+            void EvaluateViolations()
+            {
+                for (int i = 0; i < populationSize; i++){
+                    EvaluateViolation(population[i], std::numeric_limits<double>::infinity(), piViolation[i]);
+                }
+            }
+
+            // evaluation整個population (piViolation已知): term值重新計算
+            void EvaluatePopulation()
+            {
+                // 新的population: term值全部未知 所有cost都是目前資料上的
+                for (auto& terms : piTerms){
+                    terms.clear();
+                }
+                stale.clear();
+                numOfStale = 0;
+                bool incremental = Incremental();
+
+                // objective只對(epsilon-)feasible的individuals呼叫 其他的cost為+inf
+                if (evaluator){
+                    // 有evaluator時一次evaluation整個population
+                    if (nonlinearConstraints.empty()){
+                        EvaluateAgents(population, piCost);
+                    }
+                    else{
+                        std::vector<Agent> feasible;
+                        std::vector<int> feasibleIndex;
+                        for (int i = 0; i < populationSize; i++){
+                            if (piViolation[i] <= epsilon){
+                                feasible.push_back(population[i]);
+                                feasibleIndex.push_back(i);
+                            }
+                        }
+                        std::vector<double> costs;
+                        EvaluateAgents(feasible, costs);
+                        piCost.assign(populationSize, std::numeric_limits<double>::infinity());
+                        for (size_t t = 0; t < feasibleIndex.size(); t++){
+                            piCost[feasibleIndex[t]] = costs[t];
+                        }
+                    }
+                }
+                else if (deterministic){
+                    // 平行evaluation 再依index順序計數及更新surrogate
+                    ForEachIndex(populationSize, [&](int i){
+                        if (piViolation[i] > epsilon){
+                            piCost[i] = std::numeric_limits<double>::infinity();
+                        }
+                        else if (incremental){
+                            std::vector<char> dirty;
+                            unsigned long long computed = 0;
+                            piCost[i] = EvaluateTerms(-1, population[i], piTerms[i], dirty, computed);
+                        }
+                        else{
+                            piCost[i] = CallObjective(population[i], std::numeric_limits<double>::infinity());
+                        }
+                    });
+                    std::vector<double> buffer;
+                    for (int i = 0; i < populationSize; i++){
+                        if (piViolation[i] <= epsilon){
+                            numOfEvaluations++;
+                            numOfTermEvaluations += piTerms[i].size();
+                            if (surrogate){
+                                surrogate->Add(Widen(population[i], buffer), piCost[i]);
+                            }
+                        }
+                    }
+                }
+
+                // 目的: 更新每個xi的cost 以及 找出最小的cost和index
+                for(int i=0;i<populationSize;i++)
+                {
+                    // piCost[i]代表的是population[i]的cost
+                    // cost透過EvaluateCost function計算
+                    if (!evaluator && !deterministic){
+                        if (piViolation[i] > epsilon){
+                            piCost[i] = std::numeric_limits<double>::infinity();
+                        }
+                        else if (incremental){
+                            piCost[i] = EvaluateTerms(-1, population[i], piTerms[i], dirtyTerms, numOfTermEvaluations);
+                            CountEvaluation(population[i], piCost[i], std::numeric_limits<double>::infinity());
+                        }
+                        else{
+                            piCost[i] = EvaluateAgent(population[i]);
+                        }
+                    }
+                }
+            }
+
+            // 取樣新的population並evaluation (generation不變)
+            void SamplePopulation(){
+                // opposition-based: 後半部是前半部的opposite 一起evaluation
+                unsigned int size = populationSize;
+                bool opposition = initialization == Initialization::Opposition;
+                if (opposition){
+                    ResizePopulation(2 * size);
+                }
+                SampleAgents(size);
+
+                // 先計算每個individuals違反nonlinear constraint的量
+                EvaluateViolations();
+                // epsilon0: 初始population中約20%的individuals可視為feasible
+                if (constraintHandling == ConstraintHandling::EpsilonConstrained && !nonlinearConstraints.empty()){
+                    std::vector<double> sorted(piViolation);
+                    std::nth_element(sorted.begin(), sorted.begin() + populationSize / 5, sorted.end());
+                    epsilon0 = sorted[populationSize / 5];
+                }
+                UpdateEpsilon();
+                EvaluatePopulation();
+
+                // opposition-based: 2n個點中最好的n個 (相同時index小的優先)
+                std::vector<char> kept(populationSize, 1);
+                if (opposition){
+                    std::vector<int> order(populationSize);
+                    for (int i = 0; i < populationSize; i++){
+                        order[i] = i;
+                    }
+                    std::stable_sort(order.begin(), order.end(), [this](int a, int b){
+                        return Better(piCost[a], piViolation[a], piCost[b], piViolation[b]);
+                    });
+                    kept.assign(populationSize, 0);
+                    for (unsigned int t = 0; t < size; t++){
+                        kept[order[t]] = 1;
+                    }
+                }
+                if (trace){
+                    for (int i = 0; i < populationSize; i++){
+                        if (std::isfinite(piCost[i])){
+                            RecordTrace(i % size, population[i], piCost[i], kept[i]);
+                        }
+                    }
+                }
+                if (opposition){
+                    // 留下的individuals移到前面 (保持index順序)
+                    unsigned int next = 0;
+                    for (int i = 0; i < populationSize; i++){
+                        if (!kept[i]){
+                            continue;
+                        }
+                        if (static_cast<unsigned int>(i) != next){
+                            population[next].swap(population[i]);
+                            std::swap(piCost[next], piCost[i]);
+                            std::swap(piViolation[next], piViolation[i]);
+                            piTerms[next].swap(piTerms[i]);
+                        }
+                        next++;
+                    }
+                    populationSize = size;
+                    population.resize(size);
+                    piCost.resize(size);
+                    piViolation.resize(size);
+                    piTerms.resize(size);
+                }
+
+                statistics.Reset(population, piCost);
+
+                // find the best cost and index 
+                UpdateBestAgent();
+            }
+
+
+            // 改變population大小 (新的individuals在SamplePopulation中取樣)
+            void ResizePopulation(unsigned int size)
+            {
+                populationSize = size;
+                population.resize(size, Agent(numOfParameters));
+                piCost.resize(size);
+                piViolation.assign(size, 0.0);
+                piTerms.resize(size);
+            }
+
+            // 新的run開始: 重設stagnation的比較基準
+            void StartRun()
+            {
+                stagnationCost = piCost[bestAgentIndex];
+                stagnationGeneration = generation;
+                startDiversity = statistics.MeanStd();
+                runEvaluations = numOfEvaluations;
+            }
+
+            // 記錄跨restart的最佳individuals
+            void UpdateGlobalBest()
+            {
+                if (globalBestAgent.empty() ||
+                    Better(piCost[bestAgentIndex], piViolation[bestAgentIndex], globalBestCost, globalBestViolation)){
+                    globalBestAgent.assign(population[bestAgentIndex].begin(), population[bestAgentIndex].end());
+                    globalBestCost = piCost[bestAgentIndex];
+                    globalBestViolation = piViolation[bestAgentIndex];
+                }
+            }
+
+            // large regime第k次restart的population大小: N0 * factor^k
+            unsigned int LargePopulationSize(unsigned int k) const
+            {
+                double size = basePopulationSize * std::pow(restartConfig.populationFactor, k);
+                if (restartConfig.maxPopulationSize){
+                    size = std::min(size, static_cast<double>(std::max(4u, restartConfig.maxPopulationSize)));
+                }
+                return static_cast<unsigned int>(size);
+            }
+
+            // data version改變時: 立即重新evaluation優先的individuals 其他的標記為stale
+            void CheckDataVersion()
+            {
+                unsigned long long version = costFunction.dataVersion();
+                if (version == dataVersion){
+                    return;
+                }
+                dataVersion = version;
+                numOfDataChanges++;
+                if (surrogate){
+                    surrogate->Clear();
+                }
+
+                // 依舊的cost排序 (已經stale的individuals也用它們最後已知的cost)
+                std::vector<int> order(populationSize);
+                for (int k = 0; k < populationSize; k++){
+                    order[k] = k;
+                }
+                std::stable_sort(order.begin(), order.end(), [this](int a, int b){
+                    return Better(piCost[a], piViolation[a], piCost[b], piViolation[b]);
+                });
+                int n = static_cast<int>(populationSize);
+                int elites = std::max(1, static_cast<int>(std::lround(dynamicConfig.eliteFraction * populationSize)));
+                int immigrants = std::min(n - elites,
+                                          static_cast<int>(std::lround(dynamicConfig.immigrantFraction * populationSize)));
+                int samples = std::min(n - elites - immigrants,
+                                       static_cast<int>(std::lround(dynamicConfig.sampleFraction * populationSize)));
+
+                stale.assign(n, 1);
+                numOfStale = n;
+                for (auto& terms : piTerms){
+                    terms.clear();
+                }
+                std::vector<int> refresh(order.begin(), order.begin() + elites);
+                // 最差的individuals換成新的隨機individuals
+                Agent old;
+                for (int r = n - immigrants; r < n; r++){
+                    int k = order[r];
+                    old = population[k];
+                    for (unsigned int i = 0; i < numOfParameters; i++){
+                        population[k][i] = Narrow(i, std::uniform_real_distribution<double>(SampleLower(i), SampleUpper(i))(generator));
+                    }
+                    statistics.Replaced(old, population[k], piCost[k], piCost[k]);
+                    EvaluateViolation(population[k], std::numeric_limits<double>::infinity(), piViolation[k]);
+                    refresh.push_back(k);
+                }
+                // 其他individuals中隨機抽樣 (partial Fisher-Yates)
+                for (int r = 0; r < samples; r++){
+                    int last = n - immigrants;
+                    int pick = std::uniform_int_distribution<int>(elites + r, last - 1)(generator);
+                    std::swap(order[elites + r], order[pick]);
+                    refresh.push_back(order[elites + r]);
+                }
+                std::sort(refresh.begin(), refresh.end());
+
+                // 依index順序evaluation (infeasible的cost為+inf)
+                std::vector<int> feasible;
+                for (int k : refresh){
+                    if (piViolation[k] <= epsilon){
+                        feasible.push_back(k);
+                    }
+                }
+                std::vector<double> costs(feasible.size());
+                if (evaluator){
+                    std::vector<Agent> batch;
+                    for (int k : feasible){
+                        batch.push_back(population[k]);
+                    }
+                    EvaluateAgents(batch, costs);
+                }
+                else{
+                    ForEachIndex(static_cast<int>(feasible.size()), [&](int t){
+                        costs[t] = CallObjective(population[feasible[t]], std::numeric_limits<double>::infinity());
+                    });
+                    for (size_t t = 0; t < feasible.size(); t++){
+                        CountEvaluation(population[feasible[t]], costs[t], std::numeric_limits<double>::infinity());
+                    }
+                }
+                numOfReevaluations += feasible.size();
+                size_t next = 0;
+                for (int k : refresh){
+                    Refreshed(k, piViolation[k] <= epsilon ? costs[next++] : std::numeric_limits<double>::infinity());
+                }
+
+                // 舊資料上的best與停滯基準不再有意義
+                UpdateBestAgent();
+                stagnationCost = piCost[bestAgentIndex];
+                stagnationGeneration = generation;
+                globalBestAgent.clear();
+                UpdateGlobalBest();
+            }
+
+            // 檢查目前的run是否停滯 停滯時restart
+            void CheckRestart()
+            {
+                if (restartConfig.maxRestarts && restartHistory.size() >= restartConfig.maxRestarts){
+                    return;
+                }
+                // 最好的cost有(相對)改善時重新計算停滯的generation數
+                double best = piCost[bestAgentIndex];
+                if (best < stagnationCost &&
+                    (!std::isfinite(stagnationCost) ||
+                     stagnationCost - best > restartConfig.improvementTolerance * (1 + std::fabs(stagnationCost)))){
+                    stagnationCost = best;
+                    stagnationGeneration = generation;
+                }
+
+                if (restartConfig.stagnationGenerations &&
+                    generation - stagnationGeneration >= restartConfig.stagnationGenerations){
+                    Restart(RestartReason::NoImprovement);
+                }
+                else if (restartConfig.diversityTolerance > 0 &&
+                         statistics.MeanStd() < restartConfig.diversityTolerance * startDiversity){
+                    Restart(RestartReason::LowDiversity);
+                }
+                else if (restartConfig.costTolerance > 0 && statistics.numOfFiniteCosts() == populationSize &&
+                         statistics.CostRange() <= restartConfig.costTolerance * (1 + std::fabs(statistics.MinCost()))){
+                    Restart(RestartReason::FlatCosts);
+                }
+            }
 
-            
-            
-            // 檢查某個individuals是否符合constraint
-            bool CheckConstraints(std::vector<double> agent)
+            // 以新的population大小重新開始 (generation和evaluation數繼續累計)
+            void Restart(RestartReason reason)
             {
-                // 對individuals的每個維度value進行檢查
-                // 檢查會先看isConstrained是否為true true代表還沒限制範圍
-                // 一旦有限制範圍就會檢查是否在範圍內
-                // 這個function會回傳true代表individuals符合constraint false代表不符合
-                for (int i = 0; i < agent.size(); i++)
-                {
-                    if (!constraints[i].Check(agent[i]))
-                    {
-                        return false;
-                    }
+                RestartRecord record;
+                record.generation = generation;
+                record.evaluations = numOfEvaluations;
+                record.oldPopulationSize = populationSize;
+                record.bestCost = piCost[bestAgentIndex];
+                record.reason = reason;
+
+                // 這個run用掉的evaluation算在它的regime
+                unsigned long long used = numOfEvaluations - runEvaluations;
+                if (smallRegime){
+                    smallBudget += used;
+                }
+                else{
+                    largeBudget += used;
                 }
 
-                return true;
+                unsigned int size;
+                if (restartConfig.strategy == RestartStrategy::BIPOP && smallBudget < largeBudget){
+                    // small regime: N0 * (0.5 * Nlarge / N0)^(u^2), u ~ U(0, 1)
+                    std::uniform_real_distribution<double> dist(0.0, 1.0);
+                    double u = dist(generator);
+                    double ratio = 0.5 * LargePopulationSize(numOfLargeRestarts + 1) / basePopulationSize;
+                    size = static_cast<unsigned int>(std::floor(basePopulationSize * std::pow(ratio, u * u)));
+                    smallRegime = true;
+                }
+                else{
+                    numOfLargeRestarts++;
+                    size = LargePopulationSize(numOfLargeRestarts);
+                    smallRegime = false;
+                }
+                size = std::max(4u, size);
+                record.newPopulationSize = size;
+                restartHistory.push_back(record);
+
+                ResizePopulation(size);
+                SamplePopulation();
+                StartRun();
+                UpdateGlobalBest();
             }
 
+            // Batch cost used by the local search
+            // infeasible的點cost為+inf; 有evaluator時交給evaluator 否則用pool平行evaluation
+            void EvaluatePolishBatch(const std::vector<std::vector<double>>& agents, std::vector<double>& costs)
+            {
+                costs.assign(agents.size(), std::numeric_limits<double>::infinity());
+                std::vector<std::vector<double>> feasible;
+                std::vector<size_t> feasibleIndex;
+                for (size_t i = 0; i < agents.size(); i++){
+                    double violation;
+                    if (EvaluateViolation(agents[i], epsilon, violation)){
+                        feasible.push_back(agents[i]);
+                        feasibleIndex.push_back(i);
+                    }
+                }
+                std::vector<double> feasibleCosts(feasible.size());
+                if (evaluator){
+                    evaluator->EvaluateBatch(feasible, feasibleCosts);
+                }
+                else{
+                    ForEachIndex(static_cast<int>(feasible.size()), [&](int i){
+                        feasibleCosts[i] = costFunction.EvaluateCostView(feasible[i]);
+                    });
+                }
+                // 依index順序計數及更新surrogate
+                for (size_t t = 0; t < feasible.size(); t++){
+                    costs[feasibleIndex[t]] = feasibleCosts[t];
+                    numOfEvaluations++;
+                    numOfPolishEvaluations++;
+                    if (surrogate){
+                        surrogate->Add(feasible[t], feasibleCosts[t]);
+                    }
+                }
+            }
 
         public:
             /*
@@ -120,30 +1656,77 @@ namespace DE
                         * Initialize this min cost to negative infinity
                     * shouldCheckConstraint: bool
                         * Whether to check the constraints
-                    * callback: std::function<void(const DifferentialEvolution&)>
+                    * callback: std::function<void(const BasicDifferentialEvolution&)>
                         * A callback function to be called after each iteration  
             */
             // ** Constructor
-            DifferentialEvolution(
-                const Optimize& costFunction,
+            BasicDifferentialEvolution(
+                const Objective& costFunction,
                 unsigned int populationSize,
                 double F, // Weight
                 double CR, // Crossover-Rate
                 int RandomSeed=123,
                 bool shouldCheckConstraint=true,
-                std::function<void(const DifferentialEvolution&)> callback=nullptr,
-                std::function<bool(const DifferentialEvolution&)> terminateCondition=nullptr
+                std::function<void(const BasicDifferentialEvolution&)> callback=nullptr,
+                std::function<bool(const BasicDifferentialEvolution&)> terminateCondition=nullptr
             ):
                 // Initialize the member variables
                 costFunction(costFunction),
                 populationSize(populationSize),
-                F(0.8),
-                CR(0.9),
+                F(F),
+                CR(CR),
                 bestAgentIndex(0),  
                 minCost(-std::numeric_limits<double>::infinity()),
                 shouldCheckConstraint(shouldCheckConstraint),
                 callBack(callback),
-                TerminateCondition(terminateCondition)
+                TerminateCondition(terminateCondition),
+                numOfEvaluations(0),
+                surrogateCandidates(1),
+                surrogateScreen(false),
+                surrogateSkipped(0),
+                evaluator(nullptr),
+                generation(0),
+                trace(nullptr),
+                constraintHandling(ConstraintHandling::FeasibilityRules),
+                epsilon(0),
+                epsilon0(0),
+                epsilonGenerations(0),
+                epsilonExponent(5.0),
+                constraintRejected(0),
+                deterministic(false),
+                pool(nullptr),
+                randomSeed(RandomSeed),
+                boundedEvaluation(true),
+                numOfAborted(0),
+                separable(nullptr),
+                incrementalEvaluation(true),
+                numOfTermEvaluations(0),
+                restarts(false),
+                basePopulationSize(populationSize),
+                stagnationCost(std::numeric_limits<double>::infinity()),
+                stagnationGeneration(0),
+                startDiversity(0),
+                runEvaluations(0),
+                numOfLargeRestarts(0),
+                largeBudget(0),
+                smallBudget(0),
+                smallRegime(false),
+                globalBestCost(std::numeric_limits<double>::infinity()),
+                globalBestViolation(std::numeric_limits<double>::infinity()),
+                initialization(Initialization::Uniform),
+                unboundedScale(1.0),
+                polishing(false),
+                numOfPolishEvaluations(0),
+                initialized(false),
+                dynamic(false),
+                dataVersion(0),
+                numOfStale(0),
+                numOfDataChanges(0),
+                numOfReevaluations(0),
+                cancellation(nullptr),
+                hasDeadline(false),
+                stopReason(StopReason::Completed),
+                deadlineOvershoot(0)
             {
                 /* Constructor Initialization */
                 generator.seed(RandomSeed);
@@ -165,157 +1748,577 @@ namespace DE
                 // 包含lower,upper,是否有constraint的vector
                 constraints = costFunction.getConstraints();
 
+                // nonlinear constraints: 便宜的先evaluation
+                nonlinearConstraints = costFunction.getNonlinearConstraints();
+                std::stable_sort(nonlinearConstraints.begin(), nonlinearConstraints.end(),
+                    [](const Optimize::NonlinearConstraint& a, const Optimize::NonlinearConstraint& b){
+                        return a.cost < b.cost;
+                    });
+                piViolation.assign(populationSize, 0.0);
+
+                // separable objective: 記錄每個parameter所屬的term
+                if constexpr (std::is_polymorphic_v<Objective>){
+                    separable = dynamic_cast<const SeparableOptimize*>(&costFunction);
+                }
+                if (separable){
+                    termOf.resize(numOfParameters);
+                    for (unsigned int i = 0; i < numOfParameters; i++){
+                        termOf[i] = separable->TermOfParameter(i);
+                        assert(termOf[i] < separable->numOfTerms());
+                    }
+                }
+                piTerms.resize(populationSize);
+
             }
             
 
             // INIT POPULATION
             void InitializePopulation(){
-                // 產生一個uniform distribution 範圍是0~1
-                std::shared_ptr<std::uniform_real_distribution<double>> dist;
-                // 對每個個體population[i]進行初始化
-                for (auto& pi : population){
-                    // 對每個維度進行初始化
-                    for (int i=0;i<numOfParameters;i++){
-
-                        if (constraints[i].isConstrained){
-                            // 如果有constraint就使用constraint的lower和upper
-                            dist = std::make_shared<std::uniform_real_distribution<double>>(std::uniform_real_distribution<double> (constraints[i].lower,constraints[i].upper));
-                        }
-                        else{
-                            // 如果沒有constraint就使用lowerConstraint和upperConstraint
-                            dist = std::make_shared<std::uniform_real_distribution<double>>(std::uniform_real_distribution<double>(lowerConstraint,upperConstraint));
-                        }
-                        // pi[i]產生一個隨機值-範圍如果有constraint就是constraints[i].lower,constraints[i].upper
-                        // 如果沒有constraint就是lowerConstraint,upperConstraint
-                        pi[i] = (*dist)(generator);
-                    }
+                generation = 0;
+                // 新的run: 回到原本的population大小 清除restart紀錄與global best
+                if (populationSize != basePopulationSize){
+                    ResizePopulation(basePopulationSize);
                 }
+                restartHistory.clear();
+                numOfLargeRestarts = 0;
+                largeBudget = 0;
+                smallBudget = 0;
+                smallRegime = false;
+                globalBestAgent.clear();
+                dataVersion = costFunction.dataVersion();
 
-
-                // 目的: 更新每個xi的cost 以及 找出最小的cost和index
-                for(int i=0;i<populationSize;i++)
-                {
-                    // piCost[i]代表的是population[i]的cost
-                    // cost透過EvaluateCost function計算
-                    piCost[i] = costFunction.EvaluateCost(population[i]);
-                    // find the best cost and index 
-                    if (piCost[i] < minCost){
-                        minCost= piCost[i];
-                        bestAgentIndex = i;
-                        // Cost: in the cost function means the value of the cost function
+                SamplePopulation();
+                StartRun();
+                UpdateGlobalBest();
+                initialized = true;
+            }
+            // Evaluate the current population again after the objective has changed
+            /*
+                * The individuals are kept; their violations and costs are
+                * recomputed (term values of separable objectives too) and the
+                * best individual, the statistics and the global best are
+                * reset to the new costs. Stagnation is measured from here.
+            */
+            void ReevaluatePopulation(){
+                EvaluateViolations();
+                EvaluatePopulation();
+                if (trace){
+                    for (int i = 0; i < populationSize; i++){
+                        if (std::isfinite(piCost[i])){
+                            RecordTrace(i, population[i], piCost[i], true);
+                        }
                     }
                 }
-            
-
+                statistics.Reset(population, piCost);
+                UpdateBestAgent();
+                stagnationCost = piCost[bestAgentIndex];
+                stagnationGeneration = generation;
+                globalBestAgent.clear();
+                UpdateGlobalBest();
             }
+
             // GET POPULATION
-            const std::vector<std::vector<double>>& getPopulation() const{
+            const std::vector<Agent>& getPopulation() const{
                 return population;
             }
 
             // Selecttion and the crossover process
             void SelectAndCross(){
                 // std::cout << "Starting SelectAndCross" << std::endl;
+                stopReason = StopReason::Completed;
+                if (StopRequested()){
+                    MeasureOvershoot();
+                    return;
+                }
+                generation++;
+                UpdateEpsilon();
+                if (dynamic){
+                    CheckDataVersion();
+                }
 
-                // 產生一個uniform distribution 範圍是0~populationSize
-                std::uniform_real_distribution<double> dist(0,populationSize);
+                // deterministic parallel mode: 每個individuals有自己的亂數stream
+                if (deterministic){
+                    SelectAndCrossDeterministic();
+                }
+                // 有evaluator時改用整個generation一起evaluation的版本
+                else if (evaluator){
+                    SelectAndCrossBatch();
+                }
+                else{
+                    SelectAndCrossSerial();
+                }
 
-                // local MinCost
-                double MinCost = piCost[0];
-                // local bestAgentIndex
-                int oneBestAgentIndex = 0;
+                bool stopped = stopReason != StopReason::Completed;
+                if (!stopped && polishing && polishConfig.everyGenerations && generation % polishConfig.everyGenerations == 0){
+                    Polish(polishConfig.numOfAgents);
+                }
+                UpdateGlobalBest();
+                if (!stopped && restarts){
+                    CheckRestart();
+                }
+                MeasureOvershoot();
+            }
 
-                // 選擇和交叉,跑過所有的individuals
-                for(int k = 0; k < populationSize; k++){
+            // Surrogate-assisted mode
+            /*
+                * INPUT:
+                    * candidates: number of trial vectors generated per target;
+                        the one with the lowest predicted cost is really evaluated
+                    * archiveSize: number of (vector, cost) pairs kept by the model
+                    * neighbours: number of nearest neighbours used in a prediction
+                    * screen: skip the real evaluation when even the best candidate
+                        is not predicted to beat the target's cost
+            */
+            void EnableSurrogate(unsigned int candidates,
+                                 unsigned int archiveSize = 256,
+                                 unsigned int neighbours = 5,
+                                 bool screen = false)
+            {
+                assert(candidates >= 1 && "At least one candidate per target");
+                surrogate.reset(new SurrogateModel(numOfParameters, archiveSize, neighbours));
+                // 用constraint的範圍作為距離的縮放
+                std::vector<double> widths(numOfParameters, 0.0);
+                for (unsigned int i = 0; i < numOfParameters; i++){
+                    if (constraints[i].isConstrained){
+                        widths[i] = constraints[i].upper - constraints[i].lower;
+                    }
+                }
+                surrogate->SetScale(widths);
+                surrogateCandidates = candidates;
+                surrogateScreen = screen;
+                surrogateSkipped = 0;
+            }
 
-                    // std::cout << "SAC: " << k << std::endl;
+            void DisableSurrogate()
+            {
+                surrogate.reset();
+                surrogateCandidates = 1;
+                surrogateScreen = false;
+            }
 
-                    // 挑選三個不同的individuals a,b,c 初始化=k
-                    int a = k;
-                    int b = k;
-                    int c = k;
+            // Evaluate trials in batches through an evaluator (nullptr: evaluate one by one)
+            // The evaluator is not owned and must outlive the optimization
+            void SetEvaluator(Evaluator* batchEvaluator)
+            {
+                evaluator = batchEvaluator;
+            }
 
-                    // 確保a,b,c不相等(透過generator產生隨機數),break while 如果a,b,c不相等且a,b,c不等於k
-                    while(a == k || b == k || c == k || a == b || a == c || b == c){
-                        // a,b,c are random numbers 範圍在0~populationSize
-                        a = dist(generator);
-                        b = dist(generator);
-                        c = dist(generator);
-                    }
+            // Deterministic parallel mode
+            /*
+                * Every generation is generation-synchronous and trial k draws its
+                * random numbers from StreamRandom(RandomSeed, generation, k), so
+                * the run is bit-identical for any number of threads (including
+                * threadPool = nullptr, which uses the calling thread).
+                * The sequence differs from the default serial mode.
+                * INPUT:
+                    * threadPool: workers that build and evaluate the trials (not
+                        owned, must outlive the optimization); the objective is
+                        called concurrently unless an evaluator is set
+            */
+            void EnableDeterministicParallel(ThreadPool* threadPool = nullptr)
+            {
+                deterministic = true;
+                pool = threadPool;
+            }
+
+            void DisableDeterministicParallel()
+            {
+                deterministic = false;
+                pool = nullptr;
+            }
+
+            // Record every evaluated (vector, cost, generation, accepted) to a trace file
+            // The recorder is not owned and must outlive the optimization (nullptr: stop recording)
+            void SetTraceRecorder(TraceRecorder* recorder)
+            {
+                assert(!recorder || recorder->numOfParameters() == numOfParameters);
+                trace = recorder;
+            }
+
+            // Selection rule for nonlinear constraints
+            /*
+                * INPUT:
+                    * mode: ConstraintHandling::FeasibilityRules or ConstraintHandling::EpsilonConstrained
+                    * controlGenerations: generations until epsilon reaches 0 (epsilon mode)
+                    * exponent: epsilon(t) = epsilon0 * (1 - t / controlGenerations)^exponent
+            */
+            void SetConstraintHandling(ConstraintHandling mode,
+                                       unsigned int controlGenerations = 1000,
+                                       double exponent = 5.0)
+            {
+                constraintHandling = mode;
+                epsilonGenerations = controlGenerations;
+                epsilonExponent = exponent;
+                UpdateEpsilon();
+            }
+
+            // * 回傳最好的individuals違反nonlinear constraint的量(0代表feasible)
+            double GetBestViolation() const
+            {
+                return piViolation[bestAgentIndex];
+            }
+
+            // * 回傳在objective之前就被constraint淘汰的trial數
+            unsigned long long GetNumOfConstraintRejections() const
+            {
+                return constraintRejected;
+            }
+
+            // * 回傳目前的generation
+            unsigned int GetGeneration() const
+            {
+                return generation;
+            }
+
+            // * 回傳真正呼叫cost function的次數
+            unsigned long long GetNumOfEvaluations() const
+            {
+                return numOfEvaluations;
+            }
 
-                    // std::cout << "Selected individuals: a=" << a << " b=" << b << " c=" << c << std::endl;
+            // Pass the target's cost as threshold to EvaluateCostBounded (default: enabled)
+            // Only used without an evaluator and without the surrogate
+            void SetBoundedEvaluation(bool enable)
+            {
+                boundedEvaluation = enable;
+            }
 
-                    // Form intermediate solutions : Z=a+F*(b-c) // Z[i]代表的是新的individuals(即一個新的x)
-                    std::vector<double> Z(numOfParameters);
-                    for (int i=0;i<numOfParameters;i++){
-                        // 隨機選三個individuals a,b,c 並進行交叉 
-                        Z[i] = population[a][i] + F*(population[b][i] - population[c][i]);
+            // Recompute only the changed terms of a SeparableOptimize (default: enabled)
+            // Not used with an evaluator
+            void SetIncrementalEvaluation(bool enable)
+            {
+                incrementalEvaluation = enable;
+                if (!enable){
+                    for (auto& terms : piTerms){
+                        terms.clear();
                     }
+                }
+            }
+
+            // * 回傳實際計算過的term數 (SeparableOptimize)
+            unsigned long long GetNumOfTermEvaluations() const
+            {
+                return numOfTermEvaluations;
+            }
+
+            // * 回傳提早結束的(bounded) evaluation次數
+            unsigned long long GetNumOfAbortedEvaluations() const
+            {
+                return numOfAborted;
+            }
+
+            // * 回傳被surrogate跳過的evaluation次數
+            unsigned long long GetNumOfSkippedEvaluations() const
+            {
+                return surrogateSkipped;
+            }
+
+            // Sampling of the initial population (and of restarts)
+            /*
+                * INPUT:
+                    * method: Initialization::Uniform, LatinHypercube, Sobol or Opposition
+                    * unboundedScale: dimensions without a constraint are sampled
+                        in [-unboundedScale, unboundedScale]
+            */
+            void SetInitialization(Initialization method, double unboundedScale = 1.0)
+            {
+                assert(unboundedScale > 0 && "The scale of unbounded dimensions must be positive");
+                initialization = method;
+                this->unboundedScale = unboundedScale;
+            }
+
+            // Polish the best individuals with a local search
+            /*
+                * With everyGenerations > 0 the numOfAgents best individuals are
+                * polished every everyGenerations generations; with finalPolish
+                * OptimizeStep polishes them after the last generation.
+                * The finite-difference gradient points (and the Nelder-Mead
+                * initial simplex) are evaluated as one batch: through the
+                * evaluator when one is set, otherwise on the deterministic
+                * mode's thread pool, otherwise in the calling thread.
+                * INPUT:
+                    * config: method, budget, tolerance and schedule
+            */
+            void EnablePolishing(const PolishConfig& config = PolishConfig())
+            {
+                polishing = true;
+                polishConfig = config;
+            }
+
+            void DisablePolishing()
+            {
+                polishing = false;
+            }
 
+            // Run the local search now from the numOfAgents best (feasible) individuals
+            // An individual is replaced when the search found a lower cost
+            std::vector<PolishResult> Polish(unsigned int numOfAgents = 1)
+            {
+                std::vector<int> order(populationSize);
+                for (int k = 0; k < populationSize; k++){
+                    order[k] = k;
+                }
+                std::stable_sort(order.begin(), order.end(), [this](int a, int b){
+                    return Better(piCost[a], piViolation[a], piCost[b], piViolation[b]);
+                });
 
-                    // 對所有維度sample一個範圍0-1的值並給到vector X
-                    // X大小和一個individuals的維度相同
-                    std::uniform_real_distribution<double> distR(0,numOfParameters);
-                    int R = distR(generator);
-                    std::vector<double> X(numOfParameters);
-                    std::uniform_real_distribution<double> distX(0,1);
-                    for (auto& x : X){
-                        x = distX(generator);
+                // constraint的box (沒有constraint的維度不設限)
+                std::vector<double> lower(numOfParameters, lowerConstraint);
+                std::vector<double> upper(numOfParameters, upperConstraint);
+                for (unsigned int i = 0; i < numOfParameters; i++){
+                    if (constraints[i].isConstrained){
+                        lower[i] = constraints[i].lower;
+                        upper[i] = constraints[i].upper;
                     }
+                }
+                LocalSearch search([this](const std::vector<std::vector<double>>& agents, std::vector<double>& costs){
+                    EvaluatePolishBatch(agents, costs);
+                }, lower, upper, polishConfig);
 
-                    // 交叉
-                    // Y大小和一個individuals的維度相同
-                    std::vector<double> Y(numOfParameters); //Y代表new individuals(X)
-                    for(int i=0; i<numOfParameters; i++)
-                    {
-                        // X[i]剛剛被初始化為0~1的隨機值
-                        if (X[i] < CR || i == R){
-                            Y[i] = Z[i];
+                std::vector<PolishResult> results;
+                for (unsigned int n = 0; n < std::min(numOfAgents, populationSize); n++){
+                    int k = order[n];
+                    if (piViolation[k] > epsilon || !std::isfinite(piCost[k])){
+                        break;
+                    }
+                    std::vector<double> buffer;
+                    PolishResult result = search.Run(Widen(population[k], buffer), piCost[k]);
+                    if (result.cost < piCost[k]){
+                        Agent x(numOfParameters);
+                        for (unsigned int i = 0; i < numOfParameters; i++){
+                            x[i] = Narrow(i, result.x[i]);
                         }
-                        // 如果X[i] >= CR且i != R就不進行交叉
-                        else{
-                            Y[i] = population[k][i];
+                        double cost = result.cost;
+                        if constexpr (!std::is_same_v<Real, double>){
+                            // float storage: 捨入後的點重新evaluation
+                            cost = EvaluateAgent(x);
+                            numOfPolishEvaluations++;
+                        }
+                        if (cost < piCost[k]){
+                            double violation;
+                            EvaluateViolation(x, std::numeric_limits<double>::infinity(), violation);
+                            if (trace){
+                                RecordTrace(k, x, cost, true);
+                            }
+                            Accept(k, x, cost, violation, nullptr);
                         }
                     }
+                    results.push_back(result);
+                }
+                UpdateBestAgent();
+                UpdateGlobalBest();
+                return results;
+            }
 
-                    // 檢查是否符合constraint
-                    // 剛開始CheckConstraints是true表示還沒開始限縮範圍
-                    // 一旦開始限縮範圍就會檢查是否符合constraint 若不符合CheckConstraints會回傳false 
-                    // k--代表重新選擇individuals
-                    if (shouldCheckConstraint && !CheckConstraints(Y)){
-                        k--;
-                        // std::cout << "Constraints not met, retrying individual " << k << std::endl;
-                        continue;
-                    }
+            // * 回傳local search用掉的evaluation次數
+            unsigned long long GetNumOfPolishEvaluations() const
+            {
+                return numOfPolishEvaluations;
+            }
 
-                    // 決定現在更新的individuals是否比原本的individuals好 先評估cost fo Y
-                    double newCost = costFunction.EvaluateCost(Y);
-                    // std::cout << "Evaluated new cost: " << newCost << " for individual " << k << std::endl;
+            // Restart the population when the run stagnates (IPOP/BIPOP)
+            /*
+                * A restart samples a new population with the size given by the
+                * strategy; generation and the evaluation counters keep counting.
+                * The best individual of all runs is kept (GetGlobalBestAgent)
+                * but not injected into the new population.
+                * INPUT:
+                    * config: stagnation criteria and population growth
+            */
+            void EnableRestarts(const RestartConfig& config = RestartConfig())
+            {
+                restarts = true;
+                restartConfig = config;
+                // 已經初始化時從現在開始計算停滯
+                if (!globalBestAgent.empty()){
+                    StartRun();
+                }
+            }
 
-                    // 檢查cost是否小於每個individuals的cost
-                    if (newCost < piCost[k]){
-                        // 更新現在的individuals為Y
-                        population[k] = Y;
-                        // 更新現在的individuals的cost
-                        piCost[k] = newCost;
-                    }
-                    // 追蹤最小的cost
-                    if (piCost[k] < MinCost){
-                        MinCost = piCost[k];
-                        oneBestAgentIndex = k;
-                    }                    
+            void DisableRestarts()
+            {
+                restarts = false;
+            }
+
+            // * 回傳restart的次數
+            unsigned int GetNumOfRestarts() const
+            {
+                return static_cast<unsigned int>(restartHistory.size());
+            }
+
+            // * 回傳每次restart的紀錄
+            const std::vector<RestartRecord>& GetRestartHistory() const
+            {
+                return restartHistory;
+            }
+
+            // * 回傳目前的population大小
+            unsigned int GetPopulationSize() const
+            {
+                return populationSize;
+            }
+
+            // * 回傳所有run中最好的individuals與它的cost和violation
+            std::vector<double> GetGlobalBestAgent() const
+            {
+                return globalBestAgent;
+            }
+
+            double GetGlobalBestCost() const
+            {
+                return globalBestCost;
+            }
+
+            double GetGlobalBestViolation() const
+            {
+                return globalBestViolation;
+            }
+
+            // Track an objective whose data changes (Optimize::dataVersion)
+            /*
+                * The data version is checked at the start of every generation.
+                * After a change only the individuals chosen by config are
+                * re-evaluated at once; the others keep their old costs,
+                * marked stale, until they next meet a trial (see
+                * DynamicConfig). Stale individuals are never the best one.
+                * The global best and the stagnation baseline restart from the
+                * new data. OptimizeStep continues the current population
+                * instead of initializing a new one.
+                * INPUT:
+                    * config: fractions re-evaluated or replaced at a change
+            */
+            void EnableDynamicObjective(const DynamicConfig& config = DynamicConfig())
+            {
+                dynamic = true;
+                dynamicConfig = config;
+                if (!initialized){
+                    dataVersion = costFunction.dataVersion();
                 }
-                
-                minCost = MinCost;
-                bestAgentIndex = oneBestAgentIndex;
-                // std::cout << "Min Cost" << minCost << std::endl;
-                // std::cout << "Best Agent Index" << bestAgentIndex << std::endl;
+            }
+
+            void DisableDynamicObjective()
+            {
+                dynamic = false;
+            }
+
+            // * 回傳看到的資料變動次數
+            unsigned long long GetNumOfDataChanges() const
+            {
+                return numOfDataChanges;
+            }
+
+            // * 回傳因資料變動而重新evaluation的次數 (也算在numOfEvaluations中)
+            unsigned long long GetNumOfReevaluations() const
+            {
+                return numOfReevaluations;
+            }
+
+            // * 回傳cost還是舊資料上的individuals數
+            unsigned int GetNumOfStale() const
+            {
+                return static_cast<unsigned int>(numOfStale);
+            }
+
+            // Deadline and cooperative cancellation
+            /*
+                * Both are checked before every trial (by the workers in
+                * deterministic mode); OptimizeStep and SelectAndCross then
+                * return at once with the best-so-far (GetBestAgent,
+                * GetGlobalBestAgent). Trials already being evaluated finish
+                * first, so the overshoot is about one evaluation (serial),
+                * one batch (evaluator) or one evaluation per worker
+                * (deterministic). The initial population and a running
+                * polish are not interrupted. A generation cut short by a
+                * deadline depends on timing, so it is not reproducible.
+            */
+            void SetDeadline(std::chrono::steady_clock::time_point time)
+            {
+                hasDeadline = true;
+                deadline = time;
+            }
+
+            void SetDeadline(std::chrono::system_clock::time_point time)
+            {
+                SetDeadline(std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    time - std::chrono::system_clock::now()));
+            }
+
+            // deadline = now + seconds
+            void SetTimeBudget(double seconds)
+            {
+                SetDeadline(std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>(seconds)));
+            }
+
+            void ClearDeadline()
+            {
+                hasDeadline = false;
+            }
+
+            // token: shared with the thread that may cancel (nullptr: none)
+            void SetCancellationToken(CancellationToken* token)
+            {
+                cancellation = token;
+            }
+
+            // * 回傳上一次OptimizeStep/SelectAndCross提早結束的原因
+            StopReason GetStopReason() const
+            {
+                return stopReason;
+            }
+
+            // * 因deadline停止時 回傳時超過deadline的秒數
+            double GetDeadlineOvershoot() const
+            {
+                return deadlineOvershoot;
+            }
+
+            // Profiling of SelectAndCross
+            /*
+                * Measures the wall time, cycles, instructions, last-level
+                * cache misses and branch misses of trial construction
+                * (mutation, crossover, bounds, surrogate screening),
+                * evaluation (constraints and objective) and selection
+                * separately. Counters come from perf_event_open; where they
+                * cannot be opened only the wall times are reported
+                * (PerfReport::countersAvailable, reason). The serial loop
+                * reads the counters three times per trial, which costs about
+                * a microsecond: compare phases, not the total, with cheap
+                * objectives.
+            */
+            void EnableProfiling()
+            {
+                profile.reset(new PerfProfile());
+            }
+
+            void DisableProfiling()
+            {
+                profile.reset();
+            }
+
+            // * 回傳目前為止的profile (沒有啟用時為空的report)
+            PerfReport GetProfile() const
+            {
+                return profile ? profile->Report() : PerfReport();
+            }
+
+            void ResetProfile()
+            {
+                if (profile){
+                    profile->Reset();
+                }
+            }
+
+            // * 回傳population的統計量 (centroid, variance, bounding box, cost spread)
+            const BasicPopulationStatistics<Real>& GetStatistics() const
+            {
+                return statistics;
             }
 
             // * 回傳目前最好的individuals
             std::vector<double> GetBestAgent() const
             {
-                return population[bestAgentIndex];
+                return std::vector<double>(population[bestAgentIndex].begin(), population[bestAgentIndex].end());
             }
             // * 回傳目前最好的cost
             double GetBestCost() const
@@ -329,7 +2332,7 @@ namespace DE
                 // 定義一個pair對儲存population和cost
                 std::vector< std::pair< std::vector<double> , double>> populationCost;
                 for (int i=0;i<populationSize;i++){
-                    populationCost.push_back(std::make_pair(population[i],piCost[i]));
+                    populationCost.push_back(std::make_pair(std::vector<double>(population[i].begin(), population[i].end()),piCost[i]));
 
                 }
                 return populationCost;
@@ -362,13 +2365,21 @@ namespace DE
                         * verbose: 是否印出最小的cost和最好的individuals
                 */
 
-                // Initialize the population
-                InitializePopulation();
+                // Initialize the population (dynamic mode: 接續目前的population)
+                // (初始population的evaluation不會被deadline中斷)
+                stopReason = StopReason::Completed;
+                if (!dynamic || !initialized){
+                    InitializePopulation();
+                }
 
                 // Opt loop
                 for (int i=0; i<iterations; i++){
                     // Select and cross
                     SelectAndCross();
+                    // deadline或cancel: 回傳目前最好的individuals
+                    if (stopReason != StopReason::Completed){
+                        break;
+                    }
                     // Print message
                     if (verbose){
                         // 設定小數點位數
@@ -384,6 +2395,15 @@ namespace DE
                     }
                 }
 
+                // 最後用local search polish最好的individuals
+                if (polishing && polishConfig.finalPolish && stopReason == StopReason::Completed){
+                    Polish(polishConfig.numOfAgents);
+                    if (verbose){
+                        std::cout << "Polished Best Cost: " << minCost << std::endl;
+                    }
+                }
+                MeasureOvershoot();
+
                 // 檢查是否有callback function
                 if (callBack){
                     // 將當前對象傳遞給callback function
@@ -401,12 +2421,24 @@ namespace DE
                 }
                 // Print messages
                 if(verbose){
-                    std::cout << "Terminated due to exceeding total number of generations." << std::endl;
+                    if (stopReason == StopReason::Deadline){
+                        std::cout << "Stopped at the deadline (overshoot " << deadlineOvershoot << " s)." << std::endl;
+                    }
+                    else if (stopReason == StopReason::Cancelled){
+                        std::cout << "Cancelled." << std::endl;
+                    }
+                    else{
+                        std::cout << "Terminated due to exceeding total number of generations." << std::endl;
+                    }
                 }
 
             }
 
     };
 
+    // Runtime-polymorphic optimizer: any Optimize subclass, Python objectives
+    using DifferentialEvolution = BasicDifferentialEvolution<Optimize>;
+    // Same with single-precision population storage
+    using DifferentialEvolutionFloat = BasicDifferentialEvolution<Optimize, float>;
 
 }
\ No newline at end of file
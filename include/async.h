@@ -0,0 +1,470 @@
+#pragma once
+
+#if __cplusplus < 202002L
+#error "async.h needs C++20 coroutines, build it with the DE_async target (-DDE_BUILD_ASYNC=ON)"
+#endif
+
+#include <coroutine>
+#include <exception>
+#include <utility>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <random>
+#include <limits>
+#include <algorithm>
+#include <cassert>
+
+#include "DE.h"
+
+
+
+namespace DE
+{
+    /* Task<T>: lazily started coroutine whose result is awaited by its caller */
+    template<typename T>
+    class Task{
+        public:
+            struct promise_type
+            {
+                T value{};
+                std::exception_ptr exception;
+                std::coroutine_handle<> continuation;
+
+                Task get_return_object()
+                {
+                    return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+                }
+                std::suspend_always initial_suspend() noexcept { return {}; }
+
+                // 結束時直接跳回await這個task的coroutine(symmetric transfer)
+                struct FinalAwaiter
+                {
+                    bool await_ready() noexcept { return false; }
+                    std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept
+                    {
+                        if (h.promise().continuation){
+                            return h.promise().continuation;
+                        }
+                        return std::noop_coroutine();
+                    }
+                    void await_resume() noexcept {}
+                };
+                FinalAwaiter final_suspend() noexcept { return {}; }
+
+                void return_value(T v) { value = std::move(v); }
+                void unhandled_exception() { exception = std::current_exception(); }
+            };
+
+            Task(Task&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+            Task(const Task&) = delete;
+            Task& operator=(const Task&) = delete;
+            ~Task()
+            {
+                if (handle){
+                    handle.destroy();
+                }
+            }
+
+            // Awaitable interface
+            bool await_ready() const noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> caller) noexcept
+            {
+                handle.promise().continuation = caller;
+                return handle;
+            }
+            T await_resume()
+            {
+                if (handle.promise().exception){
+                    std::rethrow_exception(handle.promise().exception);
+                }
+                return std::move(handle.promise().value);
+            }
+
+        private:
+            explicit Task(std::coroutine_handle<promise_type> h) : handle(h) {}
+            std::coroutine_handle<promise_type> handle;
+    };
+
+    // The awaitable cost returned by an asynchronous objective
+    using CostTask = Task<double>;
+
+
+    /* AsyncExecutor: a small pool of threads that resumes coroutines */
+    class AsyncExecutor{
+        private:
+            std::vector<std::thread> workers;
+            std::deque<std::coroutine_handle<>> queue;
+            std::mutex mutex;
+            std::condition_variable ready;
+            bool stopping = false;
+
+            void WorkerLoop()
+            {
+                for (;;){
+                    std::coroutine_handle<> h;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        ready.wait(lock, [this]{ return stopping || !queue.empty(); });
+                        if (queue.empty()){
+                            return;
+                        }
+                        h = queue.front();
+                        queue.pop_front();
+                    }
+                    h.resume();
+                }
+            }
+
+        public:
+            explicit AsyncExecutor(unsigned int numOfThreads = 1)
+            {
+                assert(numOfThreads > 0);
+                for (unsigned int i = 0; i < numOfThreads; i++){
+                    workers.emplace_back([this]{ WorkerLoop(); });
+                }
+            }
+
+            ~AsyncExecutor()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    stopping = true;
+                }
+                ready.notify_all();
+                for (auto& w : workers){
+                    w.join();
+                }
+            }
+
+            AsyncExecutor(const AsyncExecutor&) = delete;
+            AsyncExecutor& operator=(const AsyncExecutor&) = delete;
+
+            // 把一個暫停中的coroutine排入執行佇列
+            void Post(std::coroutine_handle<> h)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    queue.push_back(h);
+                }
+                ready.notify_one();
+            }
+
+            // co_await executor.Schedule() 會把coroutine移到executor的thread上繼續執行
+            struct ScheduleAwaiter
+            {
+                AsyncExecutor& executor;
+                bool await_ready() const noexcept { return false; }
+                void await_suspend(std::coroutine_handle<> h) { executor.Post(h); }
+                void await_resume() const noexcept {}
+            };
+            ScheduleAwaiter Schedule()
+            {
+                return ScheduleAwaiter{*this};
+            }
+    };
+
+
+    /* AsyncOptimize: objective whose cost is an awaitable */
+    class AsyncOptimize{
+    public:
+        // input is taken by value so that it lives in the coroutine frame
+        virtual CostTask EvaluateCostAsync(std::vector<double> input) const = 0;
+        virtual unsigned int numOfParameters() const = 0;
+        virtual std::vector<Optimize::Constraint> getConstraints() const = 0;
+        virtual ~AsyncOptimize() {};
+    };
+
+    // Run a blocking Optimize on an executor thread
+    class AsyncAdaptor : public AsyncOptimize
+    {
+        private:
+            const Optimize& costFunction;
+            AsyncExecutor& executor;
+
+        public:
+            AsyncAdaptor(const Optimize& costFunction, AsyncExecutor& executor) :
+                costFunction(costFunction),
+                executor(executor)
+            {}
+
+            CostTask EvaluateCostAsync(std::vector<double> input) const override
+            {
+                co_await executor.Schedule();
+                co_return costFunction.EvaluateCostView(input);
+            }
+
+            unsigned int numOfParameters() const override
+            {
+                return costFunction.numOfParameters();
+            }
+
+            std::vector<Optimize::Constraint> getConstraints() const override
+            {
+                return costFunction.getConstraints();
+            }
+    };
+
+
+    /* AsyncDifferentialEvolution: asynchronous steady-state DE */
+    /*
+        * Up to maxInFlight trials are evaluated at the same time, one per
+        * target. Whenever an evaluation completes its trial is compared with
+        * the target right away and a new trial is launched for that slot,
+        * so a slow evaluation never holds back the rest of the population.
+    */
+    class AsyncDifferentialEvolution{
+
+        private:
+            // fire-and-forget coroutine used to drive one evaluation
+            struct Detached
+            {
+                struct promise_type
+                {
+                    Detached get_return_object() { return {}; }
+                    std::suspend_never initial_suspend() noexcept { return {}; }
+                    std::suspend_never final_suspend() noexcept { return {}; }
+                    void return_void() {}
+                    void unhandled_exception() { std::terminate(); }
+                };
+            };
+
+            // 完成的evaluation
+            struct Completion
+            {
+                int k;
+                std::vector<double> trial;
+                double cost;
+                std::exception_ptr exception;
+            };
+
+            const AsyncOptimize& costFunction;
+            unsigned int populationSize;
+            double F;
+            double CR;
+            unsigned int maxInFlight;
+            bool shouldCheckConstraint;
+            unsigned int numOfParameters;
+            int bestAgentIndex;
+            std::default_random_engine generator;
+            std::vector<std::vector<double>> population;
+            std::vector<double> piCost;
+            std::vector<Optimize::Constraint> constraints;
+            // 每個target是否有trial正在evaluation
+            std::vector<char> busy;
+            unsigned long long numOfEvaluations;
+
+            // completion queue shared with the evaluating threads
+            std::deque<Completion> completed;
+            std::mutex completedMutex;
+            std::condition_variable completedReady;
+
+            bool CheckConstraints(const std::vector<double>& agent) const
+            {
+                for (unsigned int i = 0; i < agent.size(); i++){
+                    if (!constraints[i].Check(agent[i])){
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            Detached Launch(int k, std::vector<double> trial)
+            {
+                Completion c{k, std::vector<double>(), 0.0, nullptr};
+                try{
+                    c.cost = co_await costFunction.EvaluateCostAsync(trial);
+                }
+                catch (...){
+                    c.exception = std::current_exception();
+                }
+                c.trial = std::move(trial);
+                // notify while holding the lock: once the completion is visible
+                // the engine may return and destroy the condition variable
+                std::lock_guard<std::mutex> lock(completedMutex);
+                completed.push_back(std::move(c));
+                completedReady.notify_one();
+            }
+
+            Completion WaitCompletion()
+            {
+                std::unique_lock<std::mutex> lock(completedMutex);
+                completedReady.wait(lock, [this]{ return !completed.empty(); });
+                Completion c = std::move(completed.front());
+                completed.pop_front();
+                return c;
+            }
+
+            // rand/1/bin trial for target k, built from the current population
+            void MakeTrial(int k, std::vector<double>& Y)
+            {
+                std::uniform_int_distribution<int> dist(0, populationSize - 1);
+                std::uniform_int_distribution<int> distR(0, numOfParameters - 1);
+                std::uniform_real_distribution<double> distX(0, 1);
+                do{
+                    int a = k, b = k, c = k;
+                    while (a == k || b == k || c == k || a == b || a == c || b == c){
+                        a = dist(generator);
+                        b = dist(generator);
+                        c = dist(generator);
+                    }
+                    int R = distR(generator);
+                    Y.resize(numOfParameters);
+                    for (unsigned int i = 0; i < numOfParameters; i++){
+                        if (distX(generator) < CR || static_cast<int>(i) == R){
+                            Y[i] = population[a][i] + F * (population[b][i] - population[c][i]);
+                        }
+                        else{
+                            Y[i] = population[k][i];
+                        }
+                    }
+                } while (shouldCheckConstraint && !CheckConstraints(Y));
+            }
+
+            // 等待所有正在evaluation的trial結束 並依序處理
+            void Drain(unsigned int& inFlight, bool initializing)
+            {
+                while (inFlight > 0){
+                    Apply(WaitCompletion(), inFlight, initializing);
+                }
+            }
+
+            void Apply(Completion c, unsigned int& inFlight, bool initializing)
+            {
+                inFlight--;
+                busy[c.k] = 0;
+                numOfEvaluations++;
+                if (c.exception){
+                    // 讓其他evaluation結束後才丟出例外 避免coroutine參考到已經消失的物件
+                    unsigned int remaining = inFlight;
+                    while (remaining > 0){
+                        WaitCompletion();
+                        remaining--;
+                    }
+                    inFlight = 0;
+                    std::rethrow_exception(c.exception);
+                }
+                if (initializing || c.cost < piCost[c.k]){
+                    population[c.k] = std::move(c.trial);
+                    piCost[c.k] = c.cost;
+                }
+                if (piCost[c.k] < piCost[bestAgentIndex]){
+                    bestAgentIndex = c.k;
+                }
+            }
+
+        public:
+            /*
+                * INPUT:
+                    * costFunction: AsyncOptimize whose EvaluateCostAsync returns a CostTask
+                    * populationSize: int
+                    * F: double
+                    * CR: double
+                    * maxInFlight: maximum number of evaluations awaited at the same time
+                        (at most one per target)
+                    * RandomSeed: int
+                    * shouldCheckConstraint: bool
+            */
+            AsyncDifferentialEvolution(
+                const AsyncOptimize& costFunction,
+                unsigned int populationSize,
+                double F,
+                double CR,
+                unsigned int maxInFlight,
+                int RandomSeed = 123,
+                bool shouldCheckConstraint = true
+            ):
+                costFunction(costFunction),
+                populationSize(populationSize),
+                F(F),
+                CR(CR),
+                maxInFlight(maxInFlight),
+                shouldCheckConstraint(shouldCheckConstraint),
+                bestAgentIndex(0),
+                numOfEvaluations(0)
+            {
+                assert(populationSize >= 4);
+                assert(maxInFlight > 0);
+                generator.seed(RandomSeed);
+                numOfParameters = costFunction.numOfParameters();
+                population.assign(populationSize, std::vector<double>(numOfParameters));
+                piCost.assign(populationSize, std::numeric_limits<double>::infinity());
+                busy.assign(populationSize, 0);
+                constraints = costFunction.getConstraints();
+            }
+
+            /*
+                * Initialize the population and run for `iterations` generations
+                * worth of trials (iterations * populationSize evaluations).
+                * The initial population is evaluated with the same in-flight limit.
+            */
+            void OptimizeStep(int iterations)
+            {
+                unsigned long long evaluations = static_cast<unsigned long long>(iterations) * populationSize;
+                unsigned int limit = std::min(maxInFlight, populationSize);
+                unsigned int inFlight = 0;
+
+                // INIT POPULATION
+                bestAgentIndex = 0;
+                for (unsigned int k = 0; k < populationSize; k++){
+                    std::vector<double> agent(numOfParameters);
+                    for (unsigned int i = 0; i < numOfParameters; i++){
+                        double lower = constraints[i].isConstrained ? constraints[i].lower : -1.0;
+                        double upper = constraints[i].isConstrained ? constraints[i].upper : 1.0;
+                        agent[i] = std::uniform_real_distribution<double>(lower, upper)(generator);
+                    }
+                    if (inFlight == limit){
+                        Apply(WaitCompletion(), inFlight, true);
+                    }
+                    busy[k] = 1;
+                    inFlight++;
+                    Launch(k, std::move(agent));
+                }
+                Drain(inFlight, true);
+
+                // Opt loop: 每完成一個evaluation就做selection並補上新的trial
+                unsigned long long launched = 0;
+                unsigned int cursor = 0;
+                while (launched < evaluations || inFlight > 0){
+                    while (launched < evaluations && inFlight < limit){
+                        // 找下一個沒有trial在evaluation的target
+                        while (busy[cursor]){
+                            cursor = (cursor + 1) % populationSize;
+                        }
+                        std::vector<double> trial;
+                        MakeTrial(cursor, trial);
+                        busy[cursor] = 1;
+                        inFlight++;
+                        launched++;
+                        Launch(cursor, std::move(trial));
+                        cursor = (cursor + 1) % populationSize;
+                    }
+                    if (inFlight > 0){
+                        Apply(WaitCompletion(), inFlight, false);
+                    }
+                }
+            }
+
+            std::vector<double> GetBestAgent() const
+            {
+                return population[bestAgentIndex];
+            }
+
+            double GetBestCost() const
+            {
+                return piCost[bestAgentIndex];
+            }
+
+            const std::vector<std::vector<double>>& getPopulation() const
+            {
+                return population;
+            }
+
+            unsigned long long GetNumOfEvaluations() const
+            {
+                return numOfEvaluations;
+            }
+    };
+}
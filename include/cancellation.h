@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+
+
+namespace DE
+{
+    // Why the last OptimizeStep/SelectAndCross returned (Completed: not stopped early)
+    enum class StopReason { Completed, Deadline, Cancelled };
+
+    /* CancellationToken: cooperative stop request shared with an optimizer */
+    /*
+        * Cancel() may be called from any thread; the optimizer checks the
+        * token between trials and returns its best-so-far. An optional poll
+        * function is called by the optimizing thread at most every
+        * pollInterval seconds and cancels the token when it returns true
+        * (the Python binding uses it to notice Ctrl-C while the GIL is
+        * released).
+    */
+    class CancellationToken{
+        private:
+            std::atomic<bool> cancelled;
+            std::function<bool()> poll;
+            std::chrono::steady_clock::duration pollInterval;
+            // 只由optimizer的thread讀寫
+            std::chrono::steady_clock::time_point lastPoll;
+
+        public:
+            explicit CancellationToken(std::function<bool()> poll = nullptr, double pollInterval = 0.05) :
+                cancelled(false),
+                poll(poll),
+                pollInterval(std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                    std::chrono::duration<double>(pollInterval))),
+                lastPoll()
+            {
+            }
+
+            CancellationToken(const CancellationToken&) = delete;
+            CancellationToken& operator=(const CancellationToken&) = delete;
+
+            void Cancel()
+            {
+                cancelled.store(true, std::memory_order_release);
+            }
+
+            // 重新使用token (下一個run不會被取消)
+            void Reset()
+            {
+                cancelled.store(false, std::memory_order_release);
+            }
+
+            bool IsCancelled() const
+            {
+                return cancelled.load(std::memory_order_acquire);
+            }
+
+            // Called by the optimizing thread: runs the poll function if it is due
+            bool Poll()
+            {
+                if (IsCancelled()){
+                    return true;
+                }
+                if (poll){
+                    auto now = std::chrono::steady_clock::now();
+                    if (now - lastPoll >= pollInterval){
+                        lastPoll = now;
+                        if (poll()){
+                            Cancel();
+                            return true;
+                        }
+                    }
+                }
+                return false;
+            }
+    };
+}
@@ -0,0 +1,570 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <random>
+#include <algorithm>
+#include <numeric>
+#include <limits>
+#include <cmath>
+#include <cassert>
+
+#include "DE.h"
+#include "random_stream.h"
+
+
+
+namespace DE
+{
+    // How CooperativeCoevolution splits the parameters into groups
+    /*
+        * Random: a random permutation cut into groups of groupSize.
+        * Fixed: the groups given in CoevolutionConfig::groups.
+        * Differential: differential grouping; parameters that interact
+        *   through the objective are put in the same group, separable
+        *   parameters are split into groups of groupSize.
+    */
+    enum class Grouping { Random, Fixed, Differential };
+
+    /* CoevolutionConfig: decomposition and sub-optimizer settings */
+    struct CoevolutionConfig
+    {
+        Grouping grouping;
+        // Random (以及Differential中的separable parameters) 每個group的大小
+        unsigned int groupSize;
+        // Fixed: 每個parameter剛好出現在一個group
+        std::vector<std::vector<unsigned int>> groups;
+        // 每個sub-optimizer的population大小 F CR
+        unsigned int populationSize;
+        double F;
+        double CR;
+        // 每個cycle中每個group跑幾個generation
+        unsigned int generationsPerCycle;
+        // Differential: |delta1 - delta2| 大於這個值視為有交互作用 (0: 依cost大小自動決定)
+        double interactionThreshold;
+        // Random: 每個cycle重新分組 (sub-population重新取樣)
+        bool regroup;
+        bool shouldCheckConstraint;
+
+        CoevolutionConfig(Grouping grouping = Grouping::Random,
+                          unsigned int groupSize = 50,
+                          std::vector<std::vector<unsigned int>> groups = {},
+                          unsigned int populationSize = 30,
+                          double F = 0.5,
+                          double CR = 0.9,
+                          unsigned int generationsPerCycle = 20,
+                          double interactionThreshold = 0.0,
+                          bool regroup = false,
+                          bool shouldCheckConstraint = true) :
+            grouping(grouping),
+            groupSize(groupSize),
+            groups(std::move(groups)),
+            populationSize(populationSize),
+            F(F),
+            CR(CR),
+            generationsPerCycle(generationsPerCycle),
+            interactionThreshold(interactionThreshold),
+            regroup(regroup),
+            shouldCheckConstraint(shouldCheckConstraint)
+        {
+            assert(groupSize >= 1 && "A group needs at least one parameter");
+            assert(populationSize >= 4);
+            assert(interactionThreshold >= 0);
+        }
+    };
+
+    /* CoevolutionSubproblem: the objective restricted to one group of parameters */
+    /*
+        * The other parameters are taken from the context vector. A
+        * subproblem owns a full-size buffer, so it must only be evaluated by
+        * one thread at a time (each sub-optimizer runs in a single task).
+    */
+    class CoevolutionSubproblem : public Optimize
+    {
+        private:
+            const Optimize& full;
+            std::vector<unsigned int> indices;
+            std::vector<Optimize::Constraint> constraints;
+            std::vector<Optimize::NonlinearConstraint> nonlinear;
+            mutable std::vector<double> buffer;
+
+        public:
+            CoevolutionSubproblem(const Optimize& costFunction, std::vector<unsigned int> group) :
+                full(costFunction),
+                indices(std::move(group))
+            {
+                std::vector<Optimize::Constraint> all = costFunction.getConstraints();
+                for (unsigned int i : indices){
+                    constraints.push_back(all[i]);
+                }
+                // nonlinear constraints: 把group的值放進context再呼叫原本的constraint
+                for (auto c : costFunction.getNonlinearConstraints()){
+                    auto function = c.function;
+                    c.function = [this, function](const std::vector<double>& sub){
+                        return function(Expand(sub.data()));
+                    };
+                    nonlinear.push_back(c);
+                }
+            }
+
+            CoevolutionSubproblem(const CoevolutionSubproblem&) = delete;
+            CoevolutionSubproblem& operator=(const CoevolutionSubproblem&) = delete;
+
+            void SetContext(const std::vector<double>& context)
+            {
+                buffer = context;
+            }
+
+            // context with the group's parameters replaced by sub
+            std::vector<double> Expand(const double* sub) const
+            {
+                std::vector<double> x(buffer);
+                for (size_t t = 0; t < indices.size(); t++){
+                    x[indices[t]] = sub[t];
+                }
+                return x;
+            }
+
+            double EvaluateCost(std::vector<double> input) const override
+            {
+                return EvaluateCostView(input);
+            }
+
+            double EvaluateCostView(VectorView input) const override
+            {
+                for (size_t t = 0; t < indices.size(); t++){
+                    buffer[indices[t]] = input[t];
+                }
+                return full.EvaluateCostView(buffer);
+            }
+
+            double EvaluateCostBounded(VectorView input, double threshold) const override
+            {
+                for (size_t t = 0; t < indices.size(); t++){
+                    buffer[indices[t]] = input[t];
+                }
+                return full.EvaluateCostBounded(buffer, threshold);
+            }
+
+            unsigned int numOfParameters() const override
+            {
+                return static_cast<unsigned int>(indices.size());
+            }
+
+            std::vector<Optimize::Constraint> getConstraints() const override
+            {
+                return constraints;
+            }
+
+            std::vector<Optimize::NonlinearConstraint> getNonlinearConstraints() const override
+            {
+                return nonlinear;
+            }
+
+            const std::vector<unsigned int>& Indices() const
+            {
+                return indices;
+            }
+    };
+
+
+    /* CooperativeCoevolution: one DifferentialEvolution per group of parameters */
+    /*
+        * Every cycle each group runs generationsPerCycle generations of its
+        * own sub-optimizer against a copy of the shared context vector (the
+        * best solution so far); the groups run in parallel on a ThreadPool
+        * when one is set. The best sub-vectors that improve on the context
+        * are then merged: all of them together if the merged vector is at
+        * least as good as the best single improvement (checked with one
+        * evaluation), otherwise only the best one. A sub-population is
+        * re-evaluated when parameters outside its group have changed.
+        * Sub-optimizers get their own seeds and the merge runs in group
+        * order, so the result does not depend on the number of threads.
+        *
+        * Differential grouping evaluates f at the lower corner, with x_i
+        * raised to its upper bound, with x_j moved to the middle of its
+        * range and with both changed; i and j interact when the two
+        * differences of x_i's effect disagree by more than the threshold.
+        * Single-change points are evaluated once, so grouping costs
+        * 2n + 1 evaluations plus one per pair tested (at most n(n-1)/2, for
+        * a fully separable problem). As in the original method, only
+        * direct interactions with the first parameter of a group are found.
+        * Unbounded parameters are probed in [-1, 1].
+    */
+    class CooperativeCoevolution{
+        private:
+            const Optimize& costFunction;
+            CoevolutionConfig config;
+            unsigned int numOfParameters;
+            std::vector<Optimize::Constraint> constraints;
+            std::vector<Optimize::NonlinearConstraint> nonlinearConstraints;
+            std::default_random_engine generator;
+            int randomSeed;
+            // 平行執行groups的thread pool (nullptr代表目前的thread)
+            ThreadPool* pool;
+            std::vector<std::vector<unsigned int>> groups;
+            std::vector<std::unique_ptr<CoevolutionSubproblem>> subproblems;
+            std::vector<std::unique_ptr<DifferentialEvolution>> optimizers;
+            // sub-population是否已初始化 以及是否需要重新evaluation
+            std::vector<char> started;
+            std::vector<char> stale;
+            // context vector (目前最好的解) 與它的cost和violation
+            std::vector<double> context;
+            double contextCost;
+            double contextViolation;
+            unsigned int cycle;
+            unsigned long long numOfEvaluations;
+            unsigned long long numOfGroupingEvaluations;
+
+            double SampleLower(unsigned int i) const
+            {
+                return constraints[i].isConstrained ? constraints[i].lower : -1.0;
+            }
+
+            double SampleUpper(unsigned int i) const
+            {
+                return constraints[i].isConstrained ? constraints[i].upper : 1.0;
+            }
+
+            // 0..n-1平行執行 (見ParallelFor)
+            template <class Task>
+            void ForEachIndex(int n, const Task& task)
+            {
+                ParallelFor(pool, n, task);
+            }
+
+            double Violation(const std::vector<double>& x) const
+            {
+                double violation = 0;
+                for (const auto& c : nonlinearConstraints){
+                    violation += c.Violation(x);
+                }
+                return violation;
+            }
+
+            // feasibility rules: violation小的優先 都feasible時比較cost
+            static bool Better(double costA, double violationA, double costB, double violationB)
+            {
+                if (violationA > 0 || violationB > 0){
+                    return violationA < violationB;
+                }
+                return costA < costB;
+            }
+
+            // infeasible時不呼叫objective (cost為+inf)
+            void Evaluate(const std::vector<double>& x, double& cost, double& violation)
+            {
+                violation = Violation(x);
+                cost = std::numeric_limits<double>::infinity();
+                if (violation <= 0){
+                    cost = costFunction.EvaluateCostView(x);
+                    numOfEvaluations++;
+                }
+            }
+
+            // parameters依序切成大小接近groupSize的groups
+            void Split(const std::vector<unsigned int>& parameters)
+            {
+                size_t n = parameters.size();
+                size_t count = (n + config.groupSize - 1) / config.groupSize;
+                for (size_t g = 0; g < count; g++){
+                    groups.emplace_back(parameters.begin() + n * g / count, parameters.begin() + n * (g + 1) / count);
+                }
+            }
+
+            void RandomGroups()
+            {
+                std::vector<unsigned int> order(numOfParameters);
+                std::iota(order.begin(), order.end(), 0u);
+                std::shuffle(order.begin(), order.end(), generator);
+                groups.clear();
+                Split(order);
+            }
+
+            void DifferentialGroups()
+            {
+                unsigned int n = numOfParameters;
+                std::vector<double> base(n);
+                std::vector<double> middle(n);
+                for (unsigned int i = 0; i < n; i++){
+                    base[i] = SampleLower(i);
+                    middle[i] = 0.5 * (SampleLower(i) + SampleUpper(i));
+                }
+                // f(base), f(x_i = upper) 及 f(x_j = middle) 各只evaluation一次
+                std::vector<double> single(2 * n + 1);
+                ForEachIndex(2 * n + 1, [&](int k){
+                    std::vector<double> x(base);
+                    if (k > 0 && k <= static_cast<int>(n)){
+                        x[k - 1] = SampleUpper(k - 1);
+                    }
+                    else if (k > static_cast<int>(n)){
+                        x[k - n - 1] = middle[k - n - 1];
+                    }
+                    single[k] = costFunction.EvaluateCostView(x);
+                });
+                numOfGroupingEvaluations += 2 * n + 1;
+                const double f0 = single[0];
+
+                // 自動threshold: 浮點數誤差的上界 (k = sqrt(n) + 2個運算的相對誤差)
+                double mu = std::numeric_limits<double>::epsilon() / 2;
+                double k = std::sqrt(static_cast<double>(n)) + 2;
+                double gamma = k * mu / (1 - k * mu);
+
+                std::vector<unsigned int> remaining(n);
+                std::iota(remaining.begin(), remaining.end(), 0u);
+                std::vector<unsigned int> separable;
+                groups.clear();
+                while (!remaining.empty()){
+                    unsigned int i = remaining[0];
+                    int m = static_cast<int>(remaining.size()) - 1;
+                    std::vector<double> both(m);
+                    ForEachIndex(m, [&](int t){
+                        std::vector<double> x(base);
+                        x[i] = SampleUpper(i);
+                        x[remaining[t + 1]] = middle[remaining[t + 1]];
+                        both[t] = costFunction.EvaluateCostView(x);
+                    });
+                    numOfGroupingEvaluations += m;
+
+                    std::vector<unsigned int> group(1, i);
+                    std::vector<unsigned int> rest;
+                    double fi = single[1 + i];
+                    for (int t = 0; t < m; t++){
+                        unsigned int j = remaining[t + 1];
+                        double fj = single[1 + n + j];
+                        double delta = std::fabs((fi - f0) - (both[t] - fj));
+                        double threshold = config.interactionThreshold > 0 ? config.interactionThreshold :
+                            gamma * (std::fabs(f0) + std::fabs(fi) + std::fabs(fj) + std::fabs(both[t]));
+                        if (delta > threshold){
+                            group.push_back(j);
+                        }
+                        else{
+                            rest.push_back(j);
+                        }
+                    }
+                    if (group.size() == 1){
+                        separable.push_back(i);
+                    }
+                    else{
+                        groups.push_back(group);
+                    }
+                    remaining.swap(rest);
+                }
+                Split(separable);
+            }
+
+            void CreateOptimizers()
+            {
+                subproblems.clear();
+                optimizers.clear();
+                for (size_t g = 0; g < groups.size(); g++){
+                    subproblems.emplace_back(new CoevolutionSubproblem(costFunction, groups[g]));
+                    // 每個sub-optimizer的seed由(seed, cycle, group)決定
+                    StreamRandom rng(static_cast<uint64_t>(static_cast<int64_t>(randomSeed)), cycle, g);
+                    int seed = static_cast<int>(rng() >> 33);
+                    optimizers.emplace_back(new DifferentialEvolution(*subproblems[g], config.populationSize,
+                        config.F, config.CR, seed, config.shouldCheckConstraint));
+                }
+                started.assign(groups.size(), 0);
+                stale.assign(groups.size(), 0);
+            }
+
+        public:
+            /*
+                * INPUT:
+                    * costFunction: the full problem (not owned)
+                    * config: grouping and sub-optimizer settings
+                    * RandomSeed: seed of the context, the random grouping and the sub-optimizers
+            */
+            CooperativeCoevolution(
+                const Optimize& costFunction,
+                const CoevolutionConfig& config = CoevolutionConfig(),
+                int RandomSeed = 123
+            ):
+                costFunction(costFunction),
+                config(config),
+                numOfParameters(costFunction.numOfParameters()),
+                randomSeed(RandomSeed),
+                pool(nullptr),
+                contextCost(std::numeric_limits<double>::infinity()),
+                contextViolation(std::numeric_limits<double>::infinity()),
+                cycle(0),
+                numOfEvaluations(0),
+                numOfGroupingEvaluations(0)
+            {
+                generator.seed(RandomSeed);
+                constraints = costFunction.getConstraints();
+                nonlinearConstraints = costFunction.getNonlinearConstraints();
+            }
+
+            // Run the groups on a thread pool (not owned; nullptr: calling thread)
+            void SetThreadPool(ThreadPool* threadPool)
+            {
+                pool = threadPool;
+            }
+
+            // Random context vector, grouping (evaluations for Differential) and sub-optimizers
+            void InitializePopulation()
+            {
+                generator.seed(randomSeed);
+                cycle = 0;
+                numOfEvaluations = 0;
+                numOfGroupingEvaluations = 0;
+                context.resize(numOfParameters);
+                for (unsigned int i = 0; i < numOfParameters; i++){
+                    context[i] = std::uniform_real_distribution<double>(SampleLower(i), SampleUpper(i))(generator);
+                }
+
+                if (config.grouping == Grouping::Fixed){
+                    groups = config.groups;
+                    std::vector<char> seen(numOfParameters, 0);
+                    for (const auto& group : groups){
+                        assert(!group.empty() && "Empty group");
+                        for (unsigned int i : group){
+                            assert(i < numOfParameters && !seen[i] && "Every parameter must be in exactly one group");
+                            seen[i] = 1;
+                        }
+                    }
+                    assert(std::count(seen.begin(), seen.end(), 1) == static_cast<long>(numOfParameters) &&
+                           "Every parameter must be in exactly one group");
+                }
+                else if (config.grouping == Grouping::Random){
+                    RandomGroups();
+                }
+                else{
+                    DifferentialGroups();
+                }
+                numOfEvaluations = numOfGroupingEvaluations;
+                Evaluate(context, contextCost, contextViolation);
+                CreateOptimizers();
+            }
+
+            // One cycle: every group optimizes its parameters, then the context is updated
+            void Cycle()
+            {
+                if (config.grouping == Grouping::Random && config.regroup && cycle > 0){
+                    RandomGroups();
+                    CreateOptimizers();
+                }
+                cycle++;
+
+                int n = static_cast<int>(groups.size());
+                std::vector<std::vector<double>> best(n);
+                std::vector<double> bestCost(n);
+                std::vector<double> bestViolation(n);
+                std::vector<unsigned long long> used(n);
+                ForEachIndex(n, [&](int g){
+                    DifferentialEvolution& de = *optimizers[g];
+                    unsigned long long before = de.GetNumOfEvaluations();
+                    subproblems[g]->SetContext(context);
+                    if (!started[g]){
+                        de.InitializePopulation();
+                        started[g] = 1;
+                    }
+                    else if (stale[g]){
+                        de.ReevaluatePopulation();
+                    }
+                    stale[g] = 0;
+                    for (unsigned int t = 0; t < config.generationsPerCycle; t++){
+                        de.SelectAndCross();
+                    }
+                    best[g] = de.GetBestAgent();
+                    bestCost[g] = de.GetBestCost();
+                    bestViolation[g] = de.GetBestViolation();
+                    used[g] = de.GetNumOfEvaluations() - before;
+                });
+
+                // 依group順序合併改善context的sub-vectors
+                std::vector<int> improving;
+                for (int g = 0; g < n; g++){
+                    numOfEvaluations += used[g];
+                    if (Better(bestCost[g], bestViolation[g], contextCost, contextViolation)){
+                        improving.push_back(g);
+                    }
+                }
+                if (improving.empty()){
+                    return;
+                }
+                int winner = improving[0];
+                for (int g : improving){
+                    if (Better(bestCost[g], bestViolation[g], bestCost[winner], bestViolation[winner])){
+                        winner = g;
+                    }
+                }
+                std::vector<int> accepted(1, winner);
+                double cost = bestCost[winner];
+                double violation = bestViolation[winner];
+                if (improving.size() > 1){
+                    std::vector<double> merged(context);
+                    for (int g : improving){
+                        for (size_t t = 0; t < groups[g].size(); t++){
+                            merged[groups[g][t]] = best[g][t];
+                        }
+                    }
+                    double mergedCost, mergedViolation;
+                    Evaluate(merged, mergedCost, mergedViolation);
+                    if (!Better(cost, violation, mergedCost, mergedViolation)){
+                        accepted = improving;
+                        cost = mergedCost;
+                        violation = mergedViolation;
+                    }
+                }
+                for (int g : accepted){
+                    for (size_t t = 0; t < groups[g].size(); t++){
+                        context[groups[g][t]] = best[g][t];
+                    }
+                }
+                contextCost = cost;
+                contextViolation = violation;
+                // 其他group的parameters改變時 sub-population的cost失效
+                for (int h = 0; h < n; h++){
+                    stale[h] |= accepted.size() > 1 || accepted[0] != h;
+                }
+            }
+
+            void OptimizeStep(int cycles)
+            {
+                InitializePopulation();
+                for (int i = 0; i < cycles; i++){
+                    Cycle();
+                }
+            }
+
+            // * 回傳context vector (目前最好的解) 與它的cost和violation
+            const std::vector<double>& GetBestAgent() const
+            {
+                return context;
+            }
+
+            double GetBestCost() const
+            {
+                return contextCost;
+            }
+
+            double GetBestViolation() const
+            {
+                return contextViolation;
+            }
+
+            const std::vector<std::vector<unsigned int>>& GetGroups() const
+            {
+                return groups;
+            }
+
+            unsigned int GetCycle() const
+            {
+                return cycle;
+            }
+
+            // * 回傳evaluation次數 (包含grouping)
+            unsigned long long GetNumOfEvaluations() const
+            {
+                return numOfEvaluations;
+            }
+
+            unsigned long long GetNumOfGroupingEvaluations() const
+            {
+                return numOfGroupingEvaluations;
+            }
+    };
+}
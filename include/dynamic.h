@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cassert>
+
+
+
+namespace DE
+{
+    /* DynamicConfig: what is re-evaluated when the data behind the objective changes */
+    /*
+        * When Optimize::dataVersion() changes, every stored cost is stale.
+        * Only a prioritized part of the population is re-evaluated at once:
+        * the best eliteFraction (ranked by their old costs, at least one),
+        * a random sampleFraction of the others, and the worst
+        * immigrantFraction, which are replaced by new uniform samples to
+        * restore diversity. The remaining individuals are re-evaluated
+        * lazily when they next meet a trial, with the trial's cost as the
+        * bound of a bounded evaluation (an individual that is worse than
+        * its trial is replaced anyway and may be aborted early).
+    */
+    struct DynamicConfig
+    {
+        // 依舊的cost排序 最好的這個比例立即重新evaluation
+        double eliteFraction;
+        // 其他individuals中隨機抽樣的比例
+        double sampleFraction;
+        // 最差的這個比例換成新的隨機individuals
+        double immigrantFraction;
+
+        DynamicConfig(double eliteFraction = 0.1,
+                      double sampleFraction = 0.1,
+                      double immigrantFraction = 0.1) :
+            eliteFraction(eliteFraction),
+            sampleFraction(sampleFraction),
+            immigrantFraction(immigrantFraction)
+        {
+            assert(eliteFraction >= 0 && sampleFraction >= 0 && immigrantFraction >= 0);
+            assert(eliteFraction + sampleFraction + immigrantFraction <= 1.0 && "Fractions must not exceed the population");
+        }
+    };
+}
@@ -0,0 +1,928 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <map>
+#include <tuple>
+#include <cmath>
+#include <cstring>
+#include <cctype>
+#include <cstdlib>
+#include <cstdint>
+#include <stdexcept>
+#include <algorithm>
+
+#include "DE.h"
+
+
+
+namespace DE
+{
+    /* ExpressionNode: syntax tree of an objective expression */
+    /*
+        * Number:   value
+        * Variable: name (pi, e, n or the index of an enclosing sum/prod)
+        * Element:  x[children[0]]
+        * Call:     name(children...), operators are "+", "-", "*", "/", "^"
+        *           and "neg"
+        * Reduce:   name ("sum" or "prod") over variable from children[0] to
+        *           children[1] (inclusive) of children[2]
+        * The parser, the compiler and the destructor recurse over the tree, so
+        * a node deeper than maxDepth throws std::invalid_argument.
+    */
+    struct ExpressionNode
+    {
+        enum class Kind { Number, Variable, Element, Call, Reduce };
+
+        static const unsigned int maxDepth = 1000;
+
+        Kind kind = Kind::Number;
+        double value = 0.0;
+        std::string name;
+        std::string variable;
+        std::vector<ExpressionNode> children;
+        // 1 for a leaf
+        unsigned int depth = 1;
+
+        // depth from the children (after they are added)
+        void UpdateDepth()
+        {
+            depth = 1;
+            for (const ExpressionNode& child : children){
+                depth = std::max(depth, child.depth + 1);
+            }
+            if (depth > maxDepth){
+                throw std::invalid_argument("Expression: nested deeper than " + std::to_string(maxDepth) + " levels");
+            }
+        }
+
+        static ExpressionNode Number(double value)
+        {
+            ExpressionNode node;
+            node.value = value;
+            return node;
+        }
+
+        static ExpressionNode Variable(const std::string& name)
+        {
+            ExpressionNode node;
+            node.kind = Kind::Variable;
+            node.name = name;
+            return node;
+        }
+
+        static ExpressionNode Element(ExpressionNode index)
+        {
+            ExpressionNode node;
+            node.kind = Kind::Element;
+            node.children.push_back(std::move(index));
+            node.UpdateDepth();
+            return node;
+        }
+
+        static ExpressionNode Call(const std::string& name, std::vector<ExpressionNode> args)
+        {
+            ExpressionNode node;
+            node.kind = Kind::Call;
+            node.name = name;
+            node.children = std::move(args);
+            node.UpdateDepth();
+            return node;
+        }
+
+        static ExpressionNode Reduce(const std::string& name, const std::string& variable,
+                                     ExpressionNode first, ExpressionNode last, ExpressionNode body)
+        {
+            ExpressionNode node;
+            node.kind = Kind::Reduce;
+            node.name = name;
+            node.variable = variable;
+            node.children.push_back(std::move(first));
+            node.children.push_back(std::move(last));
+            node.children.push_back(std::move(body));
+            node.UpdateDepth();
+            return node;
+        }
+    };
+
+
+    /* ExpressionParser: text -> ExpressionNode */
+    /*
+        * expr    := term (('+' | '-') term)*
+        * term    := unary (('*' | '/') unary)*
+        * unary   := '-' unary | power
+        * power   := primary (('^' | '**') unary)?          (right associative)
+        * primary := number | x[expr] | name | name(args) | (expr)
+        *          | sum(i, first, last, expr) | prod(i, first, last, expr)
+    */
+    class ExpressionParser{
+        private:
+            std::string text;
+            size_t pos;
+            // 目前的遞迴深度 (括號不產生node 所以另外計算)
+            unsigned int nesting;
+
+            [[noreturn]] void Fail(const std::string& message) const
+            {
+                throw std::invalid_argument("Expression: " + message + " at position " + std::to_string(pos) +
+                                            " in \"" + text + "\"");
+            }
+
+            void Skip()
+            {
+                while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))){
+                    pos++;
+                }
+            }
+
+            bool Accept(const char* token)
+            {
+                Skip();
+                size_t n = std::strlen(token);
+                if (text.compare(pos, n, token) == 0){
+                    pos += n;
+                    return true;
+                }
+                return false;
+            }
+
+            void Expect(const char* token)
+            {
+                if (!Accept(token)){
+                    Fail(std::string("expected '") + token + "'");
+                }
+            }
+
+            std::string Name()
+            {
+                Skip();
+                size_t start = pos;
+                while (pos < text.size() && (std::isalnum(static_cast<unsigned char>(text[pos])) || text[pos] == '_')){
+                    pos++;
+                }
+                if (start == pos || std::isdigit(static_cast<unsigned char>(text[start]))){
+                    pos = start;
+                    Fail("expected a name");
+                }
+                return text.substr(start, pos - start);
+            }
+
+            ExpressionNode Expr()
+            {
+                ExpressionNode left = Term();
+                while (true){
+                    if (Accept("+")){
+                        left = ExpressionNode::Call("+", {std::move(left), Term()});
+                    }
+                    else if (Accept("-")){
+                        left = ExpressionNode::Call("-", {std::move(left), Term()});
+                    }
+                    else{
+                        return left;
+                    }
+                }
+            }
+
+            ExpressionNode Term()
+            {
+                ExpressionNode left = Unary();
+                while (true){
+                    Skip();
+                    if (text.compare(pos, 2, "**") != 0 && Accept("*")){
+                        left = ExpressionNode::Call("*", {std::move(left), Unary()});
+                    }
+                    else if (Accept("/")){
+                        left = ExpressionNode::Call("/", {std::move(left), Unary()});
+                    }
+                    else{
+                        return left;
+                    }
+                }
+            }
+
+            // every recursion of the grammar passes here
+            ExpressionNode Unary()
+            {
+                if (++nesting > ExpressionNode::maxDepth){
+                    Fail("nested deeper than " + std::to_string(ExpressionNode::maxDepth) + " levels");
+                }
+                ExpressionNode node;
+                if (Accept("-")){
+                    node = ExpressionNode::Call("neg", {Unary()});
+                }
+                else if (Accept("+")){
+                    node = Unary();
+                }
+                else{
+                    node = Power();
+                }
+                nesting--;
+                return node;
+            }
+
+            ExpressionNode Power()
+            {
+                ExpressionNode base = Primary();
+                if (Accept("^") || Accept("**")){
+                    return ExpressionNode::Call("^", {std::move(base), Unary()});
+                }
+                return base;
+            }
+
+            ExpressionNode Primary()
+            {
+                Skip();
+                if (pos >= text.size()){
+                    Fail("unexpected end");
+                }
+                char c = text[pos];
+                if (std::isdigit(static_cast<unsigned char>(c)) || c == '.'){
+                    const char* begin = text.c_str() + pos;
+                    char* end = nullptr;
+                    double value = std::strtod(begin, &end);
+                    if (end == begin){
+                        Fail("bad number");
+                    }
+                    pos += end - begin;
+                    return ExpressionNode::Number(value);
+                }
+                if (Accept("(")){
+                    ExpressionNode inner = Expr();
+                    Expect(")");
+                    return inner;
+                }
+                std::string name = Name();
+                if (name == "x"){
+                    Expect("[");
+                    ExpressionNode index = Expr();
+                    Expect("]");
+                    return ExpressionNode::Element(std::move(index));
+                }
+                if (!Accept("(")){
+                    return ExpressionNode::Variable(name);
+                }
+                if (name == "sum" || name == "prod"){
+                    std::string variable = Name();
+                    Expect(",");
+                    ExpressionNode first = Expr();
+                    Expect(",");
+                    ExpressionNode last = Expr();
+                    Expect(",");
+                    ExpressionNode body = Expr();
+                    Expect(")");
+                    return ExpressionNode::Reduce(name, variable, std::move(first), std::move(last), std::move(body));
+                }
+                std::vector<ExpressionNode> args;
+                if (!Accept(")")){
+                    do{
+                        args.push_back(Expr());
+                    } while (Accept(","));
+                    Expect(")");
+                }
+                return ExpressionNode::Call(name, std::move(args));
+            }
+
+        public:
+            static ExpressionNode Parse(const std::string& text)
+            {
+                ExpressionParser parser;
+                parser.text = text;
+                parser.pos = 0;
+                parser.nesting = 0;
+                ExpressionNode root = parser.Expr();
+                parser.Skip();
+                if (parser.pos != text.size()){
+                    parser.Fail("unexpected '" + text.substr(parser.pos, 1) + "'");
+                }
+                return root;
+            }
+    };
+
+
+    // Instructions of a compiled expression (C: the instruction's constant)
+    enum class ExpressionOp : uint8_t {
+        Const,
+        Add, Sub, Mul, Div, Pow, Min, Max,
+        AddC, MulC, CSub, CDiv, PowC, CPow, MinC, MaxC,
+        Neg, Square, Sqrt, Abs, Exp, Log, Log10, Sin, Cos, Tan,
+        Asin, Acos, Atan, Sinh, Cosh, Tanh, Floor, Ceil
+    };
+
+    struct ExpressionInstruction
+    {
+        ExpressionOp op;
+        // destination and operand registers (x[k] is register k)
+        uint32_t dst;
+        uint32_t a;
+        uint32_t b;
+        double c;
+    };
+
+
+    /* CompiledExpression: register bytecode of an expression for a fixed dimension */
+    /*
+        * sum/prod are unrolled (the dimension is known), constants are
+        * folded and equal subexpressions are computed once (x[i]^2 appearing
+        * twice is squared once). Registers 0..n-1 hold x, the others are
+        * reused after their last use.
+        * Evaluate() interprets the code for one agent; EvaluateBlock() runs
+        * every instruction over up to blockSize agents at once, so the
+        * dispatch is paid once per block and the arithmetic loops vectorize.
+    */
+    class CompiledExpression{
+        public:
+            static const size_t blockSize = 32;
+
+            // Terms all sum/prod loops of one expression may unroll together
+            static long long UnrollLimit(unsigned int dimension)
+            {
+                return std::max(65536LL, 256LL * dimension);
+            }
+
+        private:
+            unsigned int dim;
+            std::vector<ExpressionInstruction> code;
+            uint32_t numOfRegisters;
+            uint32_t result;
+
+            // Compilation state
+            struct Value
+            {
+                bool constant;
+                double c;
+                uint32_t reg;
+            };
+            std::map<std::string, double> scope;
+            std::map<std::tuple<int, uint32_t, uint32_t, uint64_t>, uint32_t> emitted;
+            uint32_t numOfValues;
+            // sum/prod的迴圈會展開: 所有迴圈合計最多展開的次數
+            long long unrollBudget;
+
+            static Value Constant(double c)
+            {
+                return Value{true, c, 0};
+            }
+
+            static Value Register(uint32_t reg)
+            {
+                return Value{false, 0.0, reg};
+            }
+
+            static double Apply(ExpressionOp op, double a, double b, double c)
+            {
+                switch (op){
+                    case ExpressionOp::Const: return c;
+                    case ExpressionOp::Add: return a + b;
+                    case ExpressionOp::Sub: return a - b;
+                    case ExpressionOp::Mul: return a * b;
+                    case ExpressionOp::Div: return a / b;
+                    case ExpressionOp::Pow: return std::pow(a, b);
+                    case ExpressionOp::Min: return std::min(a, b);
+                    case ExpressionOp::Max: return std::max(a, b);
+                    case ExpressionOp::AddC: return a + c;
+                    case ExpressionOp::MulC: return a * c;
+                    case ExpressionOp::CSub: return c - a;
+                    case ExpressionOp::CDiv: return c / a;
+                    case ExpressionOp::PowC: return std::pow(a, c);
+                    case ExpressionOp::CPow: return std::pow(c, a);
+                    case ExpressionOp::MinC: return std::min(a, c);
+                    case ExpressionOp::MaxC: return std::max(a, c);
+                    case ExpressionOp::Neg: return -a;
+                    case ExpressionOp::Square: return a * a;
+                    case ExpressionOp::Sqrt: return std::sqrt(a);
+                    case ExpressionOp::Abs: return std::abs(a);
+                    case ExpressionOp::Exp: return std::exp(a);
+                    case ExpressionOp::Log: return std::log(a);
+                    case ExpressionOp::Log10: return std::log10(a);
+                    case ExpressionOp::Sin: return std::sin(a);
+                    case ExpressionOp::Cos: return std::cos(a);
+                    case ExpressionOp::Tan: return std::tan(a);
+                    case ExpressionOp::Asin: return std::asin(a);
+                    case ExpressionOp::Acos: return std::acos(a);
+                    case ExpressionOp::Atan: return std::atan(a);
+                    case ExpressionOp::Sinh: return std::sinh(a);
+                    case ExpressionOp::Cosh: return std::cosh(a);
+                    case ExpressionOp::Tanh: return std::tanh(a);
+                    case ExpressionOp::Floor: return std::floor(a);
+                    case ExpressionOp::Ceil: return std::ceil(a);
+                }
+                return 0.0;
+            }
+
+            static bool Commutative(ExpressionOp op)
+            {
+                return op == ExpressionOp::Add || op == ExpressionOp::Mul ||
+                       op == ExpressionOp::Min || op == ExpressionOp::Max;
+            }
+
+            // 相同的(op, operands, constant)只產生一次
+            uint32_t Emit(ExpressionOp op, uint32_t a, uint32_t b, double c)
+            {
+                if (Commutative(op) && b < a){
+                    std::swap(a, b);
+                }
+                uint64_t bits;
+                std::memcpy(&bits, &c, sizeof(bits));
+                auto key = std::make_tuple(static_cast<int>(op), a, b, bits);
+                auto found = emitted.find(key);
+                if (found != emitted.end()){
+                    return found->second;
+                }
+                uint32_t dst = numOfValues++;
+                code.push_back(ExpressionInstruction{op, dst, a, b, c});
+                emitted[key] = dst;
+                return dst;
+            }
+
+            Value Unary(ExpressionOp op, Value a)
+            {
+                if (a.constant){
+                    return Constant(Apply(op, a.c, 0.0, 0.0));
+                }
+                return Register(Emit(op, a.reg, 0, 0.0));
+            }
+
+            // 二元運算: 常數折疊與簡化
+            Value Binary(ExpressionOp op, Value a, Value b)
+            {
+                if (a.constant && b.constant){
+                    return Constant(Apply(op, a.c, b.c, 0.0));
+                }
+                if (!a.constant && !b.constant){
+                    if (op == ExpressionOp::Mul && a.reg == b.reg){
+                        return Register(Emit(ExpressionOp::Square, a.reg, 0, 0.0));
+                    }
+                    return Register(Emit(op, a.reg, b.reg, 0.0));
+                }
+                // 一邊是常數
+                switch (op){
+                    case ExpressionOp::Add:
+                    {
+                        Value r = a.constant ? b : a;
+                        double c = a.constant ? a.c : b.c;
+                        return c == 0.0 ? r : Register(Emit(ExpressionOp::AddC, r.reg, 0, c));
+                    }
+                    case ExpressionOp::Sub:
+                        if (b.constant){
+                            return b.c == 0.0 ? a : Register(Emit(ExpressionOp::AddC, a.reg, 0, -b.c));
+                        }
+                        return Register(Emit(ExpressionOp::CSub, b.reg, 0, a.c));
+                    case ExpressionOp::Mul:
+                    {
+                        Value r = a.constant ? b : a;
+                        double c = a.constant ? a.c : b.c;
+                        if (c == 1.0){
+                            return r;
+                        }
+                        if (c == -1.0){
+                            return Register(Emit(ExpressionOp::Neg, r.reg, 0, 0.0));
+                        }
+                        return Register(Emit(ExpressionOp::MulC, r.reg, 0, c));
+                    }
+                    case ExpressionOp::Div:
+                        if (b.constant){
+                            return b.c == 1.0 ? a : Register(Emit(ExpressionOp::MulC, a.reg, 0, 1.0 / b.c));
+                        }
+                        return Register(Emit(ExpressionOp::CDiv, b.reg, 0, a.c));
+                    case ExpressionOp::Pow:
+                        if (b.constant){
+                            return PowConstant(a, b.c);
+                        }
+                        return Register(Emit(ExpressionOp::CPow, b.reg, 0, a.c));
+                    case ExpressionOp::Min:
+                        return Register(Emit(ExpressionOp::MinC, (a.constant ? b : a).reg, 0, a.constant ? a.c : b.c));
+                    case ExpressionOp::Max:
+                        return Register(Emit(ExpressionOp::MaxC, (a.constant ? b : a).reg, 0, a.constant ? a.c : b.c));
+                    default:
+                        break;
+                }
+                return Value();
+            }
+
+            // 小的整數次方展開成乘法
+            Value PowConstant(Value a, double p)
+            {
+                if (p == 1.0){
+                    return a;
+                }
+                if (p == 0.5){
+                    return Unary(ExpressionOp::Sqrt, a);
+                }
+                if (p == std::floor(p) && p >= 2 && p <= 8){
+                    Value square = Register(Emit(ExpressionOp::Square, a.reg, 0, 0.0));
+                    int n = static_cast<int>(p);
+                    Value result = square;
+                    for (int k = 2; k + 2 <= n; k += 2){
+                        result = Binary(ExpressionOp::Mul, result, square);
+                    }
+                    if (n % 2){
+                        result = Binary(ExpressionOp::Mul, result, a);
+                    }
+                    return result;
+                }
+                return Register(Emit(ExpressionOp::PowC, a.reg, 0, p));
+            }
+
+            // 在編譯時必須是常數的整數 (x的index與sum/prod的範圍)
+            long long Integer(const ExpressionNode& node, const char* what)
+            {
+                Value v = Generate(node);
+                if (!v.constant){
+                    throw std::invalid_argument(std::string("Expression: ") + what + " must not depend on x");
+                }
+                if (v.c != std::floor(v.c)){
+                    throw std::invalid_argument(std::string("Expression: ") + what + " must be an integer");
+                }
+                // 超出long long的轉換是undefined behavior (inf與nan也是)
+                if (!std::isfinite(v.c) || v.c < -0x1p63 || v.c >= 0x1p63){
+                    throw std::invalid_argument(std::string("Expression: ") + what + " is out of range");
+                }
+                return static_cast<long long>(v.c);
+            }
+
+            Value Generate(const ExpressionNode& node)
+            {
+                switch (node.kind){
+                    case ExpressionNode::Kind::Number:
+                        return Constant(node.value);
+                    case ExpressionNode::Kind::Variable:
+                    {
+                        auto found = scope.find(node.name);
+                        if (found == scope.end()){
+                            throw std::invalid_argument("Expression: unknown name \"" + node.name + "\"");
+                        }
+                        return Constant(found->second);
+                    }
+                    case ExpressionNode::Kind::Element:
+                    {
+                        long long index = Integer(node.children.at(0), "the index of x");
+                        if (index < 0 || index >= dim){
+                            throw std::invalid_argument("Expression: x[" + std::to_string(index) +
+                                                        "] is out of range for dimension " + std::to_string(dim));
+                        }
+                        return Register(static_cast<uint32_t>(index));
+                    }
+                    case ExpressionNode::Kind::Reduce:
+                    {
+                        long long first = Integer(node.children.at(0), "the range of sum/prod");
+                        long long last = Integer(node.children.at(1), "the range of sum/prod");
+                        bool sum = node.name == "sum";
+                        if (!sum && node.name != "prod"){
+                            throw std::invalid_argument("Expression: unknown reduction \"" + node.name + "\"");
+                        }
+                        if (last >= first){
+                            // double: last - first may overflow
+                            double count = static_cast<double>(last) - static_cast<double>(first) + 1;
+                            if (count > static_cast<double>(unrollBudget)){
+                                throw std::invalid_argument("Expression: " + node.name + " over " + std::to_string(first) +
+                                                            ".." + std::to_string(last) + " unrolls more than " +
+                                                            std::to_string(UnrollLimit(dim)) + " terms in total");
+                            }
+                            unrollBudget -= static_cast<long long>(count);
+                        }
+                        // 外層同名的變數在迴圈結束後恢復
+                        auto saved = scope.find(node.variable);
+                        bool shadowed = saved != scope.end();
+                        double previous = shadowed ? saved->second : 0.0;
+                        Value total = Constant(sum ? 0.0 : 1.0);
+                        for (long long i = first; i <= last; i++){
+                            scope[node.variable] = static_cast<double>(i);
+                            total = Binary(sum ? ExpressionOp::Add : ExpressionOp::Mul, total, Generate(node.children.at(2)));
+                        }
+                        if (shadowed){
+                            scope[node.variable] = previous;
+                        }
+                        else{
+                            scope.erase(node.variable);
+                        }
+                        return total;
+                    }
+                    case ExpressionNode::Kind::Call:
+                        return Call(node);
+                }
+                return Value();
+            }
+
+            Value Call(const ExpressionNode& node)
+            {
+                static const std::map<std::string, ExpressionOp> binary = {
+                    {"+", ExpressionOp::Add}, {"-", ExpressionOp::Sub}, {"*", ExpressionOp::Mul},
+                    {"/", ExpressionOp::Div}, {"^", ExpressionOp::Pow}, {"pow", ExpressionOp::Pow},
+                    {"min", ExpressionOp::Min}, {"max", ExpressionOp::Max}
+                };
+                static const std::map<std::string, ExpressionOp> unary = {
+                    {"neg", ExpressionOp::Neg}, {"sqrt", ExpressionOp::Sqrt}, {"abs", ExpressionOp::Abs},
+                    {"exp", ExpressionOp::Exp}, {"log", ExpressionOp::Log}, {"log10", ExpressionOp::Log10},
+                    {"sin", ExpressionOp::Sin}, {"cos", ExpressionOp::Cos}, {"tan", ExpressionOp::Tan},
+                    {"asin", ExpressionOp::Asin}, {"acos", ExpressionOp::Acos}, {"atan", ExpressionOp::Atan},
+                    {"sinh", ExpressionOp::Sinh}, {"cosh", ExpressionOp::Cosh}, {"tanh", ExpressionOp::Tanh},
+                    {"floor", ExpressionOp::Floor}, {"ceil", ExpressionOp::Ceil}
+                };
+                auto b = binary.find(node.name);
+                if (b != binary.end()){
+                    if (node.children.size() != 2){
+                        throw std::invalid_argument("Expression: " + node.name + " takes 2 arguments");
+                    }
+                    Value left = Generate(node.children[0]);
+                    return Binary(b->second, left, Generate(node.children[1]));
+                }
+                auto u = unary.find(node.name);
+                if (u != unary.end()){
+                    if (node.children.size() != 1){
+                        throw std::invalid_argument("Expression: " + node.name + " takes 1 argument");
+                    }
+                    if (u->second == ExpressionOp::Neg){
+                        Value a = Generate(node.children[0]);
+                        return a.constant ? Constant(-a.c) : Register(Emit(ExpressionOp::Neg, a.reg, 0, 0.0));
+                    }
+                    return Unary(u->second, Generate(node.children[0]));
+                }
+                throw std::invalid_argument("Expression: unknown function \"" + node.name + "\"");
+            }
+
+            static bool HasOperandB(ExpressionOp op)
+            {
+                return op >= ExpressionOp::Add && op <= ExpressionOp::Max;
+            }
+
+            static bool HasOperandA(ExpressionOp op)
+            {
+                return op != ExpressionOp::Const;
+            }
+
+            // 每個值在最後一次使用後釋放register (x[k]固定在register k)
+            void AllocateRegisters()
+            {
+                std::vector<size_t> lastUse(numOfValues, 0);
+                for (size_t t = 0; t < code.size(); t++){
+                    if (HasOperandA(code[t].op)){
+                        lastUse[code[t].a] = t;
+                    }
+                    if (HasOperandB(code[t].op)){
+                        lastUse[code[t].b] = t;
+                    }
+                }
+                lastUse[result] = code.size();
+                std::vector<uint32_t> physical(numOfValues, 0);
+                for (uint32_t k = 0; k < dim; k++){
+                    physical[k] = k;
+                    lastUse[k] = code.size();
+                }
+                std::vector<uint32_t> free;
+                numOfRegisters = dim;
+                for (size_t t = 0; t < code.size(); t++){
+                    ExpressionInstruction& in = code[t];
+                    uint32_t va = in.a, vb = in.b;
+                    if (HasOperandA(in.op)){
+                        in.a = physical[va];
+                        if (lastUse[va] == t){
+                            free.push_back(in.a);
+                        }
+                    }
+                    // a與b相同時只釋放一次
+                    if (HasOperandB(in.op)){
+                        in.b = physical[vb];
+                        if (lastUse[vb] == t && vb != va){
+                            free.push_back(in.b);
+                        }
+                    }
+                    uint32_t reg;
+                    if (!free.empty()){
+                        reg = free.back();
+                        free.pop_back();
+                    }
+                    else{
+                        reg = numOfRegisters++;
+                    }
+                    physical[in.dst] = reg;
+                    in.dst = reg;
+                }
+                result = physical[result];
+            }
+
+            template <class F>
+            static void Lanes(double* d, const double* a, size_t m, F f)
+            {
+                for (size_t l = 0; l < m; l++){
+                    d[l] = f(a[l]);
+                }
+            }
+
+            template <class F>
+            static void Lanes(double* d, const double* a, const double* b, size_t m, F f)
+            {
+                for (size_t l = 0; l < m; l++){
+                    d[l] = f(a[l], b[l]);
+                }
+            }
+
+        public:
+            CompiledExpression() : dim(0), numOfRegisters(0), result(0), numOfValues(0), unrollBudget(0) {}
+
+            CompiledExpression(const ExpressionNode& root, unsigned int dimension) :
+                dim(dimension), numOfRegisters(0), result(0), numOfValues(dimension),
+                unrollBudget(UnrollLimit(dimension))
+            {
+                scope["pi"] = M_PI;
+                scope["e"] = M_E;
+                scope["n"] = dimension;
+                Value v = Generate(root);
+                result = v.constant ? Emit(ExpressionOp::Const, 0, 0, v.c) : v.reg;
+                AllocateRegisters();
+                scope.clear();
+                emitted.clear();
+            }
+
+            // cost of one agent
+            double Evaluate(const double* x) const
+            {
+                static thread_local std::vector<double> buffer;
+                if (buffer.size() < numOfRegisters){
+                    buffer.resize(numOfRegisters);
+                }
+                double* r = buffer.data();
+                std::copy(x, x + dim, r);
+                for (const ExpressionInstruction& in : code){
+                    switch (in.op){
+                        case ExpressionOp::Const: r[in.dst] = in.c; break;
+                        case ExpressionOp::Add: r[in.dst] = r[in.a] + r[in.b]; break;
+                        case ExpressionOp::Sub: r[in.dst] = r[in.a] - r[in.b]; break;
+                        case ExpressionOp::Mul: r[in.dst] = r[in.a] * r[in.b]; break;
+                        case ExpressionOp::AddC: r[in.dst] = r[in.a] + in.c; break;
+                        case ExpressionOp::MulC: r[in.dst] = r[in.a] * in.c; break;
+                        case ExpressionOp::Square: r[in.dst] = r[in.a] * r[in.a]; break;
+                        default: r[in.dst] = Apply(in.op, r[in.a], r[in.b], in.c); break;
+                    }
+                }
+                return r[result];
+            }
+
+            // costs of agents[0..m) (m <= blockSize), each instruction over all of them
+            void EvaluateBlock(const double* const* agents, size_t m, double* costs) const
+            {
+                static thread_local std::vector<double> buffer;
+                if (buffer.size() < numOfRegisters * blockSize){
+                    buffer.resize(numOfRegisters * blockSize);
+                }
+                auto R = [&](uint32_t reg){ return buffer.data() + reg * blockSize; };
+                for (size_t l = 0; l < m; l++){
+                    for (unsigned int k = 0; k < dim; k++){
+                        R(k)[l] = agents[l][k];
+                    }
+                }
+                for (const ExpressionInstruction& in : code){
+                    double* d = R(in.dst);
+                    const double* a = R(in.a);
+                    const double* b = R(in.b);
+                    double c = in.c;
+                    switch (in.op){
+                        case ExpressionOp::Const: std::fill(d, d + m, c); break;
+                        case ExpressionOp::Add: Lanes(d, a, b, m, [](double u, double v){ return u + v; }); break;
+                        case ExpressionOp::Sub: Lanes(d, a, b, m, [](double u, double v){ return u - v; }); break;
+                        case ExpressionOp::Mul: Lanes(d, a, b, m, [](double u, double v){ return u * v; }); break;
+                        case ExpressionOp::Div: Lanes(d, a, b, m, [](double u, double v){ return u / v; }); break;
+                        case ExpressionOp::AddC: Lanes(d, a, m, [c](double u){ return u + c; }); break;
+                        case ExpressionOp::MulC: Lanes(d, a, m, [c](double u){ return u * c; }); break;
+                        case ExpressionOp::CSub: Lanes(d, a, m, [c](double u){ return c - u; }); break;
+                        case ExpressionOp::CDiv: Lanes(d, a, m, [c](double u){ return c / u; }); break;
+                        case ExpressionOp::Neg: Lanes(d, a, m, [](double u){ return -u; }); break;
+                        case ExpressionOp::Square: Lanes(d, a, m, [](double u){ return u * u; }); break;
+                        case ExpressionOp::Sqrt: Lanes(d, a, m, [](double u){ return std::sqrt(u); }); break;
+                        case ExpressionOp::Abs: Lanes(d, a, m, [](double u){ return std::abs(u); }); break;
+                        case ExpressionOp::Cos: Lanes(d, a, m, [](double u){ return std::cos(u); }); break;
+                        case ExpressionOp::Sin: Lanes(d, a, m, [](double u){ return std::sin(u); }); break;
+                        case ExpressionOp::Exp: Lanes(d, a, m, [](double u){ return std::exp(u); }); break;
+                        default:
+                        {
+                            ExpressionOp op = in.op;
+                            if (HasOperandB(op)){
+                                Lanes(d, a, b, m, [op](double u, double v){ return Apply(op, u, v, 0.0); });
+                            }
+                            else{
+                                Lanes(d, a, m, [op, c](double u){ return Apply(op, u, 0.0, c); });
+                            }
+                        }
+                    }
+                }
+                std::copy(R(result), R(result) + m, costs);
+            }
+
+            // costs of rows agents stored row-major in x
+            void EvaluateRows(const double* x, size_t rows, double* costs) const
+            {
+                const double* agents[blockSize];
+                for (size_t first = 0; first < rows; first += blockSize){
+                    size_t m = std::min(blockSize, rows - first);
+                    for (size_t l = 0; l < m; l++){
+                        agents[l] = x + (first + l) * dim;
+                    }
+                    EvaluateBlock(agents, m, costs + first);
+                }
+            }
+
+            size_t numOfInstructions() const
+            {
+                return code.size();
+            }
+
+            unsigned int numOfRegistersUsed() const
+            {
+                return numOfRegisters;
+            }
+    };
+
+
+    /* ExpressionObjective: a closed-form objective compiled from an expression */
+    /*
+        * e.g. "10*n + sum(i, 0, n-1, x[i]^2 - 10*cos(2*pi*x[i]))" (Rastrigin).
+        * Names: x[k] (0-based, k must not depend on x), n (dimension), pi,
+        * e, the index of an enclosing sum/prod; functions: sqrt abs exp log
+        * log10 sin cos tan asin acos atan sinh cosh tanh floor ceil pow min
+        * max. Evaluation runs natively and never calls back into Python.
+    */
+    class ExpressionObjective : public Optimize
+    {
+        private:
+            std::string text;
+            unsigned int dim;
+            double lower;
+            double upper;
+            CompiledExpression program;
+
+        public:
+            ExpressionObjective(const std::string& expression, unsigned int dimension,
+                                double lower_bound, double upper_bound) :
+                ExpressionObjective(ExpressionParser::Parse(expression), dimension, lower_bound, upper_bound)
+            {
+                text = expression;
+            }
+
+            ExpressionObjective(const ExpressionNode& root, unsigned int dimension,
+                                double lower_bound, double upper_bound) :
+                dim(dimension),
+                lower(lower_bound),
+                upper(upper_bound),
+                program(root, dimension)
+            {
+                assert(dimension > 0 && "Dimension must be greater than 0");
+                assert(lower_bound < upper_bound && "Lower bound must be less than upper bound");
+            }
+
+            double EvaluateCost(std::vector<double> input) const override
+            {
+                return EvaluateCostView(input);
+            }
+
+            double EvaluateCostView(VectorView input) const override
+            {
+                assert(input.size() == dim);
+                return program.Evaluate(input.data());
+            }
+
+            unsigned int numOfParameters() const override
+            {
+                return dim;
+            }
+
+            std::vector<Constraint> getConstraints() const override
+            {
+                return std::vector<Constraint>(dim, Constraint(lower, upper, true));
+            }
+
+            const CompiledExpression& Program() const
+            {
+                return program;
+            }
+
+            const std::string& Text() const
+            {
+                return text;
+            }
+    };
+
+
+    // Evaluate batches with the blocked interpreter (one dispatch per instruction per 64 agents)
+    class ExpressionEvaluator : public Evaluator
+    {
+        private:
+            const ExpressionObjective& objective;
+
+        public:
+            ExpressionEvaluator(const ExpressionObjective& objective) : objective(objective) {}
+
+            void EvaluateBatch(const std::vector<std::vector<double>>& agents, std::vector<double>& costs) override
+            {
+                const size_t blockSize = CompiledExpression::blockSize;
+                costs.resize(agents.size());
+                const double* rows[blockSize];
+                for (size_t first = 0; first < agents.size(); first += blockSize){
+                    size_t m = std::min(blockSize, agents.size() - first);
+                    for (size_t l = 0; l < m; l++){
+                        assert(agents[first + l].size() == objective.numOfParameters());
+                        rows[l] = agents[first + l].data();
+                    }
+                    objective.Program().EvaluateBlock(rows, m, costs.data() + first);
+                }
+            }
+    };
+}
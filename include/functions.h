@@ -2,6 +2,10 @@
 
 #include <vector>
 #include <cassert>
+#include <type_traits>
+#include <utility>
+#include <limits>
+#include <atomic>
 #include "DE.h"
 
 #include <cmath> // Include cmath for cos function
@@ -15,8 +19,14 @@ namespace DE
         private:
             unsigned int dim;
             std::function<double(const std::vector<double>&)> userFunction; 
+            // zero-copy version of the user function: (pointer, length)
+            std::function<double(const double*, unsigned int)> viewFunction;
             const double lower;
             const double upper;
+            // nonlinear constraints added by AddConstraint
+            std::vector<NonlinearConstraint> nonlinear;
+            // 每次UpdateData加1 (可能在optimizer執行時由其他thread呼叫)
+            std::atomic<unsigned long long> version{0};
 
         public:
             // Constructor accepts a std::function
@@ -36,13 +46,57 @@ namespace DE
                 assert (func != nullptr), "Function must be defined";
             }
 
+            // Constructor accepts a function reading the agent in place (no copy per evaluation)
+            customFunction(
+                unsigned int dimension, 
+                std::function<double(const double*, unsigned int)> func,
+                const double lower_bound, 
+                const double upper_bound
+            ) : 
+            dim(dimension), 
+            viewFunction(func) ,
+            lower(lower_bound),
+            upper(upper_bound)
+            {
+                assert(dimension > 0 && "Dimension must be greater than 0");
+                assert(lower_bound < upper_bound && "Lower bound must be less than upper bound");
+                assert(func != nullptr && "Function must be defined");
+            }
+
+            // std::atomic is not copyable: the copy starts at the current data version
+            customFunction(const customFunction& other) :
+            Optimize(other),
+            dim(other.dim),
+            userFunction(other.userFunction),
+            viewFunction(other.viewFunction),
+            lower(other.lower),
+            upper(other.upper),
+            nonlinear(other.nonlinear),
+            version(other.version.load())
+            {
+            }
+
             // Evaluate the cost function
             double EvaluateCost(std::vector<double> input) const override
             {
                 assert(input.size() == dim);
+                if (viewFunction){
+                    return viewFunction(input.data(), dim);
+                }
                 return userFunction(input);
             }
 
+            // Evaluate the cost function without copying the agent
+            double EvaluateCostView(VectorView input) const override
+            {
+                assert(input.size() == dim);
+                if (viewFunction){
+                    return viewFunction(input.data(), dim);
+                }
+                // std::vector介面的user function只能複製一次
+                return userFunction(input.ToVector());
+            }
+
             // Return the number of parameters
             unsigned int numOfParameters() const override
             {
@@ -60,23 +114,156 @@ namespace DE
                 }
                 return C;
             }            
+
+            // Add an inequality or equality constraint evaluated separately from the cost
+            void AddConstraint(const NonlinearConstraint& constraint)
+            {
+                nonlinear.push_back(constraint);
+            }
+
+            // Return the nonlinear constraints
+            std::vector<NonlinearConstraint> getNonlinearConstraints() const override
+            {
+                return nonlinear;
+            }
+
+            // Signal that the data read by the user function has changed
+            void UpdateData()
+            {
+                version++;
+            }
+
+            unsigned long long dataVersion() const override
+            {
+                return version.load();
+            }
+    };
+
+
+    // Objective wrapping a lambda/functor by value (no std::function, no virtual hop)
+    /*
+        * Fn is called either as fn(VectorView) or as fn(const double*, unsigned int).
+        * A callable fn(VectorView, double threshold) implements bounded
+        * evaluation (see Optimize::EvaluateCostBounded); it receives +infinity
+        * when the exact cost is needed.
+        * The class is final, so BasicDifferentialEvolution<FunctionObjective<Fn>>
+        * calls Fn directly and the compiler can inline it into the evaluation
+        * loop. It is still an Optimize and works with the evaluators and MultiRun.
+        *
+        *   auto sphere = DE::MakeObjective(10, [](DE::VectorView x){
+        *       double s = 0; for (double v : x) s += v * v; return s; }, -5.0, 5.0);
+        *   DE::BasicDifferentialEvolution<decltype(sphere)> de(sphere, 50, 0.8, 0.9);
+    */
+    template <class Fn>
+    class FunctionObjective final : public Optimize
+    {
+        private:
+            unsigned int dim;
+            Fn function;
+            double lower;
+            double upper;
+            std::vector<NonlinearConstraint> nonlinear;
+
+        public:
+            FunctionObjective(unsigned int dimension, Fn func, double lower_bound, double upper_bound) :
+                dim(dimension),
+                function(std::move(func)),
+                lower(lower_bound),
+                upper(upper_bound)
+            {
+                assert(dimension > 0 && "Dimension must be greater than 0");
+                assert(lower_bound < upper_bound && "Lower bound must be less than upper bound");
+            }
+
+            double EvaluateCost(std::vector<double> input) const override
+            {
+                return EvaluateCostView(input);
+            }
+
+            double EvaluateCostView(VectorView input) const override
+            {
+                assert(input.size() == dim);
+                if constexpr (std::is_invocable_r_v<double, const Fn&, VectorView, double>){
+                    return function(input, std::numeric_limits<double>::infinity());
+                }
+                else if constexpr (std::is_invocable_r_v<double, const Fn&, VectorView>){
+                    return function(input);
+                }
+                else{
+                    static_assert(std::is_invocable_r_v<double, const Fn&, const double*, unsigned int>,
+                                  "Fn must be callable as fn(VectorView) or fn(const double*, unsigned int)");
+                    return function(input.data(), input.size());
+                }
+            }
+
+            double EvaluateCostBounded(VectorView input, double threshold) const override
+            {
+                if constexpr (std::is_invocable_r_v<double, const Fn&, VectorView, double>){
+                    assert(input.size() == dim);
+                    return function(input, threshold);
+                }
+                else{
+                    return EvaluateCostView(input);
+                }
+            }
+
+            unsigned int numOfParameters() const override
+            {
+                return dim;
+            }
+
+            std::vector<Constraint> getConstraints() const override
+            {
+                return std::vector<Constraint>(dim, Constraint(lower, upper, true));
+            }
+
+            void AddConstraint(const NonlinearConstraint& constraint)
+            {
+                nonlinear.push_back(constraint);
+            }
+
+            std::vector<NonlinearConstraint> getNonlinearConstraints() const override
+            {
+                return nonlinear;
+            }
     };
+
+    // 由lambda推導出FunctionObjective的型別
+    template <class Fn>
+    FunctionObjective<Fn> MakeObjective(unsigned int dimension, Fn func, double lower_bound, double upper_bound)
+    {
+        return FunctionObjective<Fn>(dimension, std::move(func), lower_bound, upper_bound);
+    }
     
 
-    // The function to be evaluated and optimized
-    class Func : public Optimize
+    // The function to be evaluated and optimized (fully separable: one term per parameter)
+    class Func : public SeparableOptimize
     {
         private:
             unsigned int dim;// dimension
             const double LOWER_BOUND = -100;
             const double UPPER_BOUND = 100;
 
+            // x^2 - 100*cos(x)^2 - 100*cos(x^2/30)
+            static double Term(double x)
+            {
+                return x * x
+                   - 100 * cos(x) * cos(x)
+                   - 100 * cos(x * x / 30);
+            }
+
         public:
             // Constructor
             Func(unsigned int dim=2) : dim(dim) {}
 
             // Evaluate the cost function: x^2 - 100*cos(x)^2 - 100*cos(x^2/30) + 1400
             double EvaluateCost(std::vector<double> input) const override // override the virtual function in Optimize
+            {
+                return EvaluateCostView(input);
+            }
+
+            // Zero-copy evaluation: reads the agent in place
+            double EvaluateCostView(VectorView input) const override
             {
 
                 // input [x1, x2, x3, ... , x_dim]
@@ -85,9 +272,36 @@ namespace DE
                 double val = 0;
                 // Function value
                 for (int i = 0; i < dim; i++){
-                    val += input[i] * input[i]
-                       - 100 * cos(input[i]) * cos(input[i])
-                       - 100 * cos(input[i] * input[i] / 30);
+                    val += Term(input[i]);
+                }
+                return val+1400;
+            }
+
+            // term t of the sum (parameter t only)
+            double EvaluateTerm(unsigned int t, VectorView input) const override
+            {
+                return Term(input[t]);
+            }
+
+            double ConstantTerm() const override
+            {
+                return 1400;
+            }
+
+            // Bounded evaluation: every term is >= -200 (x^2 >= 0, cos <= 1), so
+            // after term i the cost is at least val + 1400 - 200 * (remaining terms)
+            double EvaluateCostBounded(VectorView input, double threshold) const override
+            {
+                assert (input.size()==dim);
+
+                // 留一點空間給加總的捨入誤差 只有確定輸的時候才提早結束
+                double limit = threshold + 1e-9 * (1.0 + std::abs(threshold));
+                double val = 0;
+                for (int i = 0; i < dim; i++){
+                    val += Term(input[i]);
+                    if (val + 1400 - 200.0 * (dim - 1 - i) > limit){
+                        return std::numeric_limits<double>::infinity();
+                    }
                 }
                 return val+1400;
             }
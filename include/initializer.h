@@ -0,0 +1,276 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cassert>
+#include <random>
+#include <algorithm>
+
+
+
+namespace DE
+{
+    // How InitializePopulation samples the population
+    /*
+        * Uniform: independent uniform coordinates (the original behaviour).
+        * LatinHypercube: every dimension is split into populationSize strata
+        *   and each stratum holds exactly one individual.
+        * Sobol: scrambled Sobol low-discrepancy points.
+        * Opposition: uniform points plus their opposites (lower + upper - x);
+        *   all 2 * populationSize are evaluated and the best half is kept
+        *   (a point and its opposite may both be kept).
+    */
+    enum class Initialization { Uniform, LatinHypercube, Sobol, Opposition };
+
+
+    // n points of a Latin hypercube in [0, 1)^dim
+    template <class Rng>
+    std::vector<std::vector<double>> LatinHypercube(unsigned int n, unsigned int dim, Rng& rng)
+    {
+        std::vector<std::vector<double>> points(n, std::vector<double>(dim));
+        std::vector<unsigned int> strata(n);
+        std::uniform_real_distribution<double> dist(0, 1);
+        for (unsigned int i = 0; i < dim; i++){
+            for (unsigned int k = 0; k < n; k++){
+                strata[k] = k;
+            }
+            std::shuffle(strata.begin(), strata.end(), rng);
+            for (unsigned int k = 0; k < n; k++){
+                points[k][i] = (strata[k] + dist(rng)) / n;
+            }
+        }
+        return points;
+    }
+
+
+    /* SobolSequence: Sobol points in (0, 1)^dim, optionally scrambled */
+    /*
+        * Dimension j uses the j-th primitive polynomial over GF(2) (ordered
+        * by degree); the initial direction numbers of the first dimensions
+        * are those of Joe and Kuo, the others are random odd numbers from a
+        * fixed seed. Scrambling applies a random linear matrix scramble and a
+        * random digital shift to every dimension, which keeps the net
+        * properties of the sequence. Points are generated in blocks with the
+        * Gray-code update (one XOR per coordinate).
+    */
+    class SobolSequence{
+        private:
+            static constexpr unsigned int bits = 32;
+            unsigned int dim;
+            // direction numbers: dim * bits
+            std::vector<uint32_t> directions;
+            std::vector<uint32_t> state;
+            uint32_t index;
+
+            // carry-less multiplication modulo the polynomial p of degree s
+            static uint64_t MulMod(uint64_t a, uint64_t b, uint64_t p, unsigned int s)
+            {
+                uint64_t r = 0;
+                while (b){
+                    if (b & 1){
+                        r ^= a;
+                    }
+                    b >>= 1;
+                    a <<= 1;
+                    if (a >> s & 1){
+                        a ^= p;
+                    }
+                }
+                return r;
+            }
+
+            static uint64_t PowMod(uint64_t e, uint64_t p, unsigned int s)
+            {
+                uint64_t r = 1;
+                uint64_t x = s > 1 ? 2 : (2 ^ p);
+                while (e){
+                    if (e & 1){
+                        r = MulMod(r, x, p, s);
+                    }
+                    x = MulMod(x, x, p, s);
+                    e >>= 1;
+                }
+                return r;
+            }
+
+            // x has order 2^s - 1 modulo p
+            static bool Primitive(uint64_t p, unsigned int s)
+            {
+                uint64_t order = (uint64_t(1) << s) - 1;
+                if (PowMod(order, p, s) != 1){
+                    return false;
+                }
+                uint64_t n = order;
+                for (uint64_t q = 2; q * q <= n; q++){
+                    if (n % q == 0){
+                        if (PowMod(order / q, p, s) == 1){
+                            return false;
+                        }
+                        while (n % q == 0){
+                            n /= q;
+                        }
+                    }
+                }
+                return n == 1 || PowMod(order / n, p, s) != 1;
+            }
+
+            // (degree, inner coefficients a) of the first count primitive polynomials
+            static void Polynomials(unsigned int count, std::vector<unsigned int>& degree, std::vector<uint32_t>& inner)
+            {
+                for (unsigned int s = 1; degree.size() < count; s++){
+                    assert(s < bits && "Too many dimensions for 32-bit Sobol points");
+                    for (uint32_t a = 0; a < (uint32_t(1) << (s - 1)) && degree.size() < count; a++){
+                        uint64_t p = (uint64_t(1) << s) | (uint64_t(a) << 1) | 1;
+                        if (Primitive(p, s)){
+                            degree.push_back(s);
+                            inner.push_back(a);
+                        }
+                    }
+                }
+            }
+
+        public:
+            /*
+                * INPUT:
+                    * dim: number of dimensions
+                    * rng: random engine used to scramble (nullptr: plain Sobol points)
+            */
+            template <class Rng>
+            SobolSequence(unsigned int dim, Rng* rng) :
+                dim(dim),
+                directions(static_cast<size_t>(dim) * bits),
+                state(dim, 0),
+                index(0)
+            {
+                // Joe-Kuo initial direction numbers m_1..m_s of dimensions 2..13
+                static const std::vector<std::vector<uint32_t>> initial = {
+                    {1}, {1, 3}, {1, 3, 1}, {1, 1, 1}, {1, 1, 3, 3}, {1, 3, 5, 13},
+                    {1, 1, 5, 5, 17}, {1, 1, 5, 5, 5}, {1, 1, 7, 11, 19}, {1, 1, 5, 1, 1},
+                    {1, 1, 1, 3, 11}, {1, 3, 5, 5, 31}
+                };
+                std::vector<unsigned int> degree;
+                std::vector<uint32_t> inner;
+                Polynomials(dim > 1 ? dim - 1 : 0, degree, inner);
+                std::mt19937 fixed(0);
+
+                for (unsigned int j = 0; j < dim; j++){
+                    uint32_t* v = &directions[static_cast<size_t>(j) * bits];
+                    if (j == 0){
+                        for (unsigned int k = 0; k < bits; k++){
+                            v[k] = uint32_t(1) << (bits - 1 - k);
+                        }
+                    }
+                    else{
+                        unsigned int s = degree[j - 1];
+                        uint32_t a = inner[j - 1];
+                        for (unsigned int k = 0; k < s; k++){
+                            uint32_t m = j - 1 < initial.size() ? initial[j - 1][k]
+                                                                : (fixed() % (uint32_t(1) << k)) * 2 + 1;
+                            v[k] = m << (bits - 1 - k);
+                        }
+                        for (unsigned int k = s; k < bits; k++){
+                            v[k] = v[k - s] ^ (v[k - s] >> s);
+                            for (unsigned int l = 1; l < s; l++){
+                                if ((a >> (s - 1 - l)) & 1){
+                                    v[k] ^= v[k - l];
+                                }
+                            }
+                        }
+                    }
+
+                    if (rng){
+                        // linear matrix scramble: 下三角(對角為1)的隨機矩陣乘上每個direction number
+                        uint32_t rows[bits];
+                        for (unsigned int r = 0; r < bits; r++){
+                            uint32_t mask = r ? static_cast<uint32_t>((*rng)()) << (bits - r) : 0;
+                            rows[r] = mask | (uint32_t(1) << (bits - 1 - r));
+                        }
+                        for (unsigned int k = 0; k < bits; k++){
+                            uint32_t x = 0;
+                            for (unsigned int r = 0; r < bits; r++){
+                                uint32_t y = rows[r] & v[k];
+                                y ^= y >> 16;
+                                y ^= y >> 8;
+                                y ^= y >> 4;
+                                y ^= y >> 2;
+                                y ^= y >> 1;
+                                x |= (y & 1) << (bits - 1 - r);
+                            }
+                            v[k] = x;
+                        }
+                        // digital shift
+                        state[j] = static_cast<uint32_t>((*rng)());
+                    }
+                }
+            }
+
+            unsigned int numOfDimensions() const
+            {
+                return dim;
+            }
+
+            // Write the next count points (row-major, count * dim values) to out
+            void Next(unsigned int count, double* out)
+            {
+                const double scale = 1.0 / 4294967296.0;
+                for (unsigned int n = 0; n < count; n++){
+                    double* point = out + static_cast<size_t>(n) * dim;
+                    for (unsigned int j = 0; j < dim; j++){
+                        point[j] = (state[j] + 0.5) * scale;
+                    }
+                    // Gray code: 下一個點只差index最低的0 bit對應的direction number
+                    unsigned int c = 0;
+                    while ((index >> c) & 1){
+                        c++;
+                    }
+                    assert(c < bits && "Sobol sequence exhausted");
+                    const uint32_t* v = directions.data() + c;
+                    for (unsigned int j = 0; j < dim; j++){
+                        state[j] ^= v[static_cast<size_t>(j) * bits];
+                    }
+                    index++;
+                }
+            }
+    };
+
+    // n points of [0, 1)^dim sampled by method, passed to visit(k, i, u) in point order
+    /*
+        * Uniform (and the first half of Opposition) draws independent
+        * coordinates; Sobol points are generated in blocks of 64.
+    */
+    template <class Rng, class Visit>
+    void SampleUnitCube(Initialization method, unsigned int n, unsigned int dim, Rng& rng, Visit visit)
+    {
+        if (method == Initialization::LatinHypercube){
+            std::vector<std::vector<double>> unit = LatinHypercube(n, dim, rng);
+            for (unsigned int k = 0; k < n; k++){
+                for (unsigned int i = 0; i < dim; i++){
+                    visit(k, i, unit[k][i]);
+                }
+            }
+            return;
+        }
+        if (method == Initialization::Sobol){
+            // 每次取樣用新的scramble
+            SobolSequence sobol(dim, &rng);
+            const unsigned int blockSize = 64;
+            std::vector<double> block(static_cast<size_t>(blockSize) * dim);
+            for (unsigned int first = 0; first < n; first += blockSize){
+                unsigned int count = std::min(blockSize, n - first);
+                sobol.Next(count, block.data());
+                for (unsigned int k = 0; k < count; k++){
+                    for (unsigned int i = 0; i < dim; i++){
+                        visit(first + k, i, block[static_cast<size_t>(k) * dim + i]);
+                    }
+                }
+            }
+            return;
+        }
+        std::uniform_real_distribution<double> dist(0, 1);
+        for (unsigned int k = 0; k < n; k++){
+            for (unsigned int i = 0; i < dim; i++){
+                visit(k, i, dist(rng));
+            }
+        }
+    }
+}
@@ -0,0 +1,531 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <functional>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <cassert>
+
+
+
+namespace DE
+{
+    // Local search used to polish the best individuals
+    enum class PolishMethod { NelderMead, LBFGSB };
+
+    /* PolishConfig: local search settings and when DifferentialEvolution runs it */
+    struct PolishConfig
+    {
+        PolishMethod method;
+        // 每個individuals最多用幾次evaluation
+        unsigned int maxEvaluations;
+        // 收斂條件: 相對的cost改善量 (Nelder-Mead: simplex中cost的範圍)
+        double tolerance;
+        // 每幾個generation polish一次 (0: 不在run中polish)
+        unsigned int everyGenerations;
+        // 一次polish幾個最好的individuals
+        unsigned int numOfAgents;
+        // OptimizeStep結束時是否polish
+        bool finalPolish;
+        // L-BFGS-B: 保留幾組(s, y) 以及finite difference的相對step
+        unsigned int memory;
+        double differenceStep;
+
+        PolishConfig(PolishMethod method = PolishMethod::LBFGSB,
+                     unsigned int maxEvaluations = 1000,
+                     double tolerance = 1e-10,
+                     unsigned int everyGenerations = 0,
+                     unsigned int numOfAgents = 1,
+                     bool finalPolish = true,
+                     unsigned int memory = 10,
+                     double differenceStep = 1.4901161193847656e-08) :
+            method(method),
+            maxEvaluations(maxEvaluations),
+            tolerance(tolerance),
+            everyGenerations(everyGenerations),
+            numOfAgents(numOfAgents),
+            finalPolish(finalPolish),
+            memory(memory),
+            differenceStep(differenceStep)
+        {
+            assert(numOfAgents >= 1 && "Polish at least one individual");
+            assert(memory >= 1 && differenceStep > 0 && tolerance >= 0);
+        }
+    };
+
+    /* PolishResult: outcome of one local search */
+    struct PolishResult
+    {
+        std::vector<double> x;
+        double cost;
+        // cost of the starting point
+        double startCost;
+        unsigned long long evaluations;
+        unsigned int iterations;
+        // false: stopped by the evaluation budget or a non-finite cost
+        bool converged;
+    };
+
+    // costs[i] must receive the cost of agents[i]; the agents of one call may be evaluated in parallel
+    using BatchCost = std::function<void(const std::vector<std::vector<double>>&, std::vector<double>&)>;
+
+
+    /* LocalSearch: bounded local optimizers that evaluate through a BatchCost */
+    /*
+        * NelderMead: simplex search; every point is clipped into the box.
+        *   The initial simplex and shrink steps are evaluated as one batch.
+        * LBFGSB: limited-memory BFGS projected onto the box. Variables at a
+        *   bound whose gradient points outwards are held fixed, the others
+        *   follow the two-loop L-BFGS direction and a projected Armijo
+        *   backtracking search. The gradient is a forward difference (a
+        *   backward one at an upper bound) and its numOfParameters points are
+        *   evaluated as one batch.
+        * Unbounded dimensions use -inf/+inf. A non-finite cost (e.g. an
+        * infeasible point) is treated as worse than any finite cost.
+    */
+    class LocalSearch{
+        private:
+            BatchCost cost;
+            std::vector<double> lower;
+            std::vector<double> upper;
+            PolishConfig config;
+            unsigned int dim;
+            unsigned long long evaluations;
+            // 單點evaluation的buffer
+            std::vector<std::vector<double>> single;
+            std::vector<double> singleCost;
+
+            void Clip(std::vector<double>& x) const
+            {
+                for (unsigned int i = 0; i < dim; i++){
+                    x[i] = std::min(std::max(x[i], lower[i]), upper[i]);
+                }
+            }
+
+            bool Affordable(size_t n) const
+            {
+                return evaluations + n <= config.maxEvaluations;
+            }
+
+            void EvaluateBatch(const std::vector<std::vector<double>>& agents, std::vector<double>& costs)
+            {
+                cost(agents, costs);
+                evaluations += agents.size();
+                // NaN當作+inf 比較時一定比較差
+                for (double& c : costs){
+                    if (std::isnan(c)){
+                        c = std::numeric_limits<double>::infinity();
+                    }
+                }
+            }
+
+            double Evaluate(const std::vector<double>& x)
+            {
+                single.assign(1, x);
+                EvaluateBatch(single, singleCost);
+                return singleCost[0];
+            }
+
+            bool Converged(double previous, double current) const
+            {
+                return previous - current <= config.tolerance * std::max({std::fabs(previous), std::fabs(current), 1.0});
+            }
+
+            // forward difference gradient (上界時改用backward) 一次batch evaluation
+            bool Gradient(const std::vector<double>& x, double f, std::vector<double>& g)
+            {
+                std::vector<std::vector<double>> points(dim, x);
+                std::vector<double> steps(dim);
+                for (unsigned int i = 0; i < dim; i++){
+                    double h = config.differenceStep * std::max(1.0, std::fabs(x[i]));
+                    if (x[i] + h > upper[i]){
+                        h = -h;
+                    }
+                    if (x[i] + h < lower[i]){
+                        // 範圍比step還小: 固定這個維度
+                        h = 0;
+                    }
+                    points[i][i] = x[i] + h;
+                    steps[i] = points[i][i] - x[i];
+                }
+                std::vector<double> costs;
+                EvaluateBatch(points, costs);
+                g.assign(dim, 0.0);
+                for (unsigned int i = 0; i < dim; i++){
+                    if (steps[i] == 0){
+                        continue;
+                    }
+                    if (!std::isfinite(costs[i])){
+                        return false;
+                    }
+                    g[i] = (costs[i] - f) / steps[i];
+                }
+                return true;
+            }
+
+        public:
+            /*
+                * INPUT:
+                    * cost: batch cost function
+                    * lower, upper: box of every dimension (-inf/+inf when unbounded)
+                    * config: method, budget and tolerances
+            */
+            LocalSearch(BatchCost cost,
+                        const std::vector<double>& lower,
+                        const std::vector<double>& upper,
+                        const PolishConfig& config = PolishConfig()) :
+                cost(cost),
+                lower(lower),
+                upper(upper),
+                config(config),
+                dim(static_cast<unsigned int>(lower.size())),
+                evaluations(0)
+            {
+                assert(cost != nullptr && lower.size() == upper.size());
+            }
+
+            // Start from x0 whose cost f0 is already known (no evaluation needed)
+            PolishResult Run(const std::vector<double>& x0, double f0)
+            {
+                if (config.method == PolishMethod::NelderMead){
+                    return NelderMead(x0, f0);
+                }
+                return LBFGSB(x0, f0);
+            }
+
+            PolishResult NelderMead(const std::vector<double>& x0, double f0)
+            {
+                evaluations = 0;
+                PolishResult result;
+                result.startCost = f0;
+                result.iterations = 0;
+                result.converged = false;
+
+                // 初始simplex: 沿每個座標移動5% (0的座標移動0.00025) 超出上界就往反方向
+                std::vector<std::vector<double>> simplex(dim + 1, x0);
+                std::vector<double> f(dim + 1, f0);
+                Clip(simplex[0]);
+                bool moved = simplex[0] != x0;
+                for (unsigned int i = 0; i < dim; i++){
+                    std::vector<double>& v = simplex[i + 1];
+                    double h = v[i] != 0 ? 0.05 * v[i] : 0.00025;
+                    if (v[i] + h > upper[i]){
+                        h = -std::fabs(h);
+                    }
+                    v[i] += h;
+                    Clip(v);
+                }
+                if (!Affordable(dim + (moved ? 1 : 0))){
+                    result.x = x0;
+                    result.cost = f0;
+                    result.evaluations = evaluations;
+                    return result;
+                }
+                std::vector<std::vector<double>> batch(simplex.begin() + (moved ? 0 : 1), simplex.end());
+                std::vector<double> costs;
+                EvaluateBatch(batch, costs);
+                std::copy(costs.begin(), costs.end(), f.begin() + (moved ? 0 : 1));
+
+                std::vector<size_t> order(dim + 1);
+                std::vector<double> centroid(dim);
+                std::vector<double> xr(dim), xe(dim), xc(dim);
+                for (;;){
+                    // 由好到壞排序
+                    for (size_t i = 0; i <= dim; i++){
+                        order[i] = i;
+                    }
+                    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b){ return f[a] < f[b]; });
+                    {
+                        std::vector<std::vector<double>> s(dim + 1);
+                        std::vector<double> c(dim + 1);
+                        for (size_t i = 0; i <= dim; i++){
+                            s[i].swap(simplex[order[i]]);
+                            c[i] = f[order[i]];
+                        }
+                        simplex.swap(s);
+                        f.swap(c);
+                    }
+
+                    // 收斂: simplex中cost的範圍夠小
+                    if (std::isfinite(f[dim]) && Converged(f[dim], f[0])){
+                        result.converged = true;
+                        break;
+                    }
+                    if (!Affordable(1)){
+                        break;
+                    }
+                    result.iterations++;
+
+                    std::fill(centroid.begin(), centroid.end(), 0.0);
+                    for (unsigned int v = 0; v < dim; v++){
+                        for (unsigned int i = 0; i < dim; i++){
+                            centroid[i] += simplex[v][i] / dim;
+                        }
+                    }
+                    const std::vector<double>& worst = simplex[dim];
+
+                    // reflection
+                    for (unsigned int i = 0; i < dim; i++){
+                        xr[i] = 2 * centroid[i] - worst[i];
+                    }
+                    Clip(xr);
+                    double fr = Evaluate(xr);
+
+                    if (fr < f[0]){
+                        // expansion
+                        if (Affordable(1)){
+                            for (unsigned int i = 0; i < dim; i++){
+                                xe[i] = 3 * centroid[i] - 2 * worst[i];
+                            }
+                            Clip(xe);
+                            double fe = Evaluate(xe);
+                            if (fe < fr){
+                                simplex[dim] = xe;
+                                f[dim] = fe;
+                                continue;
+                            }
+                        }
+                        simplex[dim] = xr;
+                        f[dim] = fr;
+                        continue;
+                    }
+                    if (fr < f[dim - 1]){
+                        simplex[dim] = xr;
+                        f[dim] = fr;
+                        continue;
+                    }
+                    if (!Affordable(1)){
+                        break;
+                    }
+
+                    // contraction (outside when the reflection is better than the worst)
+                    bool outside = fr < f[dim];
+                    const std::vector<double>& towards = outside ? xr : worst;
+                    for (unsigned int i = 0; i < dim; i++){
+                        xc[i] = 0.5 * (centroid[i] + towards[i]);
+                    }
+                    Clip(xc);
+                    double fc = Evaluate(xc);
+                    if (fc < std::min(fr, f[dim])){
+                        simplex[dim] = xc;
+                        f[dim] = fc;
+                        continue;
+                    }
+                    // shrink toward the best vertex (one batch)
+                    if (!Affordable(dim)){
+                        break;
+                    }
+                    for (unsigned int v = 1; v <= dim; v++){
+                        for (unsigned int i = 0; i < dim; i++){
+                            simplex[v][i] = 0.5 * (simplex[0][i] + simplex[v][i]);
+                        }
+                    }
+                    batch.assign(simplex.begin() + 1, simplex.end());
+                    EvaluateBatch(batch, costs);
+                    std::copy(costs.begin(), costs.end(), f.begin() + 1);
+                }
+
+                size_t best = std::min_element(f.begin(), f.end()) - f.begin();
+                result.x = simplex[best];
+                result.cost = f[best];
+                if (!(result.cost < f0)){
+                    result.x = x0;
+                    result.cost = f0;
+                }
+                result.evaluations = evaluations;
+                return result;
+            }
+
+            PolishResult LBFGSB(const std::vector<double>& x0, double f0)
+            {
+                evaluations = 0;
+                PolishResult result;
+                result.startCost = f0;
+                result.iterations = 0;
+                result.converged = false;
+                result.x = x0;
+                result.cost = f0;
+
+                std::vector<double> x(x0);
+                Clip(x);
+                double f = f0;
+                if (x != x0){
+                    if (!Affordable(1)){
+                        result.evaluations = evaluations;
+                        return result;
+                    }
+                    f = Evaluate(x);
+                }
+                std::vector<double> g;
+                if (!std::isfinite(f) || !Affordable(dim) || !Gradient(x, f, g)){
+                    result.evaluations = evaluations;
+                    return result;
+                }
+
+                // L-BFGS memory
+                std::deque<std::vector<double>> S;
+                std::deque<std::vector<double>> Y;
+                std::deque<double> rho;
+                std::vector<double> d(dim), q(dim), xn(dim), gn;
+                std::vector<char> active(dim);
+                std::vector<double> alpha;
+
+                for (;;){
+                    // active set: 在邊界上且gradient指向外面的維度固定不動
+                    bool anyFree = false;
+                    for (unsigned int i = 0; i < dim; i++){
+                        active[i] = (x[i] <= lower[i] && g[i] > 0) || (x[i] >= upper[i] && g[i] < 0);
+                        anyFree |= !active[i] && g[i] != 0;
+                    }
+                    if (!anyFree){
+                        // projected gradient為0
+                        result.converged = true;
+                        break;
+                    }
+
+                    // two-loop recursion (只用free variables)
+                    for (unsigned int i = 0; i < dim; i++){
+                        q[i] = active[i] ? 0.0 : g[i];
+                    }
+                    alpha.assign(S.size(), 0.0);
+                    for (size_t m = S.size(); m-- > 0;){
+                        double a = 0;
+                        for (unsigned int i = 0; i < dim; i++){
+                            a += S[m][i] * q[i];
+                        }
+                        a *= rho[m];
+                        alpha[m] = a;
+                        for (unsigned int i = 0; i < dim; i++){
+                            q[i] -= a * Y[m][i];
+                        }
+                    }
+                    double gamma = 1.0;
+                    if (!S.empty()){
+                        double sy = 0, yy = 0;
+                        for (unsigned int i = 0; i < dim; i++){
+                            sy += S.back()[i] * Y.back()[i];
+                            yy += Y.back()[i] * Y.back()[i];
+                        }
+                        gamma = sy / yy;
+                    }
+                    for (unsigned int i = 0; i < dim; i++){
+                        q[i] *= gamma;
+                    }
+                    for (size_t m = 0; m < S.size(); m++){
+                        double b = 0;
+                        for (unsigned int i = 0; i < dim; i++){
+                            b += Y[m][i] * q[i];
+                        }
+                        b *= rho[m];
+                        for (unsigned int i = 0; i < dim; i++){
+                            q[i] += S[m][i] * (alpha[m] - b);
+                        }
+                    }
+                    double slope = 0;
+                    for (unsigned int i = 0; i < dim; i++){
+                        d[i] = active[i] ? 0.0 : -q[i];
+                        slope += g[i] * d[i];
+                    }
+                    // 不是下降方向時捨棄memory 改用steepest descent
+                    if (!(slope < 0)){
+                        S.clear();
+                        Y.clear();
+                        rho.clear();
+                        slope = 0;
+                        for (unsigned int i = 0; i < dim; i++){
+                            d[i] = active[i] ? 0.0 : -g[i];
+                            slope += g[i] * d[i];
+                        }
+                    }
+                    // 第一步沒有曲率資訊: 限制step的長度
+                    double step = 1.0;
+                    if (S.empty()){
+                        double norm = 0;
+                        for (unsigned int i = 0; i < dim; i++){
+                            norm = std::max(norm, std::fabs(d[i]));
+                        }
+                        step = std::min(1.0, 1.0 / norm);
+                    }
+
+                    // projected Armijo backtracking
+                    double fn = std::numeric_limits<double>::infinity();
+                    bool found = false;
+                    for (int tries = 0; tries < 30 && Affordable(1); tries++){
+                        double decrease = 0;
+                        for (unsigned int i = 0; i < dim; i++){
+                            xn[i] = x[i] + step * d[i];
+                        }
+                        Clip(xn);
+                        for (unsigned int i = 0; i < dim; i++){
+                            decrease += g[i] * (xn[i] - x[i]);
+                        }
+                        if (xn == x){
+                            break;
+                        }
+                        fn = Evaluate(xn);
+                        if (fn <= f + 1e-4 * decrease){
+                            found = true;
+                            break;
+                        }
+                        step *= 0.5;
+                    }
+                    if (!found){
+                        // 已經沒有可以改善的step (或用完budget)
+                        result.converged = Affordable(1);
+                        break;
+                    }
+                    result.iterations++;
+
+                    bool converged = Converged(f, fn);
+                    if (!Affordable(dim) || !Gradient(xn, fn, gn)){
+                        x = xn;
+                        f = fn;
+                        result.converged = converged;
+                        break;
+                    }
+
+                    // 更新memory (曲率條件成立時)
+                    std::vector<double> s(dim), y(dim);
+                    double sy = 0, yy = 0;
+                    for (unsigned int i = 0; i < dim; i++){
+                        s[i] = xn[i] - x[i];
+                        y[i] = gn[i] - g[i];
+                        sy += s[i] * y[i];
+                        yy += y[i] * y[i];
+                    }
+                    if (sy > 1e-10 * yy && sy > 0){
+                        if (S.size() == config.memory){
+                            S.pop_front();
+                            Y.pop_front();
+                            rho.pop_front();
+                        }
+                        S.push_back(s);
+                        Y.push_back(y);
+                        rho.push_back(1.0 / sy);
+                    }
+                    x.swap(xn);
+                    g.swap(gn);
+                    f = fn;
+                    if (converged){
+                        result.converged = true;
+                        break;
+                    }
+                }
+
+                if (f < f0){
+                    result.x = x;
+                    result.cost = f;
+                }
+                result.evaluations = evaluations;
+                return result;
+            }
+
+            // Number of evaluations of the last Run
+            unsigned long long numOfEvaluations() const
+            {
+                return evaluations;
+            }
+    };
+}
@@ -0,0 +1,714 @@
+#pragma once
+
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <random>
+#include <limits>
+#include <cmath>
+#include <cassert>
+#include <map>
+#include <iterator>
+
+#include "DE.h"
+
+
+
+namespace DE
+{
+    /* MultiObjective: objective with several costs, all minimized */
+    class MultiObjective{
+    public:
+        // costs points to numOfObjectives() values to fill
+        virtual void EvaluateCosts(VectorView input, double* costs) const = 0;
+        virtual unsigned int numOfObjectives() const = 0;
+        virtual unsigned int numOfParameters() const = 0;
+        virtual std::vector<Optimize::Constraint> getConstraints() const = 0;
+        // General constraints (default: none); see Optimize::NonlinearConstraint
+        virtual std::vector<Optimize::NonlinearConstraint> getNonlinearConstraints() const
+        {
+            return std::vector<Optimize::NonlinearConstraint>();
+        }
+        virtual ~MultiObjective() {};
+    };
+
+    // Multi-objective version of customFunction: same box for every dimension
+    class customMultiObjective : public MultiObjective
+    {
+        private:
+            unsigned int dim;
+            unsigned int numOfCosts;
+            std::function<void(const double*, unsigned int, double*)> function;
+            const double lower;
+            const double upper;
+            std::vector<Optimize::NonlinearConstraint> nonlinear;
+
+        public:
+            /*
+                * INPUT:
+                    * dimension: number of parameters
+                    * numOfObjectives: number of costs
+                    * func: (x, dimension, costs) writes the numOfObjectives costs of x
+                    * lower_bound, upper_bound: box of every parameter
+            */
+            customMultiObjective(
+                unsigned int dimension,
+                unsigned int numOfObjectives,
+                std::function<void(const double*, unsigned int, double*)> func,
+                const double lower_bound,
+                const double upper_bound
+            ) :
+            dim(dimension),
+            numOfCosts(numOfObjectives),
+            function(func),
+            lower(lower_bound),
+            upper(upper_bound)
+            {
+                assert(dimension > 0 && "Dimension must be greater than 0");
+                assert(numOfObjectives > 0 && "At least one objective");
+                assert(lower_bound < upper_bound && "Lower bound must be less than upper bound");
+                assert(func != nullptr && "Function must be defined");
+            }
+
+            void EvaluateCosts(VectorView input, double* costs) const override
+            {
+                assert(input.size() == dim);
+                function(input.data(), dim, costs);
+            }
+
+            unsigned int numOfObjectives() const override
+            {
+                return numOfCosts;
+            }
+
+            unsigned int numOfParameters() const override
+            {
+                return dim;
+            }
+
+            std::vector<Optimize::Constraint> getConstraints() const override
+            {
+                return std::vector<Optimize::Constraint>(dim, Optimize::Constraint(lower, upper, true));
+            }
+
+            void AddConstraint(const Optimize::NonlinearConstraint& constraint)
+            {
+                nonlinear.push_back(constraint);
+            }
+
+            std::vector<Optimize::NonlinearConstraint> getNonlinearConstraints() const override
+            {
+                return nonlinear;
+            }
+    };
+
+
+    // a的每個cost都不大於b 且至少一個比較小
+    inline bool Dominates(const std::vector<double>& a, const std::vector<double>& b)
+    {
+        bool better = false;
+        for (size_t m = 0; m < a.size(); m++){
+            if (a[m] > b[m]){
+                return false;
+            }
+            better |= a[m] < b[m];
+        }
+        return better;
+    }
+
+    /* NonDominatedSorter: fronts of distinct points by divide and conquer */
+    /*
+        * Generalized Jensen algorithm (Fortin et al. 2013, with the ties
+        * handling of Buzdalov and Shalyto 2014): O(N log^(M-1) N) for M >= 2
+        * objectives. The points must be distinct and sorted lexicographically,
+        * so that a point can only be dominated by points before it and weak
+        * dominance between two points is dominance.
+        * HelperA(S, k) ranks S knowing that S agrees on the objectives after k.
+        * HelperB(L, H, k) raises the ranks of H from the final ranks of L
+        * knowing that every point of L is <= every point of H after k.
+        * Both split on the median of objective k; objectives 0 and 1 are
+        * handled by a sweep over a staircase of (objective 1, rank).
+    */
+    class NonDominatedSorter{
+        private:
+            const std::vector<const double*>& points;
+            std::vector<unsigned int>& rank;
+
+            // a <= b on objectives 0..k
+            bool WeaklyDominates(size_t a, size_t b, unsigned int k) const
+            {
+                for (unsigned int m = 0; m <= k; m++){
+                    if (points[a][m] > points[b][m]){
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            double Median(const std::vector<size_t>& S, unsigned int k) const
+            {
+                std::vector<double> values(S.size());
+                for (size_t i = 0; i < S.size(); i++){
+                    values[i] = points[S[i]][k];
+                }
+                std::nth_element(values.begin(), values.begin() + values.size() / 2, values.end());
+                return values[values.size() / 2];
+            }
+
+            // 依objective k 分成 < m, == m, > m (保持順序)
+            void Split(const std::vector<size_t>& S, unsigned int k, double m,
+                       std::vector<size_t>& less, std::vector<size_t>& equal, std::vector<size_t>& greater) const
+            {
+                for (size_t p : S){
+                    double v = points[p][k];
+                    (v < m ? less : v == m ? equal : greater).push_back(p);
+                }
+            }
+
+            static std::vector<size_t> Merge(const std::vector<size_t>& a, const std::vector<size_t>& b)
+            {
+                std::vector<size_t> merged(a.size() + b.size());
+                std::merge(a.begin(), a.end(), b.begin(), b.end(), merged.begin());
+                return merged;
+            }
+
+            // staircase: objective 1 -> rank, both increasing
+            static unsigned int Query(const std::map<double, unsigned int>& stairs, double y, bool& found)
+            {
+                auto it = stairs.upper_bound(y);
+                found = it != stairs.begin();
+                return found ? std::prev(it)->second : 0;
+            }
+
+            static void Insert(std::map<double, unsigned int>& stairs, double y, unsigned int r)
+            {
+                bool found;
+                unsigned int below = Query(stairs, y, found);
+                if (found && below >= r){
+                    return;
+                }
+                auto it = stairs.lower_bound(y);
+                while (it != stairs.end() && it->second <= r){
+                    it = stairs.erase(it);
+                }
+                stairs.emplace(y, r);
+            }
+
+            void SweepA(const std::vector<size_t>& S)
+            {
+                std::map<double, unsigned int> stairs;
+                for (size_t p : S){
+                    bool found;
+                    unsigned int r = Query(stairs, points[p][1], found);
+                    if (found){
+                        rank[p] = std::max(rank[p], r + 1);
+                    }
+                    Insert(stairs, points[p][1], rank[p]);
+                }
+            }
+
+            void SweepB(const std::vector<size_t>& L, const std::vector<size_t>& H)
+            {
+                std::map<double, unsigned int> stairs;
+                size_t l = 0;
+                for (size_t h : H){
+                    for (; l < L.size() && L[l] < h; l++){
+                        Insert(stairs, points[L[l]][1], rank[L[l]]);
+                    }
+                    bool found;
+                    unsigned int r = Query(stairs, points[h][1], found);
+                    if (found){
+                        rank[h] = std::max(rank[h], r + 1);
+                    }
+                }
+            }
+
+        public:
+            NonDominatedSorter(const std::vector<const double*>& points, std::vector<unsigned int>& rank) :
+                points(points),
+                rank(rank)
+            {}
+
+            void HelperA(const std::vector<size_t>& S, unsigned int k)
+            {
+                if (S.size() < 2){
+                    return;
+                }
+                if (S.size() == 2){
+                    if (WeaklyDominates(S[0], S[1], k)){
+                        rank[S[1]] = std::max(rank[S[1]], rank[S[0]] + 1);
+                    }
+                    return;
+                }
+                if (k == 1){
+                    SweepA(S);
+                    return;
+                }
+                auto range = std::minmax_element(S.begin(), S.end(), [this, k](size_t a, size_t b){
+                    return points[a][k] < points[b][k];
+                });
+                if (points[*range.first][k] == points[*range.second][k]){
+                    HelperA(S, k - 1);
+                    return;
+                }
+                std::vector<size_t> less, equal, greater;
+                Split(S, k, Median(S, k), less, equal, greater);
+                HelperA(less, k);
+                HelperB(less, equal, k - 1);
+                HelperA(equal, k - 1);
+                HelperB(Merge(less, equal), greater, k - 1);
+                HelperA(greater, k);
+            }
+
+            void HelperB(const std::vector<size_t>& L, const std::vector<size_t>& H, unsigned int k)
+            {
+                if (L.empty() || H.empty()){
+                    return;
+                }
+                if (L.size() == 1 || H.size() == 1){
+                    for (size_t h : H){
+                        for (size_t l : L){
+                            if (WeaklyDominates(l, h, k)){
+                                rank[h] = std::max(rank[h], rank[l] + 1);
+                            }
+                        }
+                    }
+                    return;
+                }
+                if (k == 1){
+                    SweepB(L, H);
+                    return;
+                }
+                auto byK = [this, k](size_t a, size_t b){
+                    return points[a][k] < points[b][k];
+                };
+                double maxL = points[*std::max_element(L.begin(), L.end(), byK)][k];
+                double minH = points[*std::min_element(H.begin(), H.end(), byK)][k];
+                if (maxL <= minH){
+                    HelperB(L, H, k - 1);
+                    return;
+                }
+                double minL = points[*std::min_element(L.begin(), L.end(), byK)][k];
+                double maxH = points[*std::max_element(H.begin(), H.end(), byK)][k];
+                if (minL > maxH){
+                    return;
+                }
+                double m = Median(Merge(L, H), k);
+                std::vector<size_t> lessL, equalL, greaterL, lessH, equalH, greaterH;
+                Split(L, k, m, lessL, equalL, greaterL);
+                Split(H, k, m, lessH, equalH, greaterH);
+                HelperB(lessL, lessH, k);
+                HelperB(Merge(lessL, equalL), Merge(equalH, greaterH), k - 1);
+                HelperB(greaterL, greaterH, k);
+            }
+    };
+
+    // Non-dominated sorting: rank of every point (0 = Pareto front)
+    /*
+        * Equal points share a rank; the distinct ones are ranked by
+        * NonDominatedSorter in O(N log N) for two objectives and
+        * O(N log^(M-1) N) for M objectives.
+        * With violations, feasible points (violation 0) come first; the
+        * infeasible ones follow in fronts of equal total violation.
+    */
+    inline std::vector<unsigned int> NonDominatedSort(const std::vector<std::vector<double>>& costs,
+                                                      const std::vector<double>* violations = nullptr)
+    {
+        size_t n = costs.size();
+        std::vector<unsigned int> rank(n, 0);
+        std::vector<size_t> feasible;
+        std::vector<size_t> infeasible;
+        for (size_t i = 0; i < n; i++){
+            if (violations && (*violations)[i] > 0){
+                infeasible.push_back(i);
+            }
+            else{
+                feasible.push_back(i);
+            }
+        }
+        std::sort(feasible.begin(), feasible.end(), [&costs](size_t a, size_t b){
+            return std::lexicographical_compare(costs[a].begin(), costs[a].end(), costs[b].begin(), costs[b].end());
+        });
+
+        // 相同的costs只保留一個 (同一個front)
+        std::vector<const double*> points;
+        std::vector<size_t> unique(feasible.size());
+        for (size_t t = 0; t < feasible.size(); t++){
+            if (!t || costs[feasible[t]] != costs[feasible[t - 1]]){
+                points.push_back(costs[feasible[t]].data());
+            }
+            unique[t] = points.size() - 1;
+        }
+        std::vector<unsigned int> uniqueRank(points.size(), 0);
+        unsigned int numOfCosts = n ? static_cast<unsigned int>(costs[0].size()) : 0;
+        if (numOfCosts == 1){
+            for (size_t u = 0; u < points.size(); u++){
+                uniqueRank[u] = static_cast<unsigned int>(u);
+            }
+        }
+        else if (numOfCosts > 1){
+            std::vector<size_t> all(points.size());
+            for (size_t u = 0; u < all.size(); u++){
+                all[u] = u;
+            }
+            NonDominatedSorter(points, uniqueRank).HelperA(all, numOfCosts - 1);
+        }
+        unsigned int numOfFronts = 0;
+        for (size_t t = 0; t < feasible.size(); t++){
+            rank[feasible[t]] = uniqueRank[unique[t]];
+            numOfFronts = std::max(numOfFronts, rank[feasible[t]] + 1);
+        }
+
+        // infeasible: 依violation排序 相同violation同一個front
+        std::sort(infeasible.begin(), infeasible.end(), [violations](size_t a, size_t b){
+            return (*violations)[a] < (*violations)[b] || ((*violations)[a] == (*violations)[b] && a < b);
+        });
+        unsigned int next = numOfFronts;
+        for (size_t t = 0; t < infeasible.size(); t++){
+            if (t && (*violations)[infeasible[t]] != (*violations)[infeasible[t - 1]]){
+                next++;
+            }
+            rank[infeasible[t]] = next;
+        }
+        return rank;
+    }
+
+    // Crowding distance of the points of one front (boundary points: +inf)
+    inline std::vector<double> CrowdingDistance(const std::vector<std::vector<double>>& costs,
+                                                const std::vector<size_t>& front)
+    {
+        size_t n = front.size();
+        std::vector<double> distance(n, 0.0);
+        if (n == 0){
+            return distance;
+        }
+        std::vector<size_t> order(n);
+        for (size_t m = 0; m < costs[front[0]].size(); m++){
+            for (size_t i = 0; i < n; i++){
+                order[i] = i;
+            }
+            std::sort(order.begin(), order.end(), [&](size_t a, size_t b){
+                return costs[front[a]][m] < costs[front[b]][m];
+            });
+            double low = costs[front[order[0]]][m];
+            double high = costs[front[order[n - 1]]][m];
+            distance[order[0]] = std::numeric_limits<double>::infinity();
+            distance[order[n - 1]] = std::numeric_limits<double>::infinity();
+            if (!(high > low)){
+                continue;
+            }
+            for (size_t i = 1; i + 1 < n; i++){
+                distance[order[i]] += (costs[front[order[i + 1]]][m] - costs[front[order[i - 1]]][m]) / (high - low);
+            }
+        }
+        return distance;
+    }
+
+
+    /* MultiObjectiveDE: generalized differential evolution (GDE3) */
+    /*
+        * Every generation builds one DE/rand/1/bin trial per individual from
+        * the current population and evaluates them as a batch (in parallel
+        * on a ThreadPool when one is set; the result does not depend on the
+        * number of threads). A trial that weakly dominates its target
+        * replaces it, a dominated trial is dropped, and otherwise both are
+        * kept. The population is then reduced back to populationSize by
+        * non-dominated sorting, the last front being truncated by crowding
+        * distance. Constraint domination: a feasible point beats an
+        * infeasible one, infeasible points are compared by total violation
+        * (the objective is not called for infeasible trials).
+    */
+    class MultiObjectiveDE{
+        private:
+            const MultiObjective& costFunction;
+            unsigned int populationSize;
+            double F;
+            double CR;
+            unsigned int numOfParameters;
+            unsigned int numOfObjectives;
+            std::default_random_engine generator;
+            std::vector<std::vector<double>> population;
+            // 每個individuals的costs 以及違反nonlinear constraint的量
+            std::vector<std::vector<double>> costs;
+            std::vector<double> violations;
+            std::vector<Optimize::Constraint> constraints;
+            std::vector<Optimize::NonlinearConstraint> nonlinearConstraints;
+            // 平行evaluation用的thread pool (nullptr代表目前的thread)
+            ThreadPool* pool;
+            Initialization initialization;
+            double unboundedScale;
+            unsigned int generation;
+            unsigned long long numOfEvaluations;
+
+            double Violation(const std::vector<double>& agent) const
+            {
+                double violation;
+                SumViolations(nonlinearConstraints, agent, std::numeric_limits<double>::infinity(), violation);
+                return violation;
+            }
+
+            // 平行evaluation (infeasible的agent不呼叫objective cost為+inf)
+            void EvaluateAll(const std::vector<std::vector<double>>& agents, const std::vector<double>& agentViolations,
+                             std::vector<std::vector<double>>& agentCosts)
+            {
+                int n = static_cast<int>(agents.size());
+                agentCosts.assign(n, std::vector<double>(numOfObjectives, std::numeric_limits<double>::infinity()));
+                ParallelFor(pool, n, [&](int i){
+                    if (agentViolations[i] <= 0){
+                        costFunction.EvaluateCosts(agents[i], agentCosts[i].data());
+                    }
+                });
+                for (int i = 0; i < n; i++){
+                    if (agentViolations[i] <= 0){
+                        numOfEvaluations++;
+                    }
+                }
+            }
+
+            // a (cost, violation) 是否weakly dominate b
+            bool WeaklyDominates(const std::vector<double>& a, double violationA,
+                                 const std::vector<double>& b, double violationB) const
+            {
+                if (violationA > 0 || violationB > 0){
+                    return violationA <= violationB;
+                }
+                for (unsigned int m = 0; m < numOfObjectives; m++){
+                    if (a[m] > b[m]){
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            // DE/rand/1/bin trial for target k; 超出box的座標重新在box內取樣
+            void MakeTrial(unsigned int k, std::vector<double>& Y)
+            {
+                RandOneBinTrial(population, static_cast<int>(population.size()), static_cast<int>(k), F, CR, Y, generator);
+                for (unsigned int i = 0; i < numOfParameters; i++){
+                    if (!constraints[i].Check(Y[i])){
+                        Y[i] = std::uniform_real_distribution<double>(constraints[i].lower, constraints[i].upper)(generator);
+                    }
+                }
+            }
+
+            // 依front及crowding distance縮減到populationSize
+            void Reduce()
+            {
+                if (population.size() <= populationSize){
+                    return;
+                }
+                std::vector<unsigned int> rank = NonDominatedSort(costs, &violations);
+                unsigned int numOfFronts = *std::max_element(rank.begin(), rank.end()) + 1;
+                std::vector<std::vector<size_t>> fronts(numOfFronts);
+                for (size_t i = 0; i < rank.size(); i++){
+                    fronts[rank[i]].push_back(i);
+                }
+                std::vector<size_t> keep;
+                keep.reserve(populationSize);
+                for (auto& front : fronts){
+                    if (keep.size() + front.size() <= populationSize){
+                        keep.insert(keep.end(), front.begin(), front.end());
+                        continue;
+                    }
+                    // 最後一個front: crowding distance大的優先 (相同時index小的優先)
+                    std::vector<double> distance = CrowdingDistance(costs, front);
+                    std::vector<size_t> order(front.size());
+                    for (size_t i = 0; i < order.size(); i++){
+                        order[i] = i;
+                    }
+                    std::stable_sort(order.begin(), order.end(), [&distance](size_t a, size_t b){
+                        return distance[a] > distance[b];
+                    });
+                    for (size_t i = 0; keep.size() < populationSize; i++){
+                        keep.push_back(front[order[i]]);
+                    }
+                    break;
+                }
+                std::sort(keep.begin(), keep.end());
+
+                std::vector<std::vector<double>> newPopulation(keep.size());
+                std::vector<std::vector<double>> newCosts(keep.size());
+                std::vector<double> newViolations(keep.size());
+                for (size_t i = 0; i < keep.size(); i++){
+                    newPopulation[i].swap(population[keep[i]]);
+                    newCosts[i].swap(costs[keep[i]]);
+                    newViolations[i] = violations[keep[i]];
+                }
+                population.swap(newPopulation);
+                costs.swap(newCosts);
+                violations.swap(newViolations);
+            }
+
+        public:
+            /*
+                * INPUT:
+                    * costFunction: multi-objective function (not owned)
+                    * populationSize: number of individuals kept after each generation
+                    * F: differential weight
+                    * CR: crossover rate
+                    * RandomSeed: seed of the random number generator
+            */
+            MultiObjectiveDE(
+                const MultiObjective& costFunction,
+                unsigned int populationSize,
+                double F,
+                double CR,
+                int RandomSeed = 123
+            ):
+                costFunction(costFunction),
+                populationSize(populationSize),
+                F(F),
+                CR(CR),
+                numOfParameters(costFunction.numOfParameters()),
+                numOfObjectives(costFunction.numOfObjectives()),
+                pool(nullptr),
+                initialization(Initialization::Uniform),
+                unboundedScale(1.0),
+                generation(0),
+                numOfEvaluations(0)
+            {
+                assert(populationSize >= 4);
+                generator.seed(RandomSeed);
+                constraints = costFunction.getConstraints();
+                nonlinearConstraints = costFunction.getNonlinearConstraints();
+            }
+
+            // Evaluate each generation's trials on a thread pool (not owned; nullptr: calling thread)
+            void SetThreadPool(ThreadPool* threadPool)
+            {
+                pool = threadPool;
+            }
+
+            // Uniform, LatinHypercube or Sobol sampling of the initial population
+            void SetInitialization(Initialization method, double unboundedScale = 1.0)
+            {
+                assert(method != Initialization::Opposition && "Opposition needs a single cost");
+                assert(unboundedScale > 0);
+                initialization = method;
+                this->unboundedScale = unboundedScale;
+            }
+
+            void InitializePopulation()
+            {
+                generation = 0;
+                population.assign(populationSize, std::vector<double>(numOfParameters));
+                SampleUnitCube(initialization, populationSize, numOfParameters, generator, [this](unsigned int k, unsigned int i, double u){
+                    double lower = constraints[i].SampleLower(unboundedScale);
+                    double upper = constraints[i].SampleUpper(unboundedScale);
+                    population[k][i] = lower + (upper - lower) * u;
+                });
+                violations.resize(populationSize);
+                for (unsigned int k = 0; k < populationSize; k++){
+                    violations[k] = Violation(population[k]);
+                }
+                EvaluateAll(population, violations, costs);
+            }
+
+            void SelectAndCross()
+            {
+                generation++;
+                unsigned int n = static_cast<unsigned int>(population.size());
+                std::vector<std::vector<double>> trials(n);
+                std::vector<double> trialViolations(n);
+                for (unsigned int k = 0; k < n; k++){
+                    MakeTrial(k, trials[k]);
+                    trialViolations[k] = Violation(trials[k]);
+                }
+                std::vector<std::vector<double>> trialCosts;
+                EvaluateAll(trials, trialViolations, trialCosts);
+
+                // GDE3 selection 依index順序
+                for (unsigned int k = 0; k < n; k++){
+                    if (WeaklyDominates(trialCosts[k], trialViolations[k], costs[k], violations[k])){
+                        population[k].swap(trials[k]);
+                        costs[k].swap(trialCosts[k]);
+                        violations[k] = trialViolations[k];
+                    }
+                    else if (!WeaklyDominates(costs[k], violations[k], trialCosts[k], trialViolations[k])){
+                        // 互不支配: 兩個都留下
+                        population.push_back(trials[k]);
+                        costs.push_back(trialCosts[k]);
+                        violations.push_back(trialViolations[k]);
+                    }
+                }
+                Reduce();
+            }
+
+            void OptimizeStep(int iterations)
+            {
+                InitializePopulation();
+                for (int i = 0; i < iterations; i++){
+                    SelectAndCross();
+                }
+            }
+
+            // * 回傳每個individuals的front (0 = Pareto front)
+            std::vector<unsigned int> GetRanks() const
+            {
+                return NonDominatedSort(costs, &violations);
+            }
+
+            // * 回傳目前population中非支配(且feasible)的individuals的index
+            std::vector<size_t> GetParetoIndices() const
+            {
+                std::vector<unsigned int> rank = GetRanks();
+                std::vector<size_t> front;
+                for (size_t i = 0; i < rank.size(); i++){
+                    if (rank[i] == 0 && violations[i] <= 0){
+                        front.push_back(i);
+                    }
+                }
+                return front;
+            }
+
+            // * 回傳Pareto front的costs (每列一個individuals)
+            std::vector<std::vector<double>> GetParetoFront() const
+            {
+                std::vector<std::vector<double>> front;
+                for (size_t i : GetParetoIndices()){
+                    front.push_back(costs[i]);
+                }
+                return front;
+            }
+
+            // * 回傳Pareto front的individuals
+            std::vector<std::vector<double>> GetParetoSet() const
+            {
+                std::vector<std::vector<double>> set;
+                for (size_t i : GetParetoIndices()){
+                    set.push_back(population[i]);
+                }
+                return set;
+            }
+
+            const std::vector<std::vector<double>>& getPopulation() const
+            {
+                return population;
+            }
+
+            const std::vector<std::vector<double>>& GetPopulationCosts() const
+            {
+                return costs;
+            }
+
+            unsigned int GetNumOfObjectives() const
+            {
+                return numOfObjectives;
+            }
+
+            unsigned int GetNumOfParameters() const
+            {
+                return numOfParameters;
+            }
+
+            unsigned int GetGeneration() const
+            {
+                return generation;
+            }
+
+            unsigned long long GetNumOfEvaluations() const
+            {
+                return numOfEvaluations;
+            }
+    };
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cassert>
+
+#include "DE.h"
+#include "thread_pool.h"
+
+
+
+namespace DE
+{
+    /* Configuration of one optimization run */
+    struct RunConfig
+    {
+        unsigned int populationSize;
+        double F;
+        double CR;
+        int RandomSeed;
+        int iterations;
+        bool shouldCheckConstraint;
+
+        RunConfig(unsigned int populationSize = 50,
+                  double F = 0.8,
+                  double CR = 0.9,
+                  int RandomSeed = 123,
+                  int iterations = 1000,
+                  bool shouldCheckConstraint = true) :
+            populationSize(populationSize),
+            F(F),
+            CR(CR),
+            RandomSeed(RandomSeed),
+            iterations(iterations),
+            shouldCheckConstraint(shouldCheckConstraint)
+        {}
+    };
+
+    // One (objective, config) pair; the objective must outlive the run
+    struct RunJob
+    {
+        const Optimize* costFunction;
+        RunConfig config;
+
+        RunJob(const Optimize& costFunction, const RunConfig& config = RunConfig()) :
+            costFunction(&costFunction),
+            config(config)
+        {}
+    };
+
+    // Result of one run
+    struct RunResult
+    {
+        std::vector<double> bestAgent;
+        double bestCost;
+        int generations;
+        unsigned long long evaluations;
+    };
+
+
+    /* MultiRun: many DifferentialEvolution runs on one shared thread pool */
+    /*
+        * Every generation of every job is a separate pool task. A job queues
+        * its next generation when the current one finishes, so with more jobs
+        * than threads the generations of all jobs are interleaved and every
+        * worker stays busy until the last job ends.
+        * With nodeLocal the workers are pinned across the NUMA nodes and every
+        * job (island) stays on one worker: its optimizer is constructed there,
+        * so the population is first-touched and kept on that worker's node.
+        * Jobs are then assigned to workers round-robin instead of balanced
+        * dynamically.
+    */
+    class MultiRun{
+        private:
+            bool nodeLocal;
+            ThreadPool pool;
+
+            struct RunState
+            {
+                const RunJob* job;
+                std::unique_ptr<DifferentialEvolution> de;
+                int iterations;
+                int generation;
+                // nodeLocal: 執行這個job的worker
+                unsigned int worker;
+            };
+
+            static unsigned int NumOfThreads(unsigned int numOfThreads)
+            {
+                if (numOfThreads == 0){
+                    numOfThreads = std::thread::hardware_concurrency();
+                }
+                return numOfThreads == 0 ? 1 : numOfThreads;
+            }
+
+            void Schedule(RunState* state)
+            {
+                if (nodeLocal){
+                    pool.SubmitTo(state->worker, [this, state]{ Step(state); });
+                }
+                else{
+                    pool.Submit([this, state]{ Step(state); });
+                }
+            }
+
+            // 執行一個generation 然後把同一個job的下一個generation排入佇列
+            void Step(RunState* state)
+            {
+                if (state->generation == 0){
+                    // optimizer在worker中建立 population由這個worker第一次寫入
+                    const RunConfig& c = state->job->config;
+                    state->de.reset(new DifferentialEvolution(
+                        *state->job->costFunction, c.populationSize, c.F, c.CR,
+                        c.RandomSeed, c.shouldCheckConstraint));
+                    state->de->InitializePopulation();
+                }
+                else{
+                    state->de->SelectAndCross();
+                }
+                if (state->generation++ < state->iterations){
+                    Schedule(state);
+                }
+            }
+
+        public:
+            /*
+                * INPUT:
+                    * numOfThreads: number of workers (0 uses the number of hardware threads)
+                    * nodeLocal: pin the workers across NUMA nodes and keep every job on one worker
+            */
+            explicit MultiRun(unsigned int numOfThreads = 0, bool nodeLocal = false) :
+                nodeLocal(nodeLocal),
+                pool(NumOfThreads(numOfThreads),
+                     nodeLocal ? CpuTopology().Placement(NumOfThreads(numOfThreads)) : std::vector<std::vector<int>>())
+            {}
+
+            ThreadPool& GetThreadPool()
+            {
+                return pool;
+            }
+
+            // Run all jobs to completion; results are in job order
+            std::vector<RunResult> Run(const std::vector<RunJob>& jobs)
+            {
+                std::vector<RunState> states(jobs.size());
+                for (size_t j = 0; j < jobs.size(); j++){
+                    assert(jobs[j].costFunction != nullptr);
+                    states[j].job = &jobs[j];
+                    states[j].iterations = jobs[j].config.iterations;
+                    states[j].generation = 0;
+                    states[j].worker = static_cast<unsigned int>(j % pool.numOfThreads());
+                }
+
+                for (auto& state : states){
+                    Schedule(&state);
+                }
+                pool.Wait();
+
+                std::vector<RunResult> results(jobs.size());
+                for (size_t j = 0; j < jobs.size(); j++){
+                    results[j].bestAgent = states[j].de->GetBestAgent();
+                    results[j].bestCost = states[j].de->GetBestCost();
+                    results[j].generations = states[j].generation - 1;
+                    results[j].evaluations = states[j].de->GetNumOfEvaluations();
+                }
+                return results;
+            }
+    };
+}
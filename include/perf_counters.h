@@ -0,0 +1,333 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <cstring>
+#include <cstdint>
+#include <cerrno>
+#include <limits>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+
+namespace DE
+{
+    // Hardware counters read by a PerfCounterGroup
+    enum class PerfCounter { Cycles, Instructions, LLCMisses, BranchMisses };
+    static const int numOfPerfCounters = 4;
+
+    /* PerfCounterGroup: user-space hardware counters of the calling thread */
+    /*
+        * The counters are opened once with perf_event_open as one group
+        * (so they are scheduled together) and run freely; a phase is
+        * measured by the difference of two Read() calls on the same thread.
+        * Values are scaled by time_enabled / time_running when the kernel
+        * multiplexes the PMU. A counter that cannot be opened (no PMU in a
+        * VM or container, perf_event_paranoid, seccomp, non-Linux) reads as
+        * NaN and Reason() tells why.
+    */
+    class PerfCounterGroup{
+        private:
+            int fds[numOfPerfCounters];
+            // 各counter在group read結果中的位置 (-1: 沒有開啟)
+            int slots[numOfPerfCounters];
+            int leader;
+            int numOfOpen;
+            std::string reason;
+
+#ifdef __linux__
+            static int Open(uint64_t config, int groupFd)
+            {
+                struct perf_event_attr attr;
+                std::memset(&attr, 0, sizeof(attr));
+                attr.size = sizeof(attr);
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = config;
+                attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+                // 只計算user space (perf_event_paranoid <= 2 時不需要權限)
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, PERF_FLAG_FD_CLOEXEC));
+            }
+#endif
+
+        public:
+            PerfCounterGroup() : leader(-1), numOfOpen(0)
+            {
+                for (int c = 0; c < numOfPerfCounters; c++){
+                    fds[c] = -1;
+                    slots[c] = -1;
+                }
+#ifdef __linux__
+                const uint64_t configs[numOfPerfCounters] = {
+                    PERF_COUNT_HW_CPU_CYCLES,
+                    PERF_COUNT_HW_INSTRUCTIONS,
+                    PERF_COUNT_HW_CACHE_MISSES,
+                    PERF_COUNT_HW_BRANCH_MISSES
+                };
+                for (int c = 0; c < numOfPerfCounters; c++){
+                    int fd = Open(configs[c], leader);
+                    if (fd < 0){
+                        int error = errno;
+                        if (reason.empty()){
+                            reason = std::string("perf_event_open: ") + std::strerror(error);
+                            if (error == EACCES || error == EPERM){
+                                reason += " (see /proc/sys/kernel/perf_event_paranoid)";
+                            }
+                            else if (error == ENOENT || error == EOPNOTSUPP){
+                                reason += " (no hardware counters, e.g. a VM or container)";
+                            }
+                        }
+                        continue;
+                    }
+                    fds[c] = fd;
+                    slots[c] = numOfOpen++;
+                    if (leader < 0){
+                        leader = fd;
+                    }
+                }
+#else
+                reason = "hardware counters require Linux perf_event_open";
+#endif
+            }
+
+            ~PerfCounterGroup()
+            {
+#ifdef __linux__
+                for (int c = 0; c < numOfPerfCounters; c++){
+                    if (fds[c] >= 0){
+                        close(fds[c]);
+                    }
+                }
+#endif
+            }
+
+            PerfCounterGroup(const PerfCounterGroup&) = delete;
+            PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+
+            // true if at least one counter is open
+            bool Available() const
+            {
+                return leader >= 0;
+            }
+
+            // Why counters are missing (empty if all are open)
+            const std::string& Reason() const
+            {
+                return reason;
+            }
+
+            // Current (scaled) counter values; NaN for the missing ones
+            void Read(double values[numOfPerfCounters]) const
+            {
+                for (int c = 0; c < numOfPerfCounters; c++){
+                    values[c] = std::numeric_limits<double>::quiet_NaN();
+                }
+#ifdef __linux__
+                if (leader < 0){
+                    return;
+                }
+                // {nr, time_enabled, time_running, value[nr]}
+                uint64_t buffer[3 + numOfPerfCounters];
+                if (read(leader, buffer, sizeof(buffer)) < static_cast<ssize_t>((3 + numOfOpen) * sizeof(uint64_t))){
+                    return;
+                }
+                double scale = buffer[2] ? static_cast<double>(buffer[1]) / static_cast<double>(buffer[2]) : 0.0;
+                for (int c = 0; c < numOfPerfCounters; c++){
+                    if (slots[c] >= 0){
+                        values[c] = static_cast<double>(buffer[3 + slots[c]]) * scale;
+                    }
+                }
+#endif
+            }
+
+            // The calling thread's group (opened on first use)
+            static PerfCounterGroup& ThisThread()
+            {
+                static thread_local PerfCounterGroup group;
+                return group;
+            }
+    };
+
+
+    // Phases of a generation measured by a PerfProfile
+    enum class ProfilePhase { TrialConstruction, Evaluation, Selection };
+    static const int numOfProfilePhases = 3;
+
+    // Totals of one phase (counters are NaN when they are not available)
+    struct PhaseCounters
+    {
+        unsigned long long calls = 0;
+        double seconds = 0.0;
+        double cycles = 0.0;
+        double instructions = 0.0;
+        double llcMisses = 0.0;
+        double branchMisses = 0.0;
+
+        // instructions per cycle
+        double IPC() const
+        {
+            return cycles > 0 ? instructions / cycles : std::numeric_limits<double>::quiet_NaN();
+        }
+
+        void Add(const PhaseCounters& other)
+        {
+            calls += other.calls;
+            seconds += other.seconds;
+            cycles += other.cycles;
+            instructions += other.instructions;
+            llcMisses += other.llcMisses;
+            branchMisses += other.branchMisses;
+        }
+    };
+
+    // Snapshot of a PerfProfile
+    struct PerfReport
+    {
+        bool countersAvailable = false;
+        std::string reason;
+        PhaseCounters trialConstruction;
+        PhaseCounters evaluation;
+        PhaseCounters selection;
+    };
+
+    /* PerfProfile: per-phase wall time and hardware counters of an optimizer */
+    /*
+        * Each thread that works on a generation measures its phases with a
+        * PhaseRecorder and adds the totals once when the recorder ends.
+        * Counters only cover the threads that run the optimizer's loops: the
+        * workers of an Evaluator are not included (their wall time is, as
+        * the Evaluation phase of the calling thread).
+    */
+    class PerfProfile{
+        private:
+            mutable std::mutex mutex;
+            PhaseCounters phases[numOfProfilePhases];
+            bool countersAvailable;
+            std::string reason;
+            bool measured;
+
+        public:
+            PerfProfile() : countersAvailable(false), measured(false)
+            {
+            }
+
+            void Add(const PhaseCounters totals[numOfProfilePhases], const PerfCounterGroup& group)
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (int p = 0; p < numOfProfilePhases; p++){
+                    phases[p].Add(totals[p]);
+                }
+                // 任何一個thread沒有counter時 整個profile視為沒有counter
+                countersAvailable = (measured ? countersAvailable : true) && group.Available();
+                if (reason.empty()){
+                    reason = group.Reason();
+                }
+                measured = true;
+            }
+
+            void Reset()
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (int p = 0; p < numOfProfilePhases; p++){
+                    phases[p] = PhaseCounters();
+                }
+                countersAvailable = false;
+                reason.clear();
+                measured = false;
+            }
+
+            PerfReport Report() const
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                PerfReport report;
+                report.countersAvailable = countersAvailable;
+                report.reason = measured ? reason : PerfCounterGroup::ThisThread().Reason();
+                report.trialConstruction = phases[static_cast<int>(ProfilePhase::TrialConstruction)];
+                report.evaluation = phases[static_cast<int>(ProfilePhase::Evaluation)];
+                report.selection = phases[static_cast<int>(ProfilePhase::Selection)];
+                return report;
+            }
+    };
+
+    /* PhaseRecorder: attributes the calling thread's time and counters to phases */
+    /*
+        * Enter(phase) ends the current phase and starts the next one with a
+        * single counter read, so a serial trial costs three reads. Totals are
+        * kept locally and added to the profile by the destructor. A recorder
+        * with a null profile does nothing.
+    */
+    class PhaseRecorder{
+        private:
+            PerfProfile* profile;
+            PerfCounterGroup* group;
+            int current;
+            std::chrono::steady_clock::time_point start;
+            double counters[numOfPerfCounters];
+            PhaseCounters totals[numOfProfilePhases];
+
+            void Close(std::chrono::steady_clock::time_point now, const double values[numOfPerfCounters])
+            {
+                PhaseCounters& t = totals[current];
+                t.calls++;
+                t.seconds += std::chrono::duration<double>(now - start).count();
+                t.cycles += values[0] - counters[0];
+                t.instructions += values[1] - counters[1];
+                t.llcMisses += values[2] - counters[2];
+                t.branchMisses += values[3] - counters[3];
+            }
+
+        public:
+            explicit PhaseRecorder(PerfProfile* profile) :
+                profile(profile),
+                group(profile ? &PerfCounterGroup::ThisThread() : nullptr),
+                current(-1)
+            {
+            }
+
+            ~PhaseRecorder()
+            {
+                Stop();
+                if (profile){
+                    profile->Add(totals, *group);
+                }
+            }
+
+            PhaseRecorder(const PhaseRecorder&) = delete;
+            PhaseRecorder& operator=(const PhaseRecorder&) = delete;
+
+            void Enter(ProfilePhase phase)
+            {
+                if (!profile || current == static_cast<int>(phase)){
+                    return;
+                }
+                double values[numOfPerfCounters];
+                group->Read(values);
+                auto now = std::chrono::steady_clock::now();
+                if (current >= 0){
+                    Close(now, values);
+                }
+                current = static_cast<int>(phase);
+                start = now;
+                std::memcpy(counters, values, sizeof(counters));
+            }
+
+            // End the current phase (Enter starts a new one)
+            void Stop()
+            {
+                if (!profile || current < 0){
+                    return;
+                }
+                double values[numOfPerfCounters];
+                group->Read(values);
+                Close(std::chrono::steady_clock::now(), values);
+                current = -1;
+            }
+    };
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+/* plugin.h: C ABI of objective plugins loaded by the DE runner */
+/*
+    * A plugin is a shared library that exports
+    *
+    *     const DEObjectivePlugin* de_objective_plugin(const char* name);
+    *
+    * returning the objective called name (NULL or "" for its default one), or
+    * NULL if it has none by that name. The returned table must stay valid
+    * until the library is unloaded. Only C types cross the boundary, so a
+    * plugin can be written in C, C++, Fortran (bind(C)), Rust, ...
+    *
+    * Per run the runner calls create(dimension, options) once, then
+    * bounds() once, evaluate() (or evaluateBatch()) for every agent and
+    * destroy() at the end. options is the runner's --options string, passed
+    * through unparsed ("" if none).
+*/
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bump when the layout of DEObjectivePlugin changes */
+#define DE_PLUGIN_ABI_VERSION 1
+
+/* evaluate/evaluateBatch may be called concurrently on the same state
+   (required for --threads > 1) */
+#define DE_PLUGIN_THREAD_SAFE 0x1u
+
+typedef struct DEObjectivePlugin
+{
+    uint32_t abiVersion;       /* DE_PLUGIN_ABI_VERSION */
+    uint32_t flags;            /* DE_PLUGIN_* */
+    const char* name;
+
+    /* New objective state for the dimension; NULL if the dimension or
+       options are not supported (the runner then reports error()). */
+    void* (*create)(unsigned int dimension, const char* options);
+    void (*destroy)(void* state);
+
+    /* lower[i], upper[i] for i < dimension; both +-INFINITY: unbounded
+       (a parameter bounded on one side only is rejected) */
+    void (*bounds)(void* state, double* lower, double* upper);
+
+    /* cost of x[0..dimension) */
+    double (*evaluate)(void* state, const double* x, unsigned int dimension);
+
+    /* Optional (NULL): costs of rows agents stored row-major in x */
+    void (*evaluateBatch)(void* state, const double* x, size_t rows, unsigned int dimension, double* costs);
+
+    /* Optional (NULL): message of the last failed create() */
+    const char* (*error)(void);
+} DEObjectivePlugin;
+
+typedef const DEObjectivePlugin* (*DEObjectivePluginEntry)(const char* name);
+
+#define DE_PLUGIN_ENTRY "de_objective_plugin"
+
+#ifdef __cplusplus
+}
+#endif
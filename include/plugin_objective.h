@@ -0,0 +1,180 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cmath>
+#include <stdexcept>
+
+#include <dlfcn.h>
+
+#include "DE.h"
+#include "plugin.h"
+
+
+
+namespace DE
+{
+    /* PluginLibrary: a shared library exporting de_objective_plugin (see plugin.h) */
+    /*
+        * The library is loaded with RTLD_LOCAL, so several plugins may
+        * define the same symbols. It is unloaded by the destructor: every
+        * PluginObjective created from it must be destroyed first.
+    */
+    class PluginLibrary{
+        private:
+            std::string path;
+            void* handle;
+            DEObjectivePluginEntry entry;
+
+        public:
+            explicit PluginLibrary(const std::string& path) : path(path), handle(nullptr), entry(nullptr)
+            {
+                handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+                if (!handle){
+                    throw std::runtime_error(std::string("PluginLibrary: cannot load ") + path + ": " + dlerror());
+                }
+                entry = reinterpret_cast<DEObjectivePluginEntry>(dlsym(handle, DE_PLUGIN_ENTRY));
+                if (!entry){
+                    dlclose(handle);
+                    throw std::runtime_error("PluginLibrary: " + path + " does not export " DE_PLUGIN_ENTRY);
+                }
+            }
+
+            ~PluginLibrary()
+            {
+                dlclose(handle);
+            }
+
+            PluginLibrary(const PluginLibrary&) = delete;
+            PluginLibrary& operator=(const PluginLibrary&) = delete;
+
+            // The objective called name ("" for the library's default one)
+            const DEObjectivePlugin& Objective(const std::string& name) const
+            {
+                const DEObjectivePlugin* plugin = entry(name.c_str());
+                if (!plugin){
+                    throw std::runtime_error("PluginLibrary: " + path + " has no objective \"" + name + "\"");
+                }
+                if (plugin->abiVersion != DE_PLUGIN_ABI_VERSION){
+                    throw std::runtime_error("PluginLibrary: " + path + " was built for plugin ABI version " +
+                                             std::to_string(plugin->abiVersion) + ", expected " +
+                                             std::to_string(DE_PLUGIN_ABI_VERSION));
+                }
+                if (!plugin->create || !plugin->destroy || !plugin->bounds || !plugin->evaluate){
+                    throw std::runtime_error("PluginLibrary: " + path + ": create, destroy, bounds and evaluate are required");
+                }
+                return *plugin;
+            }
+
+            const std::string& Path() const
+            {
+                return path;
+            }
+    };
+
+
+    /* PluginObjective: an Optimize backed by one plugin state */
+    /*
+        * A bound of +-INFINITY (or NaN) leaves the parameter unconstrained.
+        * Concurrent evaluations are only allowed if the plugin sets
+        * DE_PLUGIN_THREAD_SAFE (ThreadSafe()).
+    */
+    class PluginObjective : public Optimize
+    {
+        private:
+            const DEObjectivePlugin& plugin;
+            unsigned int dim;
+            void* state;
+            std::vector<Constraint> constraints;
+
+        public:
+            PluginObjective(const PluginLibrary& library, const std::string& name, unsigned int dimension,
+                            const std::string& options = "") :
+                plugin(library.Objective(name)),
+                dim(dimension),
+                state(nullptr)
+            {
+                state = plugin.create(dimension, options.c_str());
+                if (!state){
+                    const char* error = plugin.error ? plugin.error() : nullptr;
+                    throw std::runtime_error(std::string("PluginObjective: ") + (plugin.name ? plugin.name : "objective") +
+                                             " cannot be created for dimension " + std::to_string(dimension) +
+                                             (error ? std::string(": ") + error : std::string()));
+                }
+                std::vector<double> lower(dim, -INFINITY), upper(dim, INFINITY);
+                plugin.bounds(state, lower.data(), upper.data());
+                constraints.resize(dim);
+                for (unsigned int i = 0; i < dim; i++){
+                    // 兩邊都有限或兩邊都是+-INFINITY (半邊的box沒辦法取樣)
+                    bool bounded = std::isfinite(lower[i]) && std::isfinite(upper[i]);
+                    bool unbounded = lower[i] == -INFINITY && upper[i] == INFINITY;
+                    if (!bounded && !unbounded){
+                        plugin.destroy(state);
+                        throw std::runtime_error("PluginObjective: parameter " + std::to_string(i) + " must be bounded on both sides or on neither, got [" +
+                                                 std::to_string(lower[i]) + ", " + std::to_string(upper[i]) + "]");
+                    }
+                    if (bounded && !(lower[i] < upper[i])){
+                        plugin.destroy(state);
+                        throw std::runtime_error("PluginObjective: empty bounds for parameter " + std::to_string(i));
+                    }
+                    constraints[i] = bounded ? Constraint(lower[i], upper[i], true) : Constraint();
+                }
+            }
+
+            ~PluginObjective()
+            {
+                plugin.destroy(state);
+            }
+
+            PluginObjective(const PluginObjective&) = delete;
+            PluginObjective& operator=(const PluginObjective&) = delete;
+
+            double EvaluateCost(std::vector<double> input) const override
+            {
+                return EvaluateCostView(input);
+            }
+
+            double EvaluateCostView(VectorView input) const override
+            {
+                return plugin.evaluate(state, input.data(), input.size());
+            }
+
+            unsigned int numOfParameters() const override
+            {
+                return dim;
+            }
+
+            std::vector<Constraint> getConstraints() const override
+            {
+                return constraints;
+            }
+
+            bool ThreadSafe() const
+            {
+                return plugin.flags & DE_PLUGIN_THREAD_SAFE;
+            }
+
+            bool HasBatch() const
+            {
+                return plugin.evaluateBatch != nullptr;
+            }
+
+            // Row-major batch through evaluateBatch (or evaluate row by row)
+            void EvaluateRows(const double* x, size_t rows, double* costs) const
+            {
+                if (plugin.evaluateBatch){
+                    plugin.evaluateBatch(state, x, rows, dim, costs);
+                    return;
+                }
+                for (size_t r = 0; r < rows; r++){
+                    costs[r] = plugin.evaluate(state, x + r * dim, dim);
+                }
+            }
+
+            const char* Name() const
+            {
+                return plugin.name ? plugin.name : "";
+            }
+    };
+}
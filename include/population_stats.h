@@ -0,0 +1,366 @@
+#pragma once
+
+#include <vector>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+
+
+namespace DE
+{
+    /* PopulationStatistics: population statistics maintained on every replacement */
+    /*
+        * Centroid and per-dimension variance are kept as sums of (x - center)
+        * and (x - center)^2 and updated in O(dim) when one individual replaces
+        * another (the population size is fixed); the cost mean and spread in
+        * O(1). Shifting by a center close to the population keeps the
+        * variance accurate when it is tiny compared with the centroid (a
+        * converged population): a dimension whose centroid has moved away
+        * from its center by more than its spread is re-centered in
+        * O(populationSize). The bounding box and the cost extremes are only
+        * rescanned when an extreme value was removed, and only when they are
+        * read. Costs that are not finite (infeasible individuals) are left
+        * out of the cost statistics.
+        * The update loops run over contiguous arrays without dependencies
+        * between dimensions, so the compiler vectorizes them.
+        * Real is the storage type of the population (float or double); the
+        * sums are always accumulated in double.
+    */
+    template <class Real = double>
+    class BasicPopulationStatistics{
+
+        private:
+            unsigned int dim;
+            const std::vector<std::vector<Real>>* population;
+            const std::vector<double>* costs;
+            // 每個維度的center 以及 sum(x - center), sum((x - center)^2)
+            std::vector<double> center;
+            std::vector<double> s1;
+            std::vector<double> s2;
+            // bounding box 以及需要重新掃描的維度
+            mutable std::vector<double> lower;
+            mutable std::vector<double> upper;
+            mutable std::vector<char> stale;
+            mutable bool anyStale;
+            mutable std::vector<double> mean;
+            mutable std::vector<double> variance;
+            // finite cost: 數量 center sums 以及極值
+            unsigned int numOfFinite;
+            double costCenter;
+            double costS1;
+            double costS2;
+            mutable double costMin;
+            mutable double costMax;
+            mutable bool costStale;
+            // 重新center的次數
+            unsigned long long numOfRecenters;
+
+            // 以目前的平均作為維度i的新center O(populationSize)
+            void Recenter(unsigned int i)
+            {
+                const std::vector<std::vector<Real>>& P = *population;
+                double c = center[i] + s1[i] / P.size();
+                double a = 0;
+                double b = 0;
+                for (const auto& x : P){
+                    double d = x[i] - c;
+                    a += d;
+                    b += d * d;
+                }
+                center[i] = c;
+                s1[i] = a;
+                s2[i] = b;
+                numOfRecenters++;
+            }
+
+            void RecenterCost()
+            {
+                costCenter = numOfFinite ? costCenter + costS1 / numOfFinite : 0.0;
+                costS1 = 0;
+                costS2 = 0;
+                for (double c : *costs){
+                    if (std::isfinite(c)){
+                        double d = c - costCenter;
+                        costS1 += d;
+                        costS2 += d * d;
+                    }
+                }
+            }
+
+            // 平均離center太遠(超過spread)時 加總會失去精度
+            static bool Drifted(double sum, double sumSq, double n)
+            {
+                return 2 * sum * sum > sumSq * n;
+            }
+
+            void RescanBox() const
+            {
+                const std::vector<std::vector<Real>>& P = *population;
+                for (unsigned int i = 0; i < dim; i++){
+                    if (!stale[i]){
+                        continue;
+                    }
+                    double lo = std::numeric_limits<double>::infinity();
+                    double hi = -std::numeric_limits<double>::infinity();
+                    for (const auto& x : P){
+                        lo = std::min(lo, static_cast<double>(x[i]));
+                        hi = std::max(hi, static_cast<double>(x[i]));
+                    }
+                    lower[i] = lo;
+                    upper[i] = hi;
+                    stale[i] = 0;
+                }
+                anyStale = false;
+            }
+
+            void RescanCost() const
+            {
+                costMin = std::numeric_limits<double>::infinity();
+                costMax = -std::numeric_limits<double>::infinity();
+                for (double c : *costs){
+                    if (std::isfinite(c)){
+                        costMin = std::min(costMin, c);
+                        costMax = std::max(costMax, c);
+                    }
+                }
+                costStale = false;
+            }
+
+        public:
+            BasicPopulationStatistics() :
+                dim(0),
+                population(nullptr),
+                costs(nullptr),
+                anyStale(false),
+                numOfFinite(0),
+                costCenter(0),
+                costS1(0),
+                costS2(0),
+                costMin(0),
+                costMax(0),
+                costStale(false),
+                numOfRecenters(0)
+            {}
+
+            // Full O(populationSize * dim) computation; keeps pointers to both vectors
+            void Reset(const std::vector<std::vector<Real>>& agents, const std::vector<double>& agentCosts)
+            {
+                assert(!agents.empty());
+                population = &agents;
+                costs = &agentCosts;
+                dim = static_cast<unsigned int>(agents[0].size());
+
+                // center = 第一個individuals 再以平均重新center
+                center.assign(agents[0].begin(), agents[0].end());
+                s1.assign(dim, 0.0);
+                s2.assign(dim, 0.0);
+                for (const auto& x : agents){
+                    const Real* xp = x.data();
+                    const double* cp = center.data();
+                    double* ap = s1.data();
+                    for (unsigned int i = 0; i < dim; i++){
+                        ap[i] += xp[i] - cp[i];
+                    }
+                }
+                for (unsigned int i = 0; i < dim; i++){
+                    Recenter(i);
+                }
+                numOfRecenters = 0;
+
+                lower.assign(dim, 0.0);
+                upper.assign(dim, 0.0);
+                stale.assign(dim, 1);
+                anyStale = true;
+
+                numOfFinite = 0;
+                costCenter = 0;
+                for (double c : agentCosts){
+                    if (std::isfinite(c)){
+                        numOfFinite++;
+                        costCenter += (c - costCenter) / numOfFinite;
+                    }
+                }
+                costS1 = 0;
+                RecenterCost();
+                costStale = true;
+            }
+
+            // Call after an individual (oldAgent, oldCost) has been replaced by (newAgent, newCost)
+            // in the population and cost vectors passed to Reset
+            void Replaced(const std::vector<Real>& oldAgent, const std::vector<Real>& newAgent,
+                          double oldCost, double newCost)
+            {
+                assert(population && oldAgent.size() == dim && newAgent.size() == dim);
+                double n = static_cast<double>(population->size());
+                const Real* op = oldAgent.data();
+                const Real* np = newAgent.data();
+                const double* cp = center.data();
+                double* ap = s1.data();
+                double* bp = s2.data();
+                double* lo = lower.data();
+                double* hi = upper.data();
+                bool drifted = false;
+                for (unsigned int i = 0; i < dim; i++){
+                    double a = np[i] - cp[i];
+                    double b = op[i] - cp[i];
+                    ap[i] += a - b;
+                    bp[i] += a * a - b * b;
+                    drifted |= Drifted(ap[i], bp[i], n);
+                    // bounding box: 移除的值是極值時之後重新掃描
+                    lo[i] = std::min(lo[i], static_cast<double>(np[i]));
+                    hi[i] = std::max(hi[i], static_cast<double>(np[i]));
+                }
+                for (unsigned int i = 0; i < dim; i++){
+                    if (op[i] != np[i] && (op[i] == lo[i] || op[i] == hi[i])){
+                        stale[i] = 1;
+                        anyStale = true;
+                    }
+                }
+                if (drifted){
+                    for (unsigned int i = 0; i < dim; i++){
+                        if (Drifted(s1[i], s2[i], n)){
+                            Recenter(i);
+                        }
+                    }
+                }
+
+                // cost
+                bool oldFinite = std::isfinite(oldCost);
+                bool newFinite = std::isfinite(newCost);
+                if (oldFinite){
+                    double b = oldCost - costCenter;
+                    costS1 -= b;
+                    costS2 -= b * b;
+                    numOfFinite--;
+                    if (oldCost == costMin || oldCost == costMax){
+                        costStale = true;
+                    }
+                }
+                if (newFinite){
+                    double a = newCost - costCenter;
+                    costS1 += a;
+                    costS2 += a * a;
+                    numOfFinite++;
+                    if (!costStale){
+                        costMin = std::min(costMin, newCost);
+                        costMax = std::max(costMax, newCost);
+                    }
+                }
+                if ((oldFinite || newFinite) && numOfFinite && Drifted(costS1, costS2, numOfFinite)){
+                    RecenterCost();
+                }
+            }
+
+            // Recompute everything from the current population
+            void Refresh()
+            {
+                Reset(*population, *costs);
+            }
+
+            unsigned int numOfParameters() const
+            {
+                return dim;
+            }
+
+            // Number of O(populationSize) re-centerings since the last Reset
+            unsigned long long numOfRecenterings() const
+            {
+                return numOfRecenters;
+            }
+
+            const std::vector<double>& Centroid() const
+            {
+                mean.resize(dim);
+                double invN = population ? 1.0 / static_cast<double>(population->size()) : 0.0;
+                for (unsigned int i = 0; i < dim; i++){
+                    mean[i] = center[i] + s1[i] * invN;
+                }
+                return mean;
+            }
+
+            // Population variance of every dimension
+            const std::vector<double>& Variance() const
+            {
+                variance.resize(dim);
+                double invN = population ? 1.0 / static_cast<double>(population->size()) : 0.0;
+                for (unsigned int i = 0; i < dim; i++){
+                    double m = s1[i] * invN;
+                    variance[i] = std::max(0.0, s2[i] * invN - m * m);
+                }
+                return variance;
+            }
+
+            // Mean standard deviation over the dimensions (a diversity measure)
+            double MeanStd() const
+            {
+                const std::vector<double>& v = Variance();
+                double s = 0;
+                for (unsigned int i = 0; i < dim; i++){
+                    s += std::sqrt(v[i]);
+                }
+                return dim ? s / dim : 0.0;
+            }
+
+            const std::vector<double>& Lower() const
+            {
+                if (anyStale){
+                    RescanBox();
+                }
+                return lower;
+            }
+
+            const std::vector<double>& Upper() const
+            {
+                if (anyStale){
+                    RescanBox();
+                }
+                return upper;
+            }
+
+            // Cost statistics over the individuals with a finite cost
+            unsigned int numOfFiniteCosts() const
+            {
+                return numOfFinite;
+            }
+
+            double MeanCost() const
+            {
+                return numOfFinite ? costCenter + costS1 / numOfFinite : std::numeric_limits<double>::quiet_NaN();
+            }
+
+            double CostStd() const
+            {
+                if (!numOfFinite){
+                    return std::numeric_limits<double>::quiet_NaN();
+                }
+                double m = costS1 / numOfFinite;
+                return std::sqrt(std::max(0.0, costS2 / numOfFinite - m * m));
+            }
+
+            double MinCost() const
+            {
+                if (costStale){
+                    RescanCost();
+                }
+                return numOfFinite ? costMin : std::numeric_limits<double>::quiet_NaN();
+            }
+
+            double MaxCost() const
+            {
+                if (costStale){
+                    RescanCost();
+                }
+                return numOfFinite ? costMax : std::numeric_limits<double>::quiet_NaN();
+            }
+
+            // Cost spread: MaxCost() - MinCost()
+            double CostRange() const
+            {
+                return MaxCost() - MinCost();
+            }
+    };
+
+    using PopulationStatistics = BasicPopulationStatistics<double>;
+}
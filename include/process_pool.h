@@ -0,0 +1,358 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <new>
+#include <limits>
+#include <cassert>
+#include <functional>
+#include <stdexcept>
+#include <thread>
+#include <chrono>
+#include <cerrno>
+
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/prctl.h>
+#endif
+
+#include "DE.h"
+#include "ring.h"
+
+
+
+namespace DE
+{
+    /* ProcessPoolEvaluator: evaluate batches in forked worker processes */
+    /*
+        * Every worker is forked from the current process and therefore holds
+        * its own copy of the objective. Each worker has a request ring (trial
+        * vectors) and a response ring (costs) in an anonymous shared mapping;
+        * nothing is serialized and no sockets are involved.
+        * Construct the pool before starting any other thread in the process:
+        * only the forking thread exists in the children.
+        * If a worker dies, the rings may hold requests that are never answered
+        * and responses of the interrupted batch: the remaining workers are
+        * stopped and every later EvaluateBatch throws immediately.
+        * Workers exit when the parent process dies (also by SIGKILL): on Linux
+        * they are killed with it (PR_SET_PDEATHSIG, which fires when the
+        * forking thread exits, so construct the pool in a thread that outlives
+        * it), elsewhere an idle worker notices it has been reparented.
+    */
+    class ProcessPoolEvaluator : public Evaluator
+    {
+        private:
+            // response slot
+            struct Response
+            {
+                uint64_t id;
+                uint64_t failed;
+                double cost;
+            };
+
+            // 每個worker的控制區塊
+            struct Control
+            {
+                std::atomic<uint32_t> stop;
+            };
+
+            const Optimize& costFunction;
+            unsigned int dim;
+            unsigned int numOfWorkers;
+            unsigned int queueDepth;
+            size_t requestBytes;
+            size_t channelBytes;
+            void* memory;
+            size_t memoryBytes;
+            Control* control;
+            std::vector<SharedRing> requests;
+            std::vector<SharedRing> responses;
+            std::vector<pid_t> workers;
+            // 每個worker目前還沒回傳的request數量
+            std::vector<unsigned int> outstanding;
+            // a worker died: the pool cannot be used anymore
+            bool broken;
+            // process that forked the workers
+            pid_t parentPid;
+
+            static size_t Align(size_t bytes)
+            {
+                return (bytes + 63) / 64 * 64;
+            }
+
+            // 等待時先讓出CPU 等太久就短暫睡眠 避免idle worker佔滿CPU
+            static void Backoff(unsigned int& idle)
+            {
+                if (++idle < 1024){
+                    std::this_thread::yield();
+                }
+                else{
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                }
+            }
+
+            // 在worker中: parent已經結束(被reparent)就離開 只在idle睡眠時檢查
+            void ExitIfOrphaned(unsigned int idle) const
+            {
+                if (idle >= 1024 && getppid() != parentPid){
+                    _exit(0);
+                }
+            }
+
+            // Worker process main loop: never returns
+            void WorkerLoop(unsigned int w)
+            {
+                SharedRing& in = requests[w];
+                SharedRing& out = responses[w];
+                unsigned int idle = 0;
+                for (;;){
+                    const unsigned char* slot = in.BeginPop();
+                    if (!slot){
+                        if (control->stop.load(std::memory_order_acquire)){
+                            _exit(0);
+                        }
+                        ExitIfOrphaned(idle);
+                        Backoff(idle);
+                        continue;
+                    }
+                    idle = 0;
+                    Response r;
+                    std::memcpy(&r.id, slot, sizeof(uint64_t));
+
+                    // 直接在shared memory中evaluation trial 不複製
+                    r.failed = 0;
+                    try{
+                        r.cost = costFunction.EvaluateCostView(
+                            VectorView(reinterpret_cast<const double*>(slot + sizeof(uint64_t)), dim));
+                    }
+                    catch (...){
+                        r.failed = 1;
+                        r.cost = std::numeric_limits<double>::quiet_NaN();
+                    }
+                    in.EndPop();
+
+                    // response ring has queueDepth slots, the parent never has more outstanding
+                    unsigned char* dst;
+                    while (!(dst = out.BeginPush())){
+                        ExitIfOrphaned(idle);
+                        Backoff(idle);
+                    }
+                    std::memcpy(dst, &r, sizeof(Response));
+                    out.EndPush();
+                }
+            }
+
+            // 檢查是否有worker已經結束(crash)
+            void CheckWorkers()
+            {
+                for (pid_t& pid : workers){
+                    int status;
+                    if (pid <= 0){
+                        continue;
+                    }
+                    pid_t result = waitpid(pid, &status, WNOHANG);
+                    // ECHILD: already reaped elsewhere (e.g. a SIGCHLD handler)
+                    if (result == pid || (result < 0 && errno == ECHILD)){
+                        pid = -1;
+                        Fail("ProcessPoolEvaluator: a worker process exited unexpectedly");
+                    }
+                }
+            }
+
+            // 停掉其他worker並丟棄ring中未完成的狀態 之後的呼叫直接throw
+            [[noreturn]] void Fail(const std::string& message)
+            {
+                broken = true;
+                for (pid_t& pid : workers){
+                    if (pid > 0){
+                        int status;
+                        kill(pid, SIGKILL);
+                        waitpid(pid, &status, 0);
+                        pid = -1;
+                    }
+                }
+                std::fill(outstanding.begin(), outstanding.end(), 0);
+                throw std::runtime_error(message);
+            }
+
+            void Shutdown()
+            {
+                if (control){
+                    control->stop.store(1, std::memory_order_release);
+                }
+                for (pid_t pid : workers){
+                    if (pid > 0){
+                        int status;
+                        waitpid(pid, &status, 0);
+                    }
+                }
+                workers.clear();
+                if (memory){
+                    munmap(memory, memoryBytes);
+                    memory = nullptr;
+                    control = nullptr;
+                }
+            }
+
+        public:
+            /*
+                * INPUT:
+                    * costFunction: objective copied into every worker by fork()
+                    * numOfWorkers: number of worker processes
+                    * queueDepth: maximum number of trials queued per worker
+                    * onWorkerStart: called in each child right after fork()
+                        (for example to reset interpreter state)
+            */
+            ProcessPoolEvaluator(
+                const Optimize& costFunction,
+                unsigned int numOfWorkers,
+                unsigned int queueDepth = 4,
+                std::function<void()> onWorkerStart = nullptr
+            ):
+                costFunction(costFunction),
+                dim(costFunction.numOfParameters()),
+                numOfWorkers(numOfWorkers),
+                queueDepth(queueDepth),
+                memory(nullptr),
+                memoryBytes(0),
+                control(nullptr),
+                broken(false),
+                parentPid(getpid())
+            {
+                assert(numOfWorkers > 0 && "At least one worker");
+                assert(queueDepth > 0 && "Queue depth must be positive");
+
+                // Shared mapping: [Control][request ring][response ring] per worker
+                requestBytes = sizeof(uint64_t) + dim * sizeof(double);
+                channelBytes = Align(SharedRing::Bytes(queueDepth, requestBytes))
+                             + Align(SharedRing::Bytes(queueDepth, sizeof(Response)));
+                memoryBytes = Align(sizeof(Control)) + channelBytes * numOfWorkers;
+                memory = mmap(nullptr, memoryBytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+                if (memory == MAP_FAILED){
+                    memory = nullptr;
+                    throw std::runtime_error("ProcessPoolEvaluator: mmap failed");
+                }
+                control = new (memory) Control();
+                control->stop.store(0, std::memory_order_relaxed);
+
+                unsigned char* base = static_cast<unsigned char*>(memory) + Align(sizeof(Control));
+                for (unsigned int w = 0; w < numOfWorkers; w++){
+                    unsigned char* channel = base + channelBytes * w;
+                    requests.emplace_back(channel, queueDepth, requestBytes);
+                    responses.emplace_back(channel + Align(SharedRing::Bytes(queueDepth, requestBytes)),
+                                           queueDepth, sizeof(Response));
+                }
+                outstanding.assign(numOfWorkers, 0);
+
+                // fork the workers
+                for (unsigned int w = 0; w < numOfWorkers; w++){
+                    pid_t pid = fork();
+                    if (pid < 0){
+                        Shutdown();
+                        throw std::runtime_error("ProcessPoolEvaluator: fork failed");
+                    }
+                    if (pid == 0){
+#ifdef __linux__
+                        prctl(PR_SET_PDEATHSIG, SIGKILL);
+#endif
+                        // the parent may have died before prctl
+                        if (getppid() != parentPid){
+                            _exit(0);
+                        }
+                        if (onWorkerStart){
+                            onWorkerStart();
+                        }
+                        WorkerLoop(w);
+                    }
+                    workers.push_back(pid);
+                }
+            }
+
+            ~ProcessPoolEvaluator()
+            {
+                Shutdown();
+            }
+
+            ProcessPoolEvaluator(const ProcessPoolEvaluator&) = delete;
+            ProcessPoolEvaluator& operator=(const ProcessPoolEvaluator&) = delete;
+
+            unsigned int numOfProcesses() const
+            {
+                return numOfWorkers;
+            }
+
+            void EvaluateBatch(const std::vector<std::vector<double>>& agents, std::vector<double>& costs) override
+            {
+                if (broken){
+                    throw std::runtime_error("ProcessPoolEvaluator: unusable after a worker process exited");
+                }
+                costs.resize(agents.size());
+                size_t sent = 0;
+                size_t received = 0;
+                bool failed = false;
+                unsigned int idle = 0;
+
+                while (received < agents.size()){
+                    bool progress = false;
+
+                    // 輪流把trial分給有空位的worker
+                    for (unsigned int w = 0; w < numOfWorkers && sent < agents.size(); w++){
+                        if (outstanding[w] == queueDepth){
+                            continue;
+                        }
+                        unsigned char* slot = requests[w].BeginPush();
+                        assert(slot != nullptr);
+                        assert(agents[sent].size() == dim);
+                        uint64_t id = sent;
+                        std::memcpy(slot, &id, sizeof(uint64_t));
+                        std::memcpy(slot + sizeof(uint64_t), agents[sent].data(), dim * sizeof(double));
+                        requests[w].EndPush();
+                        outstanding[w]++;
+                        sent++;
+                        progress = true;
+                    }
+
+                    // 收回已經完成的cost
+                    for (unsigned int w = 0; w < numOfWorkers; w++){
+                        const unsigned char* slot;
+                        while ((slot = responses[w].BeginPop())){
+                            Response r;
+                            std::memcpy(&r, slot, sizeof(Response));
+                            responses[w].EndPop();
+                            if (r.id >= agents.size() || outstanding[w] == 0){
+                                Fail("ProcessPoolEvaluator: unexpected response from a worker");
+                            }
+                            costs[r.id] = r.cost;
+                            failed = failed || r.failed;
+                            outstanding[w]--;
+                            received++;
+                            progress = true;
+                        }
+                    }
+
+                    if (progress){
+                        idle = 0;
+                    }
+                    else{
+                        if (idle % 1024 == 1023){
+                            CheckWorkers();
+                        }
+                        Backoff(idle);
+                    }
+                }
+
+                if (failed){
+                    throw std::runtime_error("ProcessPoolEvaluator: the objective raised an error in a worker");
+                }
+            }
+    };
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+
+
+
+namespace DE
+{
+    /* StreamRandom: counter-based random stream for one (seed, generation, index) */
+    /*
+        * The state is derived only from the three keys, so the numbers an
+        * individual draws in a generation do not depend on which thread
+        * builds its trial or in which order. It is a SplitMix64 generator
+        * and satisfies UniformRandomBitGenerator, so the std distributions
+        * can be used with it.
+    */
+    class StreamRandom{
+        private:
+            uint64_t state;
+
+            static uint64_t Mix(uint64_t z)
+            {
+                z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+                return z ^ (z >> 31);
+            }
+
+        public:
+            using result_type = uint64_t;
+
+            StreamRandom(uint64_t seed, uint64_t generation, uint64_t index)
+            {
+                // 每個key各混合一次 避免(seed, gen, idx)的線性組合互相碰撞
+                state = Mix(Mix(Mix(seed) + generation) + index);
+            }
+
+            static constexpr result_type min()
+            {
+                return 0;
+            }
+
+            static constexpr result_type max()
+            {
+                return std::numeric_limits<result_type>::max();
+            }
+
+            result_type operator()()
+            {
+                state += 0x9e3779b97f4a7c15ULL;
+                return Mix(state);
+            }
+    };
+}
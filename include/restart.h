@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cassert>
+
+
+
+namespace DE
+{
+    // How the population size changes from one restart to the next
+    /*
+        * IPOP: every restart multiplies the population size by populationFactor.
+        * BIPOP: alternates between the IPOP sequence (large regime) and runs
+        *   with a random population size between 4 and half of the next
+        *   large size (small regime); the regime that has used fewer
+        *   evaluations so far runs next.
+    */
+    enum class RestartStrategy { IPOP, BIPOP };
+
+    // Stagnation criterion that triggered a restart
+    enum class RestartReason { NoImprovement, LowDiversity, FlatCosts };
+
+    /* RestartConfig: stagnation criteria and population growth for restarts */
+    struct RestartConfig
+    {
+        RestartStrategy strategy;
+        // 多少個generation內最好的cost沒有(相對)改善就restart (0: 不檢查)
+        unsigned int stagnationGenerations;
+        // 相對改善量小於這個值不算改善
+        double improvementTolerance;
+        // 平均標準差 / (restart時的平均標準差) 小於這個值就restart (0: 不檢查)
+        double diversityTolerance;
+        // cost的範圍小於costTolerance * (1 + |min cost|)就restart (0: 不檢查)
+        double costTolerance;
+        // IPOP (large regime) 每次restart放大population的倍數
+        double populationFactor;
+        // population大小上限 (0: 無上限)
+        unsigned int maxPopulationSize;
+        // 最多restart幾次 (0: 無上限; 預設9次 IPOP的population最多放大到2^9倍)
+        unsigned int maxRestarts;
+
+        RestartConfig(RestartStrategy strategy = RestartStrategy::IPOP,
+                      unsigned int stagnationGenerations = 50,
+                      double improvementTolerance = 1e-12,
+                      double diversityTolerance = 1e-8,
+                      double costTolerance = 1e-12,
+                      double populationFactor = 2.0,
+                      unsigned int maxPopulationSize = 0,
+                      unsigned int maxRestarts = 9) :
+            strategy(strategy),
+            stagnationGenerations(stagnationGenerations),
+            improvementTolerance(improvementTolerance),
+            diversityTolerance(diversityTolerance),
+            costTolerance(costTolerance),
+            populationFactor(populationFactor),
+            maxPopulationSize(maxPopulationSize),
+            maxRestarts(maxRestarts)
+        {
+            assert(populationFactor >= 1.0 && "The population must not shrink in the large regime");
+            assert(improvementTolerance >= 0 && diversityTolerance >= 0 && costTolerance >= 0);
+        }
+    };
+
+    /* RestartRecord: one restart of the population */
+    struct RestartRecord
+    {
+        // generation at which the stagnated population was replaced
+        unsigned int generation;
+        // number of real evaluations before the restart
+        unsigned long long evaluations;
+        unsigned int oldPopulationSize;
+        unsigned int newPopulationSize;
+        // best cost of the stagnated population
+        double bestCost;
+        RestartReason reason;
+    };
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <new>
+
+
+
+namespace DE
+{
+    /* SharedRing: single-producer single-consumer ring of fixed-size slots */
+    /*
+        * head is only written by the producer and tail only by the consumer,
+        * so the two sides never share a cache line that both of them write.
+        * The ring lives in caller-provided memory. It also works across
+        * processes in a shared mapping because the std::atomic counters are
+        * lock-free (address-free) and the slots are plain bytes.
+    */
+    class SharedRing{
+        private:
+            struct Header
+            {
+                std::atomic<uint64_t> head;
+                char padHead[64 - sizeof(std::atomic<uint64_t>)];
+                std::atomic<uint64_t> tail;
+                char padTail[64 - sizeof(std::atomic<uint64_t>)];
+            };
+
+            Header* header;
+            unsigned char* slots;
+            uint64_t capacity;
+            size_t slotBytes;
+
+        public:
+            static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "Shared-memory rings need lock-free 64-bit atomics");
+
+            // bytes needed in the shared mapping for a ring
+            static size_t Bytes(uint64_t capacity, size_t slotBytes)
+            {
+                return sizeof(Header) + capacity * slotBytes;
+            }
+
+            SharedRing() : header(nullptr), slots(nullptr), capacity(0), slotBytes(0) {}
+
+            // memory must hold at least Bytes(capacity, slotBytes) bytes, 8-byte aligned
+            SharedRing(void* memory, uint64_t capacity, size_t slotBytes) :
+                header(new (memory) Header()),
+                slots(static_cast<unsigned char*>(memory) + sizeof(Header)),
+                capacity(capacity),
+                slotBytes(slotBytes)
+            {
+                header->head.store(0, std::memory_order_relaxed);
+                header->tail.store(0, std::memory_order_relaxed);
+            }
+
+            // Producer: slot to fill, or nullptr if the ring is full
+            unsigned char* BeginPush()
+            {
+                uint64_t head = header->head.load(std::memory_order_relaxed);
+                if (head - header->tail.load(std::memory_order_acquire) == capacity){
+                    return nullptr;
+                }
+                return slots + (head % capacity) * slotBytes;
+            }
+            void EndPush()
+            {
+                header->head.store(header->head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            }
+
+            // Consumer: slot to read, or nullptr if the ring is empty
+            const unsigned char* BeginPop()
+            {
+                uint64_t tail = header->tail.load(std::memory_order_relaxed);
+                if (tail == header->head.load(std::memory_order_acquire)){
+                    return nullptr;
+                }
+                return slots + (tail % capacity) * slotBytes;
+            }
+            void EndPop()
+            {
+                header->tail.store(header->tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            }
+    };
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <vector>
+#include <cassert>
+#include <cmath>
+#include <limits>
+
+
+
+namespace DE
+{
+    /* Surrogate model: online k-nearest-neighbour regression */
+    /*
+        * The model keeps a bounded archive of (vector, cost) pairs that the
+        * optimizer has really evaluated. Add() is O(dim) and Predict() is
+        * O(archiveSize * dim), so the cost of one prediction is fixed by the
+        * archive size and never grows with the length of the run.
+        * The oldest pair is overwritten once the archive is full.
+    */
+    class SurrogateModel{
+
+        private:
+            unsigned int dim;
+            unsigned int capacity;
+            unsigned int neighbours;
+            // 已存入archive的點數 以及下一個要覆寫的位置
+            unsigned int count;
+            unsigned int next;
+            // archive: capacity x dim 攤平成一維
+            std::vector<double> points;
+            std::vector<double> costs;
+            // 每個維度的縮放 讓範圍大的維度不會主導距離
+            std::vector<double> scale;
+
+        public:
+            /*
+                * INPUT:
+                    * dim: number of parameters of the objective
+                    * capacity: maximum number of archived points
+                    * neighbours: number of neighbours used for a prediction
+            */
+            SurrogateModel(unsigned int dim, unsigned int capacity = 256, unsigned int neighbours = 5) :
+                dim(dim),
+                capacity(capacity),
+                neighbours(neighbours),
+                count(0),
+                next(0),
+                points(static_cast<size_t>(capacity) * dim),
+                costs(capacity),
+                scale(dim, 1.0)
+            {
+                assert(dim > 0 && "Dimension must be greater than 0");
+                assert(capacity >= neighbours && "Archive must hold at least one neighbourhood");
+                assert(neighbours > 0 && "Surrogate needs at least one neighbour");
+            }
+
+            // 設定每個維度的寬度(upper - lower) 沒有範圍的維度保持1.0
+            void SetScale(const std::vector<double>& widths)
+            {
+                assert(widths.size() == dim);
+                for (unsigned int i = 0; i < dim; i++){
+                    scale[i] = (widths[i] > 0 && std::isfinite(widths[i])) ? 1.0 / widths[i] : 1.0;
+                }
+            }
+
+            // Add one evaluated point to the archive -- O(dim)
+            void Add(const std::vector<double>& x, double cost)
+            {
+                assert(x.size() == dim);
+                // 不把nan或inf的cost放進模型 否則預測會被污染
+                if (!std::isfinite(cost)){
+                    return;
+                }
+                double* p = &points[static_cast<size_t>(next) * dim];
+                for (unsigned int i = 0; i < dim; i++){
+                    p[i] = x[i];
+                }
+                costs[next] = cost;
+                next = (next + 1) % capacity;
+                if (count < capacity){
+                    count++;
+                }
+            }
+
+            // Forget every archived point (e.g. the objective has changed)
+            void Clear()
+            {
+                count = 0;
+                next = 0;
+            }
+
+            // 模型是否已經有足夠的點可以預測
+            bool Ready() const
+            {
+                return count >= neighbours;
+            }
+
+            unsigned int Size() const
+            {
+                return count;
+            }
+
+            // Predict the cost of x by inverse-distance weighting of its nearest neighbours
+            double Predict(const std::vector<double>& x) const
+            {
+                assert(x.size() == dim);
+                assert(Ready());
+
+                // 目前找到最近的neighbours個點 依距離由小到大排列
+                std::vector<double> bestDist(neighbours, std::numeric_limits<double>::infinity());
+                std::vector<unsigned int> bestIndex(neighbours, 0);
+
+                for (unsigned int j = 0; j < count; j++){
+                    const double* p = &points[static_cast<size_t>(j) * dim];
+                    double d2 = 0;
+                    for (unsigned int i = 0; i < dim; i++){
+                        double diff = (x[i] - p[i]) * scale[i];
+                        d2 += diff * diff;
+                    }
+                    if (d2 >= bestDist[neighbours - 1]){
+                        continue;
+                    }
+                    // insertion into the sorted neighbour list
+                    unsigned int pos = neighbours - 1;
+                    while (pos > 0 && bestDist[pos - 1] > d2){
+                        bestDist[pos] = bestDist[pos - 1];
+                        bestIndex[pos] = bestIndex[pos - 1];
+                        pos--;
+                    }
+                    bestDist[pos] = d2;
+                    bestIndex[pos] = j;
+                }
+
+                // 如果x和archive中的點重合 直接回傳該點的cost
+                if (bestDist[0] <= 0){
+                    return costs[bestIndex[0]];
+                }
+
+                double weightSum = 0;
+                double value = 0;
+                for (unsigned int n = 0; n < neighbours; n++){
+                    double w = 1.0 / bestDist[n];
+                    weightSum += w;
+                    value += w * costs[bestIndex[n]];
+                }
+                return value / weightSum;
+            }
+    };
+}
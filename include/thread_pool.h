@@ -0,0 +1,228 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <exception>
+#include <cassert>
+#include <algorithm>
+
+#include "topology.h"
+
+
+
+namespace DE
+{
+    /* ThreadPool: fixed set of worker threads sharing one FIFO task queue */
+    /*
+        * Tasks may submit further tasks. Wait() returns once the queue is
+        * empty and no task is running, and rethrows the first exception a
+        * task has thrown since the previous Wait().
+        * Workers can be pinned to CPU sets (see CpuTopology::Placement); a
+        * pinned worker also allocates its new pages on its own NUMA node, so
+        * memory it touches first stays local. SubmitTo() queues a task for
+        * one particular worker, which is how per-worker data is first-touched.
+    */
+    class ThreadPool{
+        private:
+            std::vector<std::thread> workers;
+            std::deque<std::function<void()>> tasks;
+            // 指定給某個worker的task
+            std::vector<std::deque<std::function<void()>>> local;
+            // 每個worker固定的CPU (空的代表不固定)
+            std::vector<std::vector<int>> cpuSets;
+            std::mutex mutex;
+            std::condition_variable taskReady;
+            std::condition_variable allDone;
+            // 正在執行的task數量
+            unsigned int active;
+            bool stopping;
+            std::exception_ptr error;
+
+            static int& WorkerIndex()
+            {
+                static thread_local int index = -1;
+                return index;
+            }
+
+            bool Idle() const
+            {
+                if (active != 0 || !tasks.empty()){
+                    return false;
+                }
+                for (const auto& q : local){
+                    if (!q.empty()){
+                        return false;
+                    }
+                }
+                return true;
+            }
+
+            void WorkerLoop(unsigned int w)
+            {
+                WorkerIndex() = static_cast<int>(w);
+                if (!cpuSets[w].empty() && PinCurrentThread(cpuSets[w])){
+                    SetLocalMemoryPolicy();
+                }
+                for (;;){
+                    std::function<void()> task;
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        taskReady.wait(lock, [this, w]{ return stopping || !tasks.empty() || !local[w].empty(); });
+                        // 先執行指定給自己的task
+                        std::deque<std::function<void()>>& queue = local[w].empty() ? tasks : local[w];
+                        if (queue.empty()){
+                            return;
+                        }
+                        task = std::move(queue.front());
+                        queue.pop_front();
+                        active++;
+                    }
+
+                    try{
+                        task();
+                    }
+                    catch (...){
+                        std::lock_guard<std::mutex> lock(mutex);
+                        if (!error){
+                            error = std::current_exception();
+                        }
+                    }
+
+                    std::lock_guard<std::mutex> lock(mutex);
+                    active--;
+                    if (Idle()){
+                        allDone.notify_all();
+                    }
+                }
+            }
+
+        public:
+            /*
+                * INPUT:
+                    * numOfThreads: number of workers (0 uses the number of hardware threads)
+                    * cpuSets: CPUs of each worker, cpuSets[i % size] for worker i
+                        (empty: workers are not pinned)
+            */
+            explicit ThreadPool(unsigned int numOfThreads = 0,
+                                const std::vector<std::vector<int>>& cpuSets = {}) :
+                active(0),
+                stopping(false)
+            {
+                if (numOfThreads == 0){
+                    numOfThreads = std::thread::hardware_concurrency();
+                }
+                if (numOfThreads == 0){
+                    numOfThreads = 1;
+                }
+                local.resize(numOfThreads);
+                this->cpuSets.resize(numOfThreads);
+                for (unsigned int i = 0; i < numOfThreads && !cpuSets.empty(); i++){
+                    this->cpuSets[i] = cpuSets[i % cpuSets.size()];
+                }
+                for (unsigned int i = 0; i < numOfThreads; i++){
+                    workers.emplace_back([this, i]{ WorkerLoop(i); });
+                }
+            }
+
+            ~ThreadPool()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    stopping = true;
+                }
+                taskReady.notify_all();
+                for (auto& w : workers){
+                    w.join();
+                }
+            }
+
+            ThreadPool(const ThreadPool&) = delete;
+            ThreadPool& operator=(const ThreadPool&) = delete;
+
+            unsigned int numOfThreads() const
+            {
+                return static_cast<unsigned int>(workers.size());
+            }
+
+            // CPUs worker w is pinned to (empty: not pinned)
+            const std::vector<int>& WorkerCpus(unsigned int w) const
+            {
+                return cpuSets[w];
+            }
+
+            // Index of the calling worker thread, -1 outside any pool
+            static int CurrentWorker()
+            {
+                return WorkerIndex();
+            }
+
+            // 把task排入佇列
+            void Submit(std::function<void()> task)
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    tasks.push_back(std::move(task));
+                }
+                taskReady.notify_one();
+            }
+
+            // 把task排入worker w自己的佇列 只有worker w會執行它
+            void SubmitTo(unsigned int w, std::function<void()> task)
+            {
+                assert(w < workers.size());
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    local[w].push_back(std::move(task));
+                }
+                // 所有worker共用一個condition variable 必須叫醒全部才能確保w醒來
+                taskReady.notify_all();
+            }
+
+            // 等待所有task(包含task中再submit的task)結束
+            void Wait()
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                allDone.wait(lock, [this]{ return Idle(); });
+                if (error){
+                    std::exception_ptr e = error;
+                    error = nullptr;
+                    std::rethrow_exception(e);
+                }
+            }
+    };
+
+    // 對0..n-1呼叫task(i): 有pool時分成多個連續區段平行執行
+    /*
+        * Without a pool (or with one thread) the indices run in order in the
+        * calling thread. Each task(i) must only write its own data, so the
+        * result does not depend on the number of threads.
+        * It returns through the pool-wide Wait(): it waits for every task in
+        * the pool, not only its own, so the pool must not be shared with
+        * concurrent work. It must not be called from a task of the same pool.
+    */
+    template <class Task>
+    void ParallelFor(ThreadPool* pool, int n, const Task& task)
+    {
+        if (!pool || pool->numOfThreads() <= 1){
+            for (int i = 0; i < n; i++){
+                task(i);
+            }
+            return;
+        }
+        int chunks = std::min(n, static_cast<int>(pool->numOfThreads()) * 4);
+        for (int c = 0; c < chunks; c++){
+            int first = static_cast<int>(static_cast<long long>(n) * c / chunks);
+            int last = static_cast<int>(static_cast<long long>(n) * (c + 1) / chunks);
+            pool->Submit([&task, first, last]{
+                for (int i = first; i < last; i++){
+                    task(i);
+                }
+            });
+        }
+        pool->Wait();
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <vector>
+
+#include "DE.h"
+#include "thread_pool.h"
+
+
+
+namespace DE
+{
+    /* ThreadPoolEvaluator: evaluate a batch on the workers of a ThreadPool */
+    /*
+        * The batch is split into one contiguous shard per worker. With
+        * firstTouch shard w is always evaluated by worker w, so whatever the
+        * objective allocates while evaluating on a pinned worker (scratch,
+        * thread_local buffers) is first touched, and stays, on that worker's
+        * NUMA node. Without firstTouch the shards go to the shared queue and
+        * any idle worker takes the next one. The trial vectors are read in
+        * place in both cases. The default enables firstTouch only when
+        * CpuTopology reports more than one node.
+        * EvaluateBatch waits for the whole pool, so do not share the pool
+        * with other work (e.g. MultiRun) while an optimization is running.
+    */
+    class ThreadPoolEvaluator : public Evaluator
+    {
+        private:
+            const Optimize& costFunction;
+            ThreadPool& pool;
+            bool firstTouch;
+
+            void EvaluateShard(const std::vector<std::vector<double>>& agents, std::vector<double>& costs,
+                               size_t first, size_t last)
+            {
+                for (size_t i = first; i < last; i++){
+                    costs[i] = costFunction.EvaluateCostView(agents[i]);
+                }
+            }
+
+        public:
+            /*
+                * INPUT:
+                    * costFunction: objective, called concurrently from the workers
+                    * pool: thread pool (not owned, must outlive the evaluator)
+                    * firstTouch: evaluate shard w on worker w in every batch
+                        (default: only with more than one NUMA node)
+            */
+            ThreadPoolEvaluator(const Optimize& costFunction, ThreadPool& pool) :
+                ThreadPoolEvaluator(costFunction, pool, CpuTopology().numOfNodes() > 1)
+            {}
+
+            ThreadPoolEvaluator(const Optimize& costFunction, ThreadPool& pool, bool firstTouch) :
+                costFunction(costFunction),
+                pool(pool),
+                firstTouch(firstTouch)
+            {}
+
+            bool FirstTouch() const
+            {
+                return firstTouch;
+            }
+
+            void EvaluateBatch(const std::vector<std::vector<double>>& agents, std::vector<double>& costs) override
+            {
+                costs.resize(agents.size());
+                unsigned int numOfWorkers = pool.numOfThreads();
+                size_t n = agents.size();
+                for (unsigned int w = 0; w < numOfWorkers; w++){
+                    size_t first = n * w / numOfWorkers;
+                    size_t last = n * (w + 1) / numOfWorkers;
+                    if (first == last){
+                        continue;
+                    }
+                    auto task = [this, &agents, &costs, first, last]{
+                        EvaluateShard(agents, costs, first, last);
+                    };
+                    if (firstTouch){
+                        pool.SubmitTo(w, task);
+                    }
+                    else{
+                        pool.Submit(task);
+                    }
+                }
+                pool.Wait();
+            }
+    };
+}
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <thread>
+
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#endif
+
+
+
+namespace DE
+{
+    // Parse a Linux cpulist such as "0-3,8,10-11"
+    inline std::vector<int> ParseCpuList(const std::string& text)
+    {
+        std::vector<int> cpus;
+        std::stringstream ss(text);
+        std::string item;
+        while (std::getline(ss, item, ',')){
+            if (item.empty() || item[0] == '\n'){
+                continue;
+            }
+            size_t dash = item.find('-');
+            int first = std::stoi(item.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+            for (int c = first; c <= last; c++){
+                cpus.push_back(c);
+            }
+        }
+        return cpus;
+    }
+
+    // 把目前的thread固定在cpus上 (空的cpus不做任何事; 非Linux: false)
+    inline bool PinCurrentThread(const std::vector<int>& cpus)
+    {
+        if (cpus.empty()){
+            return true;
+        }
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int c : cpus){
+            CPU_SET(c, &set);
+        }
+        return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+        return false;
+#endif
+    }
+
+    // Allocate the current thread's new pages on the node it runs on (MPOL_LOCAL; non-Linux: false)
+    inline bool SetLocalMemoryPolicy()
+    {
+#if defined(__linux__) && defined(SYS_set_mempolicy)
+        return syscall(SYS_set_mempolicy, MPOL_LOCAL, nullptr, 0) == 0;
+#else
+        return false;
+#endif
+    }
+
+
+    /* CpuTopology: NUMA nodes and their CPUs, read from /sys */
+    /*
+        * Only the CPUs this process may run on are listed. Without
+        * /sys/devices/system/node (containers, non-NUMA kernels) all allowed
+        * CPUs form a single node. Outside Linux there is one node with
+        * CPUs 0..hardware_concurrency()-1.
+    */
+    class CpuTopology{
+        private:
+            std::vector<std::vector<int>> nodes;
+
+        public:
+            explicit CpuTopology(const std::string& nodePath = "/sys/devices/system/node")
+            {
+#ifdef __linux__
+                cpu_set_t allowed;
+                CPU_ZERO(&allowed);
+                bool haveMask = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+                auto isAllowed = [&](int c){
+                    return !haveMask || (c < CPU_SETSIZE && CPU_ISSET(c, &allowed));
+                };
+
+                // node<N>/cpulist 直到找不到為止 (node編號可能不連續)
+                std::vector<int> online;
+                std::ifstream onlineFile(nodePath + "/online");
+                std::string text;
+                if (onlineFile && std::getline(onlineFile, text)){
+                    online = ParseCpuList(text);
+                }
+                for (int n : online){
+                    std::ifstream file(nodePath + "/node" + std::to_string(n) + "/cpulist");
+                    if (!file || !std::getline(file, text)){
+                        continue;
+                    }
+                    std::vector<int> cpus;
+                    for (int c : ParseCpuList(text)){
+                        if (isAllowed(c)){
+                            cpus.push_back(c);
+                        }
+                    }
+                    // memory-only node沒有CPU
+                    if (!cpus.empty()){
+                        nodes.push_back(cpus);
+                    }
+                }
+
+                if (nodes.empty()){
+                    std::vector<int> cpus;
+                    for (int c = 0; c < CPU_SETSIZE; c++){
+                        if (haveMask ? CPU_ISSET(c, &allowed) : c < static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN))){
+                            cpus.push_back(c);
+                        }
+                    }
+                    nodes.push_back(cpus);
+                }
+#else
+                (void)nodePath;
+                std::vector<int> cpus(std::max(1u, std::thread::hardware_concurrency()));
+                for (size_t c = 0; c < cpus.size(); c++){
+                    cpus[c] = static_cast<int>(c);
+                }
+                nodes.push_back(cpus);
+#endif
+            }
+
+            unsigned int numOfNodes() const
+            {
+                return static_cast<unsigned int>(nodes.size());
+            }
+
+            const std::vector<int>& Cpus(unsigned int node) const
+            {
+                return nodes[node];
+            }
+
+            // 回傳cpu所在的node (-1代表不在任何node)
+            int NodeOfCpu(int cpu) const
+            {
+                for (size_t n = 0; n < nodes.size(); n++){
+                    if (std::find(nodes[n].begin(), nodes[n].end(), cpu) != nodes[n].end()){
+                        return static_cast<int>(n);
+                    }
+                }
+                return -1;
+            }
+
+            // One CPU per thread
+            /*
+                * INPUT:
+                    * numOfThreads: number of workers to place
+                    * spread: true assigns threads to nodes round-robin (uses every
+                        node's memory bandwidth), false fills node 0 first (compact)
+                * Threads beyond the number of CPUs wrap around.
+            */
+            std::vector<std::vector<int>> Placement(unsigned int numOfThreads, bool spread = true) const
+            {
+                std::vector<int> order;
+                if (spread){
+                    size_t longest = 0;
+                    for (const auto& cpus : nodes){
+                        longest = std::max(longest, cpus.size());
+                    }
+                    for (size_t i = 0; i < longest; i++){
+                        for (const auto& cpus : nodes){
+                            if (i < cpus.size()){
+                                order.push_back(cpus[i]);
+                            }
+                        }
+                    }
+                }
+                else{
+                    for (const auto& cpus : nodes){
+                        order.insert(order.end(), cpus.begin(), cpus.end());
+                    }
+                }
+
+                std::vector<std::vector<int>> placement(numOfThreads);
+                for (unsigned int t = 0; t < numOfThreads && !order.empty(); t++){
+                    placement[t].push_back(order[t % order.size()]);
+                }
+                return placement;
+            }
+    };
+}
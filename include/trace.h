@@ -0,0 +1,408 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <cassert>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "ring.h"
+
+
+
+namespace DE
+{
+    /* Trace file layout (little-endian) */
+    /*
+        * [TraceFileHeader]
+        * [rows]      count x (1 + dim) float64, each row is the cost followed by the vector
+        * [metadata]  per row: varint(zigzag(generation delta)),
+        *                      varint(zigzag(index delta) << 1 | accepted)
+        * [TraceFileFooter]
+        * Rows are raw doubles so a reader can map them without parsing; only
+        * the small metadata stream is delta/varint encoded.
+    */
+    struct TraceFileHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t dim;
+        char reserved[48];
+    };
+
+    struct TraceFileFooter
+    {
+        uint64_t count;
+        uint64_t metaOffset;
+        uint64_t metaBytes;
+        char magic[8];
+    };
+
+    static const char traceMagic[8] = {'D', 'E', 'T', 'R', 'A', 'C', 'E', '1'};
+
+
+    /* TraceRecorder: record every evaluation with a background writer */
+    /*
+        * Each recording thread gets its own SPSC ring on first use; Record()
+        * only copies one fixed-size record into that ring. A background
+        * thread drains all rings into the file. If a ring is full the
+        * recording thread waits for the writer instead of dropping records.
+        * Call Close() (or destroy the recorder) after the last Record().
+    */
+    class TraceRecorder{
+        private:
+            // fixed-size ring slot
+            struct Slot
+            {
+                uint32_t generation;
+                uint32_t index;
+                uint32_t accepted;
+                uint32_t padding;
+                double cost;
+                // followed by dim doubles
+            };
+
+            struct ThreadRing
+            {
+                std::unique_ptr<uint64_t[]> memory;
+                SharedRing ring;
+            };
+
+            unsigned int dim;
+            unsigned int ringCapacity;
+            size_t slotBytes;
+            uint64_t id;
+            std::FILE* file;
+            std::vector<char> fileBuffer;
+
+            std::mutex ringsMutex;
+            std::vector<std::unique_ptr<ThreadRing>> rings;
+
+            std::thread writer;
+            std::atomic<bool> stopping;
+            bool closed;
+
+            // writer state
+            std::atomic<uint64_t> count;
+            std::vector<uint8_t> meta;
+            uint32_t prevGeneration;
+            uint32_t prevIndex;
+
+            static uint64_t NextId()
+            {
+                static std::atomic<uint64_t> next(1);
+                return next++;
+            }
+
+            static void PutVarint(std::vector<uint8_t>& out, uint64_t v)
+            {
+                while (v >= 0x80){
+                    out.push_back(static_cast<uint8_t>(v | 0x80));
+                    v >>= 7;
+                }
+                out.push_back(static_cast<uint8_t>(v));
+            }
+
+            static uint64_t ZigZag(int64_t v)
+            {
+                return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+            }
+
+            // 目前thread的ring(第一次使用時註冊)
+            SharedRing& LocalRing()
+            {
+                struct Entry { uint64_t owner; SharedRing* ring; };
+                static thread_local std::vector<Entry> cache;
+                for (const auto& e : cache){
+                    if (e.owner == id){
+                        return *e.ring;
+                    }
+                }
+                std::unique_ptr<ThreadRing> r(new ThreadRing());
+                size_t words = (SharedRing::Bytes(ringCapacity, slotBytes) + 7) / 8;
+                r->memory.reset(new uint64_t[words]());
+                r->ring = SharedRing(r->memory.get(), ringCapacity, slotBytes);
+                SharedRing* ring = &r->ring;
+                {
+                    std::lock_guard<std::mutex> lock(ringsMutex);
+                    rings.push_back(std::move(r));
+                }
+                // 清掉已經關閉的recorder留下的項目
+                if (cache.size() > 8){
+                    cache.clear();
+                }
+                cache.push_back(Entry{id, ring});
+                return *ring;
+            }
+
+            // 把所有ring中的record寫入檔案 回傳寫入筆數
+            size_t Drain()
+            {
+                std::vector<SharedRing*> snapshot;
+                {
+                    std::lock_guard<std::mutex> lock(ringsMutex);
+                    for (auto& r : rings){
+                        snapshot.push_back(&r->ring);
+                    }
+                }
+                size_t drained = 0;
+                for (SharedRing* ring : snapshot){
+                    const unsigned char* p;
+                    while ((p = ring->BeginPop())){
+                        Slot s;
+                        std::memcpy(&s, p, sizeof(Slot));
+                        std::fwrite(&s.cost, sizeof(double), 1, file);
+                        std::fwrite(p + sizeof(Slot), sizeof(double), dim, file);
+                        ring->EndPop();
+
+                        int64_t dg = static_cast<int64_t>(s.generation) - prevGeneration;
+                        int64_t di = static_cast<int64_t>(s.index) - prevIndex;
+                        PutVarint(meta, ZigZag(dg));
+                        PutVarint(meta, (ZigZag(di) << 1) | (s.accepted ? 1 : 0));
+                        prevGeneration = s.generation;
+                        prevIndex = s.index;
+                        drained++;
+                    }
+                }
+                count.fetch_add(drained, std::memory_order_relaxed);
+                return drained;
+            }
+
+            void WriterLoop()
+            {
+                for (;;){
+                    bool stop = stopping.load(std::memory_order_acquire);
+                    size_t drained = Drain();
+                    if (stop && drained == 0){
+                        return;
+                    }
+                    if (drained == 0){
+                        std::this_thread::sleep_for(std::chrono::microseconds(200));
+                    }
+                }
+            }
+
+        public:
+            /*
+                * INPUT:
+                    * path: output file
+                    * dim: number of parameters of the recorded vectors
+                    * ringCapacity: records buffered per recording thread
+            */
+            TraceRecorder(const std::string& path, unsigned int dim, unsigned int ringCapacity = 4096) :
+                dim(dim),
+                ringCapacity(ringCapacity),
+                slotBytes(sizeof(Slot) + dim * sizeof(double)),
+                id(NextId()),
+                file(nullptr),
+                fileBuffer(1 << 20),
+                stopping(false),
+                closed(false),
+                count(0),
+                prevGeneration(0),
+                prevIndex(0)
+            {
+                assert(dim > 0 && "Dimension must be greater than 0");
+                assert(ringCapacity > 0);
+                file = std::fopen(path.c_str(), "wb");
+                if (!file){
+                    throw std::runtime_error("TraceRecorder: cannot open " + path);
+                }
+                std::setvbuf(file, fileBuffer.data(), _IOFBF, fileBuffer.size());
+
+                TraceFileHeader header;
+                std::memset(&header, 0, sizeof(header));
+                std::memcpy(header.magic, traceMagic, sizeof(traceMagic));
+                header.version = 1;
+                header.dim = dim;
+                std::fwrite(&header, sizeof(header), 1, file);
+
+                writer = std::thread([this]{ WriterLoop(); });
+            }
+
+            ~TraceRecorder()
+            {
+                Close();
+            }
+
+            TraceRecorder(const TraceRecorder&) = delete;
+            TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+            unsigned int numOfParameters() const
+            {
+                return dim;
+            }
+
+            // Hot path: copy one record into the calling thread's ring
+            void Record(uint32_t generation, uint32_t index, const double* agent, double cost, bool accepted)
+            {
+                SharedRing& ring = LocalRing();
+                unsigned char* p;
+                while (!(p = ring.BeginPush())){
+                    std::this_thread::yield();
+                }
+                Slot s;
+                s.generation = generation;
+                s.index = index;
+                s.accepted = accepted ? 1 : 0;
+                s.padding = 0;
+                s.cost = cost;
+                std::memcpy(p, &s, sizeof(Slot));
+                std::memcpy(p + sizeof(Slot), agent, dim * sizeof(double));
+                ring.EndPush();
+            }
+
+            // Stop the writer, append metadata and footer, and close the file
+            void Close()
+            {
+                if (closed){
+                    return;
+                }
+                closed = true;
+                stopping.store(true, std::memory_order_release);
+                writer.join();
+
+                TraceFileFooter footer;
+                std::memset(&footer, 0, sizeof(footer));
+                footer.count = count.load();
+                footer.metaOffset = sizeof(TraceFileHeader) + footer.count * (1 + dim) * sizeof(double);
+                footer.metaBytes = meta.size();
+                std::memcpy(footer.magic, traceMagic, sizeof(traceMagic));
+                if (!meta.empty()){
+                    std::fwrite(meta.data(), 1, meta.size(), file);
+                }
+                std::fwrite(&footer, sizeof(footer), 1, file);
+                std::fclose(file);
+                file = nullptr;
+            }
+
+            // number of records written so far
+            uint64_t numOfRecords() const
+            {
+                return count.load(std::memory_order_relaxed);
+            }
+    };
+
+
+    /* TraceReader: memory-map a trace file */
+    /*
+        * Rows stay in the mapping (no copy, no parsing); generation, index and
+        * accepted are decoded from the varint stream once at open.
+    */
+    class TraceReader{
+        private:
+            void* map;
+            size_t bytes;
+            unsigned int dim;
+            uint64_t count;
+            const double* rows;
+            std::vector<uint32_t> generation;
+            std::vector<uint32_t> index;
+            std::vector<uint8_t> accepted;
+
+            static uint64_t GetVarint(const uint8_t*& p, const uint8_t* end)
+            {
+                uint64_t v = 0;
+                int shift = 0;
+                while (p < end){
+                    uint8_t b = *p++;
+                    v |= static_cast<uint64_t>(b & 0x7f) << shift;
+                    if (!(b & 0x80)){
+                        return v;
+                    }
+                    shift += 7;
+                }
+                throw std::runtime_error("TraceReader: truncated metadata");
+            }
+
+            static int64_t UnZigZag(uint64_t v)
+            {
+                return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+            }
+
+        public:
+            explicit TraceReader(const std::string& path) : map(nullptr), bytes(0), dim(0), count(0), rows(nullptr)
+            {
+                int fd = open(path.c_str(), O_RDONLY);
+                if (fd < 0){
+                    throw std::runtime_error("TraceReader: cannot open " + path);
+                }
+                struct stat st;
+                if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(TraceFileHeader) + sizeof(TraceFileFooter))){
+                    close(fd);
+                    throw std::runtime_error("TraceReader: not a complete trace file: " + path);
+                }
+                bytes = static_cast<size_t>(st.st_size);
+                map = mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+                close(fd);
+                if (map == MAP_FAILED){
+                    map = nullptr;
+                    throw std::runtime_error("TraceReader: mmap failed for " + path);
+                }
+
+                const unsigned char* base = static_cast<const unsigned char*>(map);
+                TraceFileHeader header;
+                TraceFileFooter footer;
+                std::memcpy(&header, base, sizeof(header));
+                std::memcpy(&footer, base + bytes - sizeof(footer), sizeof(footer));
+                if (std::memcmp(header.magic, traceMagic, 8) != 0 || std::memcmp(footer.magic, traceMagic, 8) != 0
+                    || header.version != 1 || header.dim == 0
+                    || footer.metaOffset != sizeof(TraceFileHeader) + footer.count * (1 + header.dim) * sizeof(double)
+                    || footer.metaOffset + footer.metaBytes + sizeof(footer) != bytes){
+                    munmap(map, bytes);
+                    map = nullptr;
+                    throw std::runtime_error("TraceReader: corrupt or unfinished trace file: " + path);
+                }
+                dim = header.dim;
+                count = footer.count;
+                rows = reinterpret_cast<const double*>(base + sizeof(TraceFileHeader));
+
+                generation.resize(count);
+                index.resize(count);
+                accepted.resize(count);
+                const uint8_t* p = base + footer.metaOffset;
+                const uint8_t* end = p + footer.metaBytes;
+                int64_t g = 0;
+                int64_t k = 0;
+                for (uint64_t r = 0; r < count; r++){
+                    g += UnZigZag(GetVarint(p, end));
+                    uint64_t v = GetVarint(p, end);
+                    k += UnZigZag(v >> 1);
+                    generation[r] = static_cast<uint32_t>(g);
+                    index[r] = static_cast<uint32_t>(k);
+                    accepted[r] = static_cast<uint8_t>(v & 1);
+                }
+            }
+
+            ~TraceReader()
+            {
+                if (map){
+                    munmap(map, bytes);
+                }
+            }
+
+            TraceReader(const TraceReader&) = delete;
+            TraceReader& operator=(const TraceReader&) = delete;
+
+            unsigned int numOfParameters() const { return dim; }
+            uint64_t size() const { return count; }
+
+            // row r starts at Rows() + r * (1 + dim): cost, then the vector
+            const double* Rows() const { return rows; }
+            const std::vector<uint32_t>& Generations() const { return generation; }
+            const std::vector<uint32_t>& Indices() const { return index; }
+            const std::vector<uint8_t>& Accepted() const { return accepted; }
+    };
+}
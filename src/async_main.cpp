@@ -0,0 +1,28 @@
+#include "../include/DE.h"
+#include "../include/functions.h"
+#include "../include/async.h"
+#include <iostream>
+
+int main(){
+
+    // Create a function object
+    int dimension = 4;
+
+    // cost function
+    DE::Func f(dimension);
+
+    // Evaluate the blocking objective on a small executor
+    DE::AsyncExecutor executor(2);
+    DE::AsyncAdaptor asyncFunction(f, executor);
+
+    // Create an asynchronous DE object
+    DE::AsyncDifferentialEvolution de(asyncFunction,50,0.5,0.5,16); // Input: (cost function, population size, F, CR, max in flight)
+
+    // Optimize the function
+    de.OptimizeStep(1000);
+
+    std::cout << "Best Cost: " << de.GetBestCost() << std::endl;
+    std::cout << "Evaluations: " << de.GetNumOfEvaluations() << std::endl;
+    return 0;
+
+}
@@ -0,0 +1,87 @@
+#include "../include/DE.h"
+#include "../include/functions.h"
+#include "../include/thread_pool.h"
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <string>
+
+// Per-phase profile of SelectAndCross
+// usage: DE_benchmark [dimension] [populationSize] [generations]
+
+static void PrintPhase(const char* name, const DE::PhaseCounters& p, double total)
+{
+    double calls = p.calls ? static_cast<double>(p.calls) : 1.0;
+    std::cout << std::left << std::setw(20) << name << std::right
+              << std::setw(10) << p.calls
+              << std::setw(9) << std::setprecision(1) << std::fixed << (total > 0 ? 100.0 * p.seconds / total : 0.0) << "%"
+              << std::setw(12) << std::setprecision(1) << 1e9 * p.seconds / calls
+              << std::setw(10) << std::setprecision(2) << p.IPC()
+              << std::setw(14) << std::setprecision(1) << p.instructions / calls
+              << std::setw(12) << std::setprecision(3) << p.llcMisses / calls
+              << std::setw(14) << std::setprecision(3) << p.branchMisses / calls
+              << std::endl;
+}
+
+static void Report(const std::string& mode, const DE::PerfReport& report)
+{
+    double total = report.trialConstruction.seconds + report.evaluation.seconds + report.selection.seconds;
+    std::cout << std::endl << "== " << mode << " ==" << std::endl;
+    if (!report.countersAvailable){
+        std::cout << "hardware counters not available: " << report.reason << " (wall time only)" << std::endl;
+    }
+    std::cout << std::left << std::setw(20) << "phase" << std::right
+              << std::setw(10) << "calls"
+              << std::setw(10) << "time"
+              << std::setw(12) << "ns/call"
+              << std::setw(10) << "IPC"
+              << std::setw(14) << "instr/call"
+              << std::setw(12) << "LLC/call"
+              << std::setw(14) << "brmiss/call"
+              << std::endl;
+    PrintPhase("trial construction", report.trialConstruction, total);
+    PrintPhase("evaluation", report.evaluation, total);
+    PrintPhase("selection", report.selection, total);
+}
+
+int main(int argc, char** argv){
+
+    unsigned int dimension = argc > 1 ? std::atoi(argv[1]) : 10;
+    unsigned int populationSize = argc > 2 ? std::atoi(argv[2]) : 50;
+    int generations = argc > 3 ? std::atoi(argv[3]) : 1000;
+
+    DE::Func f(dimension);
+    std::cout << "Func(" << dimension << "), population " << populationSize
+              << ", " << generations << " generations" << std::endl;
+
+    // 每個trial各自evaluation
+    {
+        DE::DifferentialEvolution de(f, populationSize, 0.5, 0.5);
+        de.EnableProfiling();
+        de.OptimizeStep(generations, false);
+        Report("serial", de.GetProfile());
+    }
+
+    // 整個generation一起evaluation
+    {
+        DE::SerialEvaluator evaluator(f);
+        DE::DifferentialEvolution de(f, populationSize, 0.5, 0.5);
+        de.SetEvaluator(&evaluator);
+        de.EnableProfiling();
+        de.OptimizeStep(generations, false);
+        Report("evaluator batch", de.GetProfile());
+    }
+
+    // deterministic parallel mode (counters summed over the workers)
+    {
+        DE::ThreadPool pool;
+        DE::DifferentialEvolution de(f, populationSize, 0.5, 0.5);
+        de.EnableDeterministicParallel(&pool);
+        de.EnableProfiling();
+        de.OptimizeStep(generations, false);
+        Report("deterministic, " + std::to_string(pool.numOfThreads()) + " threads", de.GetProfile());
+    }
+
+    return 0;
+
+}
@@ -2,12 +2,158 @@
 #include "./pybind11/include/pybind11/pybind11.h"
 #include "./pybind11/include/pybind11/functional.h" // 為 std::function 支持
 #include "./pybind11/include/pybind11/stl.h"
+#include "./pybind11/include/pybind11/numpy.h"
 #include "../include/DE.h"
 #include "../include/functions.h"
+#include "../include/process_pool.h"
+#include "../include/multi_run.h"
+#include "../include/thread_pool_evaluator.h"
+#include "../include/multi_objective.h"
+#include "../include/cooperative.h"
+#include "../include/expression.h"
 
 
 namespace py = pybind11;
 
+// Read-only memoryview of optimizer storage. The storage is overwritten (and
+// may be reallocated) after the call, so the view is always released: also
+// when the call raises. A buffer exported from it that is still alive (e.g.
+// numpy.asarray(x) kept by the caller) raises BufferError.
+class StorageView
+{
+    private:
+        py::memoryview view;
+        bool released;
+
+    public:
+        StorageView(const double* data, std::vector<py::ssize_t> shape, std::vector<py::ssize_t> strides) :
+            view(py::memoryview::from_buffer(data, std::move(shape), std::move(strides))),
+            released(false) {}
+
+        ~StorageView()
+        {
+            TryRelease();
+        }
+
+        StorageView(const StorageView&) = delete;
+        StorageView& operator=(const StorageView&) = delete;
+
+        const py::memoryview& get() const
+        {
+            return view;
+        }
+
+        // false: a buffer exported from the view is still alive
+        bool TryRelease()
+        {
+            if (!released){
+                try{
+                    view.attr("release")();
+                    released = true;
+                }
+                catch (py::error_already_set&){
+                }
+            }
+            return released;
+        }
+
+        static const char* Message()
+        {
+            return "an array exported from the agent view outlived the call; "
+                   "copy it (numpy.array(x)) to keep it";
+        }
+};
+
+template <class Result = double, class... Args>
+static Result CallWithBuffer(const py::function& f, const double* data, std::vector<py::ssize_t> shape,
+                             std::vector<py::ssize_t> strides, Args... args)
+{
+    StorageView view(data, std::move(shape), std::move(strides));
+    Result result;
+    try{
+        result = f(view.get(), args...).template cast<Result>();
+    }
+    catch (py::error_already_set& e){
+        // the traceback's frames may still hold arrays exported from the view
+        if (!view.TryRelease()){
+            py::module_::import("traceback").attr("clear_frames")(e.trace());
+            if (!view.TryRelease()){
+                py::raise_from(e, PyExc_BufferError, StorageView::Message());
+                throw py::error_already_set();
+            }
+        }
+        throw;
+    }
+    if (!view.TryRelease()){
+        throw py::buffer_error(StorageView::Message());
+    }
+    return result;
+}
+
+// f(memoryview of the agent, args...)
+template <class Result = double, class... Args>
+static Result CallWithView(const py::function& f, const double* data, unsigned int n, Args... args)
+{
+    return CallWithBuffer<Result>(f, data, {static_cast<py::ssize_t>(n)},
+                                  {static_cast<py::ssize_t>(sizeof(double))}, args...);
+}
+
+// Small Python AST of an expression objective:
+//   number | "name" | ("x", index) | (op, args...) | ("sum"/"prod", "i", first, last, body)
+// op is "+", "-", "*", "/", "^", "neg" or a function name; "+" and "*" take 2 or more args.
+static DE::ExpressionNode ExpressionFromPython(py::handle node, unsigned int depth = 1)
+{
+    if (depth > DE::ExpressionNode::maxDepth){
+        throw std::invalid_argument("Expression: nested deeper than " +
+                                    std::to_string(DE::ExpressionNode::maxDepth) + " levels");
+    }
+    if (py::isinstance<py::bool_>(node)){
+        throw py::type_error("Expression: unexpected bool in AST");
+    }
+    if (py::isinstance<py::int_>(node) || py::isinstance<py::float_>(node)){
+        return DE::ExpressionNode::Number(node.cast<double>());
+    }
+    if (py::isinstance<py::str>(node)){
+        return DE::ExpressionNode::Variable(node.cast<std::string>());
+    }
+    if (!py::isinstance<py::tuple>(node) && !py::isinstance<py::list>(node)){
+        throw py::type_error("Expression: AST nodes are numbers, names or tuples, got " +
+                             py::repr(node).cast<std::string>());
+    }
+    py::sequence items = py::reinterpret_borrow<py::sequence>(node);
+    if (items.size() == 0 || !py::isinstance<py::str>(items[0])){
+        throw py::type_error("Expression: a tuple node starts with its operator, got " +
+                             py::repr(node).cast<std::string>());
+    }
+    std::string op = items[0].cast<std::string>();
+    if (op == "x"){
+        if (items.size() != 2){
+            throw py::type_error("Expression: (\"x\", index) expected");
+        }
+        return DE::ExpressionNode::Element(ExpressionFromPython(items[1], depth + 1));
+    }
+    if (op == "sum" || op == "prod"){
+        if (items.size() != 5 || !py::isinstance<py::str>(items[1])){
+            throw py::type_error("Expression: (\"" + op + "\", \"i\", first, last, body) expected");
+        }
+        return DE::ExpressionNode::Reduce(op, items[1].cast<std::string>(), ExpressionFromPython(items[2], depth + 1),
+                                          ExpressionFromPython(items[3], depth + 1), ExpressionFromPython(items[4], depth + 1));
+    }
+    std::vector<DE::ExpressionNode> args;
+    for (size_t k = 1; k < items.size(); k++){
+        args.push_back(ExpressionFromPython(items[k], depth + 1));
+    }
+    // ("+", a, b, c) = (a + b) + c
+    if ((op == "+" || op == "*") && args.size() > 2){
+        DE::ExpressionNode total = args[0];
+        for (size_t k = 1; k < args.size(); k++){
+            total = DE::ExpressionNode::Call(op, {std::move(total), std::move(args[k])});
+        }
+        return total;
+    }
+    return DE::ExpressionNode::Call(op, std::move(args));
+}
+
 class PyOptimize : public DE::Optimize
 {
     public:
@@ -22,6 +168,26 @@ class PyOptimize : public DE::Optimize
             );
         }
 
+        // The optimizer hands the Python override a read-only memoryview instead of a list
+        double EvaluateCostView(DE::VectorView pi) const override {
+            py::gil_scoped_acquire gil;
+            py::function override = py::get_override(static_cast<const DE::Optimize*>(this), "EvaluateCost");
+            if (!override){
+                py::pybind11_fail("Tried to call pure virtual function \"Optimize::EvaluateCost\"");
+            }
+            return CallWithView(override, pi.data(), pi.size());
+        }
+
+        // EvaluateCostBounded(x, threshold) is optional in Python subclasses
+        double EvaluateCostBounded(DE::VectorView pi, double threshold) const override {
+            py::gil_scoped_acquire gil;
+            py::function override = py::get_override(static_cast<const DE::Optimize*>(this), "EvaluateCostBounded");
+            if (!override){
+                return EvaluateCostView(pi);
+            }
+            return CallWithView(override, pi.data(), pi.size(), threshold);
+        }
+
         unsigned int numOfParameters() const override {
             PYBIND11_OVERRIDE_PURE(
                 unsigned int,
@@ -37,8 +203,152 @@ class PyOptimize : public DE::Optimize
                 getConstraints, 
             );
         }
+
+        std::vector<DE::Optimize::NonlinearConstraint> getNonlinearConstraints() const override {
+            PYBIND11_OVERRIDE(
+                std::vector<DE::Optimize::NonlinearConstraint>,
+                DE::Optimize,
+                getNonlinearConstraints, 
+            );
+        }
+
+        unsigned long long dataVersion() const override {
+            PYBIND11_OVERRIDE(
+                unsigned long long,
+                DE::Optimize,
+                dataVersion, 
+            );
+        }
 };
 
+// DifferentialEvolution and its PopulationStatistics for one storage type (double or float)
+template <class Real, class ToArray>
+static void BindDifferentialEvolution(py::module& m, const char* name, const char* statisticsName, const ToArray& toArray)
+{
+    using Optimizer = DE::BasicDifferentialEvolution<DE::Optimize, Real>;
+    using Statistics = DE::BasicPopulationStatistics<Real>;
+
+    py::class_<Statistics>(m, statisticsName)
+        .def("Centroid", [toArray](const Statistics& s){ return toArray(s.Centroid()); })
+        .def("Variance", [toArray](const Statistics& s){ return toArray(s.Variance()); })
+        .def("Lower", [toArray](const Statistics& s){ return toArray(s.Lower()); })
+        .def("Upper", [toArray](const Statistics& s){ return toArray(s.Upper()); })
+        .def("MeanStd", &Statistics::MeanStd)
+        .def("numOfFiniteCosts", &Statistics::numOfFiniteCosts)
+        .def("MeanCost", &Statistics::MeanCost)
+        .def("CostStd", &Statistics::CostStd)
+        .def("MinCost", &Statistics::MinCost)
+        .def("MaxCost", &Statistics::MaxCost)
+        .def("CostRange", &Statistics::CostRange);
+
+    // DifferentialEvolution
+    py::class_<Optimizer>(m, name)
+        .def(py::init<const DE::Optimize&,unsigned int, double, double, int, bool,
+            std::function<void(const Optimizer&)>,
+            std::function<bool(const Optimizer&)>>(),
+            
+            // init arguments
+            py::arg("costFunction"), 
+            py::arg("populationSize"),
+            py::arg("F"), 
+            py::arg("CR"), 
+            py::arg("RandomSeed"),
+            py::arg("shouldCheckConstraint"), py::arg("callback"), py::arg("terminationCondition"),
+            // the optimizer keeps a reference to the cost function
+            py::keep_alive<1, 2>())
+        // InitializePopulation operation
+        // (the GIL is released: a ThreadPoolEvaluator calls Python objectives from its workers)
+        .def("InitializePopulation",&Optimizer::InitializePopulation,
+            py::call_guard<py::gil_scoped_release>())
+        .def("ReevaluatePopulation",&Optimizer::ReevaluatePopulation,
+            py::call_guard<py::gil_scoped_release>())
+        // get the population
+        .def("getPopulation",&Optimizer::getPopulation)
+        // SelectAndCross
+        .def("SelectAndCross",&Optimizer::SelectAndCross,
+            py::call_guard<py::gil_scoped_release>())
+        .def("GetBestAgent",&Optimizer::GetBestAgent)
+        .def("GetBestCost",&Optimizer::GetBestCost)
+        // valid until the optimizer is destroyed
+        .def("GetStatistics",&Optimizer::GetStatistics, py::return_value_policy::reference_internal)
+        .def("GetPopulationCost",&Optimizer::GetPopulationCost)
+
+        .def("PrintPopulation",&Optimizer::printPopulation)
+        // Surrogate-assisted mode
+        .def("EnableSurrogate",&Optimizer::EnableSurrogate,
+            py::arg("candidates"), py::arg("archiveSize")=256,
+            py::arg("neighbours")=5, py::arg("screen")=false)
+        .def("DisableSurrogate",&Optimizer::DisableSurrogate)
+        .def("GetNumOfEvaluations",&Optimizer::GetNumOfEvaluations)
+        .def("GetNumOfSkippedEvaluations",&Optimizer::GetNumOfSkippedEvaluations)
+        // Bounded evaluation
+        .def("SetBoundedEvaluation",&Optimizer::SetBoundedEvaluation, py::arg("enable"))
+        .def("GetNumOfAbortedEvaluations",&Optimizer::GetNumOfAbortedEvaluations)
+        // Incremental evaluation of separable objectives
+        .def("SetIncrementalEvaluation",&Optimizer::SetIncrementalEvaluation, py::arg("enable"))
+        .def("GetNumOfTermEvaluations",&Optimizer::GetNumOfTermEvaluations)
+        .def("SetInitialization",&Optimizer::SetInitialization,
+            py::arg("method"), py::arg("unboundedScale")=1.0)
+        // Local search polishing
+        .def("EnablePolishing",&Optimizer::EnablePolishing, py::arg("config")=DE::PolishConfig())
+        .def("DisablePolishing",&Optimizer::DisablePolishing)
+        .def("Polish",&Optimizer::Polish, py::arg("numOfAgents")=1,
+            py::call_guard<py::gil_scoped_release>())
+        .def("GetNumOfPolishEvaluations",&Optimizer::GetNumOfPolishEvaluations)
+        // Restarts (IPOP/BIPOP)
+        .def("EnableRestarts",&Optimizer::EnableRestarts, py::arg("config")=DE::RestartConfig())
+        .def("DisableRestarts",&Optimizer::DisableRestarts)
+        .def("GetNumOfRestarts",&Optimizer::GetNumOfRestarts)
+        .def("GetRestartHistory",&Optimizer::GetRestartHistory)
+        .def("GetPopulationSize",&Optimizer::GetPopulationSize)
+        .def("GetGlobalBestAgent",&Optimizer::GetGlobalBestAgent)
+        .def("GetGlobalBestCost",&Optimizer::GetGlobalBestCost)
+        .def("GetGlobalBestViolation",&Optimizer::GetGlobalBestViolation)
+        // Dynamic objective (data versions)
+        .def("EnableDynamicObjective",&Optimizer::EnableDynamicObjective, py::arg("config")=DE::DynamicConfig())
+        .def("DisableDynamicObjective",&Optimizer::DisableDynamicObjective)
+        .def("GetNumOfDataChanges",&Optimizer::GetNumOfDataChanges)
+        .def("GetNumOfReevaluations",&Optimizer::GetNumOfReevaluations)
+        .def("GetNumOfStale",&Optimizer::GetNumOfStale)
+        // Deadline (time.time() timestamp or a budget in seconds) and cancellation
+        .def("SetDeadline",[](Optimizer& self, double timestamp){
+                self.SetDeadline(std::chrono::system_clock::time_point(
+                    std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::duration<double>(timestamp))));
+            },
+            py::arg("timestamp"))
+        .def("SetTimeBudget",&Optimizer::SetTimeBudget, py::arg("seconds"))
+        .def("ClearDeadline",&Optimizer::ClearDeadline)
+        .def("SetCancellationToken",&Optimizer::SetCancellationToken,
+            py::arg("token"), py::keep_alive<1, 2>())
+        .def("GetStopReason",&Optimizer::GetStopReason)
+        .def("GetDeadlineOvershoot",&Optimizer::GetDeadlineOvershoot)
+        // Profiling of SelectAndCross
+        .def("EnableProfiling",&Optimizer::EnableProfiling)
+        .def("DisableProfiling",&Optimizer::DisableProfiling)
+        .def("GetProfile",&Optimizer::GetProfile)
+        .def("ResetProfile",&Optimizer::ResetProfile)
+        // Batch evaluation
+        .def("SetEvaluator",&Optimizer::SetEvaluator,
+            py::arg("evaluator"), py::keep_alive<1, 2>())
+        // Deterministic parallel mode (pool=None: the calling thread)
+        .def("EnableDeterministicParallel",&Optimizer::EnableDeterministicParallel,
+            py::arg("pool")=nullptr, py::keep_alive<1, 2>())
+        .def("DisableDeterministicParallel",&Optimizer::DisableDeterministicParallel)
+        // Evaluation trace
+        .def("SetTraceRecorder",&Optimizer::SetTraceRecorder,
+            py::arg("recorder"), py::keep_alive<1, 2>())
+        .def("GetGeneration",&Optimizer::GetGeneration)
+        // Nonlinear constraints
+        .def("SetConstraintHandling",&Optimizer::SetConstraintHandling,
+            py::arg("mode"), py::arg("controlGenerations")=1000, py::arg("exponent")=5.0)
+        .def("GetBestViolation",&Optimizer::GetBestViolation)
+        .def("GetNumOfConstraintRejections",&Optimizer::GetNumOfConstraintRejections)
+        // Python objectives and callbacks re-acquire the GIL themselves
+        .def("OptimizeStep",&Optimizer::OptimizeStep,
+            py::arg("iterations"), py::arg("verbose")=true,
+            py::call_guard<py::gil_scoped_release>());
+}
+
 PYBIND11_MODULE(pyde, m) {
     m.doc() = "Differential Evolution Optimization";
 
@@ -46,8 +356,14 @@ PYBIND11_MODULE(pyde, m) {
     py::class_<DE::Optimize, PyOptimize,std::shared_ptr<DE::Optimize>>(m,"Optimize")
         .def(py::init<>())
         .def("EvaluateCost",&DE::Optimize::EvaluateCost)
+        .def("EvaluateCostBounded",[](const DE::Optimize& self, const std::vector<double>& x, double threshold){
+                return self.EvaluateCostBounded(x, threshold);
+            },
+            py::arg("input"), py::arg("threshold"))
         .def("numOfParameters",&DE::Optimize::numOfParameters)
-        .def("getConstraints",&DE::Optimize::getConstraints);
+        .def("getConstraints",&DE::Optimize::getConstraints)
+        .def("getNonlinearConstraints",&DE::Optimize::getNonlinearConstraints)
+        .def("dataVersion",&DE::Optimize::dataVersion);
     
     // Constraint structure
     py::class_<DE::Optimize::Constraint>(m.attr("Optimize"), "Constraint")
@@ -57,8 +373,148 @@ PYBIND11_MODULE(pyde, m) {
         .def_readwrite("isConstrained", &DE::Optimize::Constraint::isConstrained)
         .def("Check", &DE::Optimize::Constraint::Check);
 
+    // Nonlinear constraint: g(x) <= 0 (Inequality) or |h(x)| <= tolerance (Equality)
+    py::class_<DE::Optimize::NonlinearConstraint> nonlinearConstraint(m.attr("Optimize"), "NonlinearConstraint");
+    py::enum_<DE::Optimize::NonlinearConstraint::Type>(nonlinearConstraint, "Type")
+        .value("Inequality", DE::Optimize::NonlinearConstraint::Inequality)
+        .value("Equality", DE::Optimize::NonlinearConstraint::Equality)
+        .export_values();
+    nonlinearConstraint
+        .def(py::init<std::function<double(const std::vector<double>&)>,
+                      DE::Optimize::NonlinearConstraint::Type, double, double>(),
+            py::arg("function"),
+            py::arg("type")=DE::Optimize::NonlinearConstraint::Inequality,
+            py::arg("cost")=1.0, py::arg("tolerance")=0.0)
+        .def_readwrite("type", &DE::Optimize::NonlinearConstraint::type)
+        .def_readwrite("cost", &DE::Optimize::NonlinearConstraint::cost)
+        .def_readwrite("tolerance", &DE::Optimize::NonlinearConstraint::tolerance)
+        .def("Violation", &DE::Optimize::NonlinearConstraint::Violation);
+
+    py::enum_<DE::ConstraintHandling>(m, "ConstraintHandling")
+        .value("FeasibilityRules", DE::ConstraintHandling::FeasibilityRules)
+        .value("EpsilonConstrained", DE::ConstraintHandling::EpsilonConstrained);
+
+    // IPOP/BIPOP restarts
+    py::enum_<DE::RestartStrategy>(m, "RestartStrategy")
+        .value("IPOP", DE::RestartStrategy::IPOP)
+        .value("BIPOP", DE::RestartStrategy::BIPOP);
+    py::enum_<DE::RestartReason>(m, "RestartReason")
+        .value("NoImprovement", DE::RestartReason::NoImprovement)
+        .value("LowDiversity", DE::RestartReason::LowDiversity)
+        .value("FlatCosts", DE::RestartReason::FlatCosts);
+    py::class_<DE::RestartConfig>(m, "RestartConfig")
+        .def(py::init<DE::RestartStrategy, unsigned int, double, double, double, double, unsigned int, unsigned int>(),
+            py::arg("strategy")=DE::RestartStrategy::IPOP, py::arg("stagnationGenerations")=50,
+            py::arg("improvementTolerance")=1e-12, py::arg("diversityTolerance")=1e-8,
+            py::arg("costTolerance")=1e-12, py::arg("populationFactor")=2.0,
+            py::arg("maxPopulationSize")=0, py::arg("maxRestarts")=9)
+        .def_readwrite("strategy", &DE::RestartConfig::strategy)
+        .def_readwrite("stagnationGenerations", &DE::RestartConfig::stagnationGenerations)
+        .def_readwrite("improvementTolerance", &DE::RestartConfig::improvementTolerance)
+        .def_readwrite("diversityTolerance", &DE::RestartConfig::diversityTolerance)
+        .def_readwrite("costTolerance", &DE::RestartConfig::costTolerance)
+        .def_readwrite("populationFactor", &DE::RestartConfig::populationFactor)
+        .def_readwrite("maxPopulationSize", &DE::RestartConfig::maxPopulationSize)
+        .def_readwrite("maxRestarts", &DE::RestartConfig::maxRestarts);
+    // Dynamic objective: fractions re-evaluated or replaced when the data changes
+    py::class_<DE::DynamicConfig>(m, "DynamicConfig")
+        .def(py::init<double, double, double>(),
+            py::arg("eliteFraction")=0.1, py::arg("sampleFraction")=0.1, py::arg("immigrantFraction")=0.1)
+        .def_readwrite("eliteFraction", &DE::DynamicConfig::eliteFraction)
+        .def_readwrite("sampleFraction", &DE::DynamicConfig::sampleFraction)
+        .def_readwrite("immigrantFraction", &DE::DynamicConfig::immigrantFraction);
+    // Deadline and cancellation
+    py::enum_<DE::StopReason>(m, "StopReason")
+        .value("Completed", DE::StopReason::Completed)
+        .value("Deadline", DE::StopReason::Deadline)
+        .value("Cancelled", DE::StopReason::Cancelled);
+    py::class_<DE::CancellationToken, std::shared_ptr<DE::CancellationToken>>(m, "CancellationToken")
+        // handleSignals: a Ctrl-C (or any signal handler raising) while the optimizer runs cancels the token
+        .def(py::init([](bool handleSignals, double pollInterval){
+                std::function<bool()> poll;
+                if (handleSignals){
+                    poll = []{
+                        py::gil_scoped_acquire gil;
+                        if (PyErr_CheckSignals() != 0){
+                            PyErr_Clear();
+                            return true;
+                        }
+                        return false;
+                    };
+                }
+                return std::make_shared<DE::CancellationToken>(poll, pollInterval);
+            }),
+            py::arg("handleSignals")=false, py::arg("pollInterval")=0.05)
+        .def("Cancel", &DE::CancellationToken::Cancel)
+        .def("Reset", &DE::CancellationToken::Reset)
+        .def("IsCancelled", &DE::CancellationToken::IsCancelled);
+    // Profiling (per-phase wall time and hardware counters; NaN counters when unavailable)
+    py::class_<DE::PhaseCounters>(m, "PhaseCounters")
+        .def_readonly("calls", &DE::PhaseCounters::calls)
+        .def_readonly("seconds", &DE::PhaseCounters::seconds)
+        .def_readonly("cycles", &DE::PhaseCounters::cycles)
+        .def_readonly("instructions", &DE::PhaseCounters::instructions)
+        .def_readonly("llcMisses", &DE::PhaseCounters::llcMisses)
+        .def_readonly("branchMisses", &DE::PhaseCounters::branchMisses)
+        .def_property_readonly("ipc", &DE::PhaseCounters::IPC);
+    py::class_<DE::PerfReport>(m, "PerfReport")
+        .def_readonly("countersAvailable", &DE::PerfReport::countersAvailable)
+        .def_readonly("reason", &DE::PerfReport::reason)
+        .def_readonly("trialConstruction", &DE::PerfReport::trialConstruction)
+        .def_readonly("evaluation", &DE::PerfReport::evaluation)
+        .def_readonly("selection", &DE::PerfReport::selection);
+    // Initial population sampling
+    py::enum_<DE::Initialization>(m, "Initialization")
+        .value("Uniform", DE::Initialization::Uniform)
+        .value("LatinHypercube", DE::Initialization::LatinHypercube)
+        .value("Sobol", DE::Initialization::Sobol)
+        .value("Opposition", DE::Initialization::Opposition);
+
+    // Local search polishing
+    py::enum_<DE::PolishMethod>(m, "PolishMethod")
+        .value("NelderMead", DE::PolishMethod::NelderMead)
+        .value("LBFGSB", DE::PolishMethod::LBFGSB);
+    py::class_<DE::PolishConfig>(m, "PolishConfig")
+        .def(py::init<DE::PolishMethod, unsigned int, double, unsigned int, unsigned int, bool, unsigned int, double>(),
+            py::arg("method")=DE::PolishMethod::LBFGSB, py::arg("maxEvaluations")=1000,
+            py::arg("tolerance")=1e-10, py::arg("everyGenerations")=0, py::arg("numOfAgents")=1,
+            py::arg("finalPolish")=true, py::arg("memory")=10, py::arg("differenceStep")=1.4901161193847656e-08)
+        .def_readwrite("method", &DE::PolishConfig::method)
+        .def_readwrite("maxEvaluations", &DE::PolishConfig::maxEvaluations)
+        .def_readwrite("tolerance", &DE::PolishConfig::tolerance)
+        .def_readwrite("everyGenerations", &DE::PolishConfig::everyGenerations)
+        .def_readwrite("numOfAgents", &DE::PolishConfig::numOfAgents)
+        .def_readwrite("finalPolish", &DE::PolishConfig::finalPolish)
+        .def_readwrite("memory", &DE::PolishConfig::memory)
+        .def_readwrite("differenceStep", &DE::PolishConfig::differenceStep);
+    py::class_<DE::PolishResult>(m, "PolishResult")
+        .def_readonly("x", &DE::PolishResult::x)
+        .def_readonly("cost", &DE::PolishResult::cost)
+        .def_readonly("startCost", &DE::PolishResult::startCost)
+        .def_readonly("evaluations", &DE::PolishResult::evaluations)
+        .def_readonly("iterations", &DE::PolishResult::iterations)
+        .def_readonly("converged", &DE::PolishResult::converged);
+
+    py::class_<DE::RestartRecord>(m, "RestartRecord")
+        .def_readonly("generation", &DE::RestartRecord::generation)
+        .def_readonly("evaluations", &DE::RestartRecord::evaluations)
+        .def_readonly("oldPopulationSize", &DE::RestartRecord::oldPopulationSize)
+        .def_readonly("newPopulationSize", &DE::RestartRecord::newPopulationSize)
+        .def_readonly("bestCost", &DE::RestartRecord::bestCost)
+        .def_readonly("reason", &DE::RestartRecord::reason);
+
+    // Separable objectives (implemented in C++)
+    py::class_<DE::SeparableOptimize, DE::Optimize, std::shared_ptr<DE::SeparableOptimize>>(m, "SeparableOptimize")
+        .def("numOfTerms", &DE::SeparableOptimize::numOfTerms)
+        .def("TermOfParameter", &DE::SeparableOptimize::TermOfParameter, py::arg("parameter"))
+        .def("EvaluateTerm", [](const DE::SeparableOptimize& self, unsigned int t, const std::vector<double>& x){
+                return self.EvaluateTerm(t, x);
+            },
+            py::arg("term"), py::arg("input"))
+        .def("ConstantTerm", &DE::SeparableOptimize::ConstantTerm);
+
     // Default function
-    py::class_<DE::Func, DE::Optimize, std::shared_ptr<DE::Func>>(m, "Func")
+    py::class_<DE::Func, DE::SeparableOptimize, std::shared_ptr<DE::Func>>(m, "Func")
         .def(py::init<unsigned int>())
         .def("EvaluateCost", &DE::Func::EvaluateCost)
         .def("numOfParameters", &DE::Func::numOfParameters)
@@ -66,36 +522,311 @@ PYBIND11_MODULE(pyde, m) {
         
     // Custom function
     py::class_<DE::customFunction, DE::Optimize, std::shared_ptr<DE::customFunction>>(m, "customFunction")
-        .def(py::init<unsigned int, std::function<double(const std::vector<double>&)>,double,double >())
+        // Python callables receive a read-only memoryview of the agent
+        .def(py::init([](unsigned int dimension, py::function func, double lower, double upper){
+                // the callable is only released with the GIL held
+                std::shared_ptr<py::function> f(new py::function(func), [](py::function* p){
+                    py::gil_scoped_acquire gil;
+                    delete p;
+                });
+                return std::make_shared<DE::customFunction>(dimension,
+                    [f](const double* x, unsigned int n){
+                        py::gil_scoped_acquire gil;
+                        return CallWithView(*f, x, n);
+                    },
+                    lower, upper);
+            }),
+            py::arg("dimension"), py::arg("func"), py::arg("lower_bound"), py::arg("upper_bound"))
         .def("EvaluateCost", &DE::customFunction::EvaluateCost)
         .def("numOfParameters", &DE::customFunction::numOfParameters)
-        .def("getConstraints", &DE::customFunction::getConstraints);
+        .def("getConstraints", &DE::customFunction::getConstraints)
+        .def("AddConstraint", &DE::customFunction::AddConstraint, py::arg("constraint"))
+        .def("UpdateData", &DE::customFunction::UpdateData);
 
-    // DifferentialEvolution
-    py::class_<DE::DifferentialEvolution>(m,"DifferentialEvolution")
-        .def(py::init<const DE::Optimize&,unsigned int, double, double, int, bool,
-            std::function<void(const DE::DifferentialEvolution&)>,
-            std::function<bool(const DE::DifferentialEvolution&)>>(),
-            
-            // init arguments
-            py::arg("costFunction"), 
-            py::arg("populationSize"),
-            py::arg("F"), 
-            py::arg("CR"), 
-            py::arg("RandomSeed"),
-            py::arg("shouldCheckConstraint"), py::arg("callback"), py::arg("terminationCondition"))
-        // InitializePopulation operation
-        .def("InitializePopulation",&DE::DifferentialEvolution::InitializePopulation)
-        // get the population
-        .def("getPopulation",&DE::DifferentialEvolution::getPopulation)
-        // SelectAndCross
-        .def("SelectAndCross",&DE::DifferentialEvolution::SelectAndCross)
-        .def("GetBestAgent",&DE::DifferentialEvolution::GetBestAgent)
-        .def("GetBestCost",&DE::DifferentialEvolution::GetBestCost)
-        .def("GetPopulationCost",&DE::DifferentialEvolution::GetPopulationCost)
-
-        .def("PrintPopulation",&DE::DifferentialEvolution::printPopulation)
-        .def("OptimizeStep",&DE::DifferentialEvolution::OptimizeStep,
-            py::arg("iterations"), py::arg("verbose")=true);
+    // Expression objective: compiled to native code, no Python call per evaluation
+    py::class_<DE::ExpressionObjective, DE::Optimize, std::shared_ptr<DE::ExpressionObjective>>(m, "ExpressionObjective")
+        .def(py::init<const std::string&, unsigned int, double, double>(),
+            py::arg("expression"), py::arg("dimension"), py::arg("lower_bound"), py::arg("upper_bound"))
+        .def(py::init([](py::object ast, unsigned int dimension, double lower, double upper){
+                return std::make_shared<DE::ExpressionObjective>(ExpressionFromPython(ast), dimension, lower, upper);
+            }),
+            py::arg("expression"), py::arg("dimension"), py::arg("lower_bound"), py::arg("upper_bound"))
+        .def("EvaluateCost", &DE::ExpressionObjective::EvaluateCost)
+        .def("numOfParameters", &DE::ExpressionObjective::numOfParameters)
+        .def("getConstraints", &DE::ExpressionObjective::getConstraints)
+        .def("numOfInstructions", [](const DE::ExpressionObjective& self){
+                return self.Program().numOfInstructions();
+            })
+        .def_property_readonly("expression", &DE::ExpressionObjective::Text);
+
+    // Batch evaluators
+    py::class_<DE::Evaluator, std::shared_ptr<DE::Evaluator>>(m, "Evaluator");
+
+    py::class_<DE::SerialEvaluator, DE::Evaluator, std::shared_ptr<DE::SerialEvaluator>>(m, "SerialEvaluator")
+        .def(py::init<const DE::Optimize&>(), py::arg("costFunction"), py::keep_alive<1, 2>());
+
+    // Batches of an ExpressionObjective in blocks of 32 agents
+    py::class_<DE::ExpressionEvaluator, DE::Evaluator, std::shared_ptr<DE::ExpressionEvaluator>>(m, "ExpressionEvaluator")
+        .def(py::init<const DE::ExpressionObjective&>(), py::arg("objective"), py::keep_alive<1, 2>());
+
+    // NumPy-vectorized Python objective: func receives a read-only (n, dim) memoryview
+    // (numpy.asarray(x) for an array) and returns the n costs
+    py::class_<DE::VectorizedEvaluator, DE::Evaluator, std::shared_ptr<DE::VectorizedEvaluator>>(m, "VectorizedEvaluator")
+        .def(py::init([](unsigned int dimension, py::function func){
+                std::shared_ptr<py::function> f(new py::function(func), [](py::function* p){
+                    py::gil_scoped_acquire gil;
+                    delete p;
+                });
+                return std::make_shared<DE::VectorizedEvaluator>(dimension,
+                    [f](const double* x, size_t n, unsigned int dim, double* costs){
+                        py::gil_scoped_acquire gil;
+                        std::vector<double> result = CallWithBuffer<std::vector<double>>(*f, x,
+                            {static_cast<py::ssize_t>(n), static_cast<py::ssize_t>(dim)},
+                            {static_cast<py::ssize_t>(dim * sizeof(double)), static_cast<py::ssize_t>(sizeof(double))});
+                        if (result.size() != n){
+                            throw py::value_error("VectorizedEvaluator: expected " + std::to_string(n) +
+                                                  " costs, got " + std::to_string(result.size()));
+                        }
+                        std::copy(result.begin(), result.end(), costs);
+                    });
+            }),
+            py::arg("dimension"), py::arg("func"));
+
+    py::class_<DE::ProcessPoolEvaluator, DE::Evaluator, std::shared_ptr<DE::ProcessPoolEvaluator>>(m, "ProcessPoolEvaluator")
+        .def(py::init([](const DE::Optimize& costFunction, unsigned int numOfWorkers, unsigned int queueDepth){
+                // fork() from Python: keep the interpreter state consistent in the parent and the children
+                PyOS_BeforeFork();
+                try{
+                    auto pool = std::make_shared<DE::ProcessPoolEvaluator>(
+                        costFunction, numOfWorkers, queueDepth, []{ PyOS_AfterFork_Child(); });
+                    PyOS_AfterFork_Parent();
+                    return pool;
+                }
+                catch (...){
+                    PyOS_AfterFork_Parent();
+                    throw;
+                }
+            }),
+            py::arg("costFunction"), py::arg("numOfWorkers"), py::arg("queueDepth")=4,
+            py::keep_alive<1, 2>())
+        .def("numOfProcesses", &DE::ProcessPoolEvaluator::numOfProcesses);
+
+    // NUMA topology and pinned thread pools
+    py::class_<DE::CpuTopology>(m, "CpuTopology")
+        .def(py::init<const std::string&>(), py::arg("nodePath")="/sys/devices/system/node")
+        .def("numOfNodes", &DE::CpuTopology::numOfNodes)
+        .def("Cpus", &DE::CpuTopology::Cpus, py::arg("node"))
+        .def("NodeOfCpu", &DE::CpuTopology::NodeOfCpu, py::arg("cpu"))
+        .def("Placement", &DE::CpuTopology::Placement, py::arg("numOfThreads"), py::arg("spread")=true);
+
+    py::class_<DE::ThreadPool, std::shared_ptr<DE::ThreadPool>>(m, "ThreadPool")
+        .def(py::init<unsigned int, const std::vector<std::vector<int>>&>(),
+            py::arg("numOfThreads")=0, py::arg("cpuSets")=std::vector<std::vector<int>>())
+        .def("numOfThreads", &DE::ThreadPool::numOfThreads)
+        .def("WorkerCpus", &DE::ThreadPool::WorkerCpus, py::arg("worker"));
+
+    py::class_<DE::ThreadPoolEvaluator, DE::Evaluator, std::shared_ptr<DE::ThreadPoolEvaluator>>(m, "ThreadPoolEvaluator")
+        // firstTouch=None: only with more than one NUMA node
+        .def(py::init([](const DE::Optimize& costFunction, DE::ThreadPool& pool, std::optional<bool> firstTouch){
+                return firstTouch ? std::make_shared<DE::ThreadPoolEvaluator>(costFunction, pool, *firstTouch)
+                                  : std::make_shared<DE::ThreadPoolEvaluator>(costFunction, pool);
+            }),
+            py::arg("costFunction"), py::arg("pool"), py::arg("firstTouch")=py::none(),
+            py::keep_alive<1, 2>(), py::keep_alive<1, 3>())
+        .def("FirstTouch", &DE::ThreadPoolEvaluator::FirstTouch);
+
+    // Evaluation trace
+    py::class_<DE::TraceRecorder, std::shared_ptr<DE::TraceRecorder>>(m, "TraceRecorder")
+        .def(py::init<const std::string&, unsigned int, unsigned int>(),
+            py::arg("path"), py::arg("dim"), py::arg("ringCapacity")=4096)
+        .def("Close", &DE::TraceRecorder::Close, py::call_guard<py::gil_scoped_release>())
+        .def("numOfRecords", &DE::TraceRecorder::numOfRecords);
+
+    // Map a trace file into NumPy arrays; costs and vectors are views of the mapping
+    m.def("LoadTrace", [](const std::string& path){
+            auto reader = std::make_shared<DE::TraceReader>(path);
+            // the arrays keep the mapping alive through this capsule
+            py::capsule owner(new std::shared_ptr<DE::TraceReader>(reader), [](void* p){
+                delete static_cast<std::shared_ptr<DE::TraceReader>*>(p);
+            });
+            py::ssize_t n = static_cast<py::ssize_t>(reader->size());
+            py::ssize_t d = reader->numOfParameters();
+            py::ssize_t row = (d + 1) * static_cast<py::ssize_t>(sizeof(double));
+
+            py::array_t<double> costs({n}, {row}, reader->Rows(), owner);
+            py::array_t<double> vectors({n, d}, {row, static_cast<py::ssize_t>(sizeof(double))}, reader->Rows() + 1, owner);
+            // the mapping is read-only
+            costs.attr("setflags")(py::arg("write")=false);
+            vectors.attr("setflags")(py::arg("write")=false);
+
+            py::dict trace;
+            trace["vectors"] = vectors;
+            trace["costs"] = costs;
+            trace["generation"] = py::array_t<uint32_t>({n}, reader->Generations().data(), owner);
+            trace["index"] = py::array_t<uint32_t>({n}, reader->Indices().data(), owner);
+            trace["accepted"] = py::array_t<uint8_t>({n}, reader->Accepted().data(), owner).attr("astype")("bool");
+            return trace;
+        },
+        py::arg("path"));
+
+    // Population statistics; vectors are returned as NumPy arrays (O(dim) copies)
+    auto toArray = [](const std::vector<double>& v){
+        return py::array_t<double>(static_cast<py::ssize_t>(v.size()), v.data());
+    };
+    BindDifferentialEvolution<double>(m, "DifferentialEvolution", "PopulationStatistics", toArray);
+    // Same API with single-precision population storage
+    BindDifferentialEvolution<float>(m, "DifferentialEvolutionFloat", "PopulationStatisticsFloat", toArray);
+
+    // Multi-run engine
+    py::class_<DE::RunConfig>(m, "RunConfig")
+        .def(py::init<unsigned int, double, double, int, int, bool>(),
+            py::arg("populationSize")=50, py::arg("F")=0.8, py::arg("CR")=0.9,
+            py::arg("RandomSeed")=123, py::arg("iterations")=1000,
+            py::arg("shouldCheckConstraint")=true)
+        .def_readwrite("populationSize", &DE::RunConfig::populationSize)
+        .def_readwrite("F", &DE::RunConfig::F)
+        .def_readwrite("CR", &DE::RunConfig::CR)
+        .def_readwrite("RandomSeed", &DE::RunConfig::RandomSeed)
+        .def_readwrite("iterations", &DE::RunConfig::iterations)
+        .def_readwrite("shouldCheckConstraint", &DE::RunConfig::shouldCheckConstraint);
+
+    py::class_<DE::RunResult>(m, "RunResult")
+        .def_readonly("bestAgent", &DE::RunResult::bestAgent)
+        .def_readonly("bestCost", &DE::RunResult::bestCost)
+        .def_readonly("generations", &DE::RunResult::generations)
+        .def_readonly("evaluations", &DE::RunResult::evaluations);
+
+    // jobs: list of (costFunction, RunConfig); results are returned in job order
+    m.def("RunMany",
+        [](const std::vector<std::pair<std::shared_ptr<DE::Optimize>, DE::RunConfig>>& jobs,
+           unsigned int numOfThreads, bool nodeLocal){
+            std::vector<DE::RunJob> runJobs;
+            for (const auto& job : jobs){
+                runJobs.emplace_back(*job.first, job.second);
+            }
+            py::gil_scoped_release release;
+            DE::MultiRun multiRun(numOfThreads, nodeLocal);
+            return multiRun.Run(runJobs);
+        },
+        py::arg("jobs"), py::arg("numOfThreads")=0, py::arg("nodeLocal")=false);
+
+    // Multi-objective (GDE3)
+    py::class_<DE::MultiObjective, std::shared_ptr<DE::MultiObjective>>(m, "MultiObjective")
+        .def("numOfObjectives", &DE::MultiObjective::numOfObjectives)
+        .def("numOfParameters", &DE::MultiObjective::numOfParameters)
+        .def("getConstraints", &DE::MultiObjective::getConstraints);
+
+    py::class_<DE::customMultiObjective, DE::MultiObjective, std::shared_ptr<DE::customMultiObjective>>(m, "customMultiObjective")
+        // func receives a read-only memoryview of the agent and returns numOfObjectives costs
+        .def(py::init([](unsigned int dimension, unsigned int numOfObjectives, py::function func, double lower, double upper){
+                std::shared_ptr<py::function> f(new py::function(func), [](py::function* p){
+                    py::gil_scoped_acquire gil;
+                    delete p;
+                });
+                return std::make_shared<DE::customMultiObjective>(dimension, numOfObjectives,
+                    [f, numOfObjectives](const double* x, unsigned int n, double* costs){
+                        py::gil_scoped_acquire gil;
+                        std::vector<double> c = CallWithView<std::vector<double>>(*f, x, n);
+                        if (c.size() != numOfObjectives){
+                            throw py::value_error("The objective must return numOfObjectives costs");
+                        }
+                        std::copy(c.begin(), c.end(), costs);
+                    },
+                    lower, upper);
+            }),
+            py::arg("dimension"), py::arg("numOfObjectives"), py::arg("func"),
+            py::arg("lower_bound"), py::arg("upper_bound"))
+        .def("AddConstraint", &DE::customMultiObjective::AddConstraint, py::arg("constraint"));
+
+    // rows x cols NumPy array of a vector of rows
+    auto toMatrix = [](const std::vector<std::vector<double>>& rows, size_t cols){
+        py::array_t<double> a({static_cast<py::ssize_t>(rows.size()), static_cast<py::ssize_t>(cols)});
+        double* out = a.mutable_data();
+        for (const auto& r : rows){
+            out = std::copy(r.begin(), r.end(), out);
+        }
+        return a;
+    };
+    py::class_<DE::MultiObjectiveDE>(m, "MultiObjectiveDE")
+        .def(py::init<const DE::MultiObjective&, unsigned int, double, double, int>(),
+            py::arg("costFunction"), py::arg("populationSize")=100, py::arg("F")=0.5, py::arg("CR")=0.1,
+            py::arg("RandomSeed")=123, py::keep_alive<1, 2>())
+        .def("SetThreadPool", &DE::MultiObjectiveDE::SetThreadPool, py::arg("threadPool"), py::keep_alive<1, 2>())
+        .def("SetInitialization", &DE::MultiObjectiveDE::SetInitialization,
+            py::arg("method"), py::arg("unboundedScale")=1.0)
+        .def("InitializePopulation", &DE::MultiObjectiveDE::InitializePopulation,
+            py::call_guard<py::gil_scoped_release>())
+        .def("SelectAndCross", &DE::MultiObjectiveDE::SelectAndCross,
+            py::call_guard<py::gil_scoped_release>())
+        .def("OptimizeStep", &DE::MultiObjectiveDE::OptimizeStep, py::arg("iterations"),
+            py::call_guard<py::gil_scoped_release>())
+        .def("GetRanks", &DE::MultiObjectiveDE::GetRanks)
+        // Pareto front (costs) and Pareto set (parameters) as NumPy arrays, one row per individual
+        .def("GetParetoFront", [toMatrix](const DE::MultiObjectiveDE& self){
+                return toMatrix(self.GetParetoFront(), self.GetNumOfObjectives());
+            })
+        .def("GetParetoSet", [toMatrix](const DE::MultiObjectiveDE& self){
+                return toMatrix(self.GetParetoSet(), self.GetNumOfParameters());
+            })
+        .def("getPopulation", [toMatrix](const DE::MultiObjectiveDE& self){
+                return toMatrix(self.getPopulation(), self.GetNumOfParameters());
+            })
+        .def("GetPopulationCosts", [toMatrix](const DE::MultiObjectiveDE& self){
+                return toMatrix(self.GetPopulationCosts(), self.GetNumOfObjectives());
+            })
+        .def("GetNumOfObjectives", &DE::MultiObjectiveDE::GetNumOfObjectives)
+        .def("GetNumOfParameters", &DE::MultiObjectiveDE::GetNumOfParameters)
+        .def("GetGeneration", &DE::MultiObjectiveDE::GetGeneration)
+        .def("GetNumOfEvaluations", &DE::MultiObjectiveDE::GetNumOfEvaluations);
+
+    // Ranks of the rows of an N x M cost array (0 = Pareto front)
+    m.def("NonDominatedSort", [](const std::vector<std::vector<double>>& costs){
+            return DE::NonDominatedSort(costs);
+        },
+        py::arg("costs"));
+
+    // Cooperative coevolution
+    py::enum_<DE::Grouping>(m, "Grouping")
+        .value("Random", DE::Grouping::Random)
+        .value("Fixed", DE::Grouping::Fixed)
+        .value("Differential", DE::Grouping::Differential);
+    py::class_<DE::CoevolutionConfig>(m, "CoevolutionConfig")
+        .def(py::init<DE::Grouping, unsigned int, std::vector<std::vector<unsigned int>>, unsigned int,
+                      double, double, unsigned int, double, bool, bool>(),
+            py::arg("grouping")=DE::Grouping::Random, py::arg("groupSize")=50,
+            py::arg("groups")=std::vector<std::vector<unsigned int>>(), py::arg("populationSize")=30,
+            py::arg("F")=0.5, py::arg("CR")=0.9, py::arg("generationsPerCycle")=20,
+            py::arg("interactionThreshold")=0.0, py::arg("regroup")=false,
+            py::arg("shouldCheckConstraint")=true)
+        .def_readwrite("grouping", &DE::CoevolutionConfig::grouping)
+        .def_readwrite("groupSize", &DE::CoevolutionConfig::groupSize)
+        .def_readwrite("groups", &DE::CoevolutionConfig::groups)
+        .def_readwrite("populationSize", &DE::CoevolutionConfig::populationSize)
+        .def_readwrite("F", &DE::CoevolutionConfig::F)
+        .def_readwrite("CR", &DE::CoevolutionConfig::CR)
+        .def_readwrite("generationsPerCycle", &DE::CoevolutionConfig::generationsPerCycle)
+        .def_readwrite("interactionThreshold", &DE::CoevolutionConfig::interactionThreshold)
+        .def_readwrite("regroup", &DE::CoevolutionConfig::regroup)
+        .def_readwrite("shouldCheckConstraint", &DE::CoevolutionConfig::shouldCheckConstraint);
+
+    py::class_<DE::CooperativeCoevolution>(m, "CooperativeCoevolution")
+        .def(py::init<const DE::Optimize&, const DE::CoevolutionConfig&, int>(),
+            py::arg("costFunction"), py::arg("config")=DE::CoevolutionConfig(), py::arg("RandomSeed")=123,
+            py::keep_alive<1, 2>())
+        .def("SetThreadPool", &DE::CooperativeCoevolution::SetThreadPool, py::arg("threadPool"), py::keep_alive<1, 2>())
+        // the groups call Python objectives from the pool's workers
+        .def("InitializePopulation", &DE::CooperativeCoevolution::InitializePopulation,
+            py::call_guard<py::gil_scoped_release>())
+        .def("Cycle", &DE::CooperativeCoevolution::Cycle,
+            py::call_guard<py::gil_scoped_release>())
+        .def("OptimizeStep", &DE::CooperativeCoevolution::OptimizeStep, py::arg("cycles"),
+            py::call_guard<py::gil_scoped_release>())
+        .def("GetBestAgent", [toArray](const DE::CooperativeCoevolution& self){ return toArray(self.GetBestAgent()); })
+        .def("GetBestCost", &DE::CooperativeCoevolution::GetBestCost)
+        .def("GetBestViolation", &DE::CooperativeCoevolution::GetBestViolation)
+        .def("GetGroups", &DE::CooperativeCoevolution::GetGroups)
+        .def("GetCycle", &DE::CooperativeCoevolution::GetCycle)
+        .def("GetNumOfEvaluations", &DE::CooperativeCoevolution::GetNumOfEvaluations)
+        .def("GetNumOfGroupingEvaluations", &DE::CooperativeCoevolution::GetNumOfGroupingEvaluations);
 
 }
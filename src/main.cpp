@@ -1,9 +1,506 @@
 
+
 #include "../include/DE.h"
 #include "../include/functions.h"
+#include "../include/thread_pool.h"
+#include "../include/thread_pool_evaluator.h"
+#include "../include/plugin_objective.h"
+#include "../include/expression.h"
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+#include <stdexcept>
+#include <csignal>
+#include <cstdio>
+#include <limits>
+
+// Native runner: DE [--config file] [--key value ...]
+// (without arguments the Func(4) demo below runs as before)
+
+static const char* usage =
+    "usage: DE [--config file] [--key value ...]\n"
+    "  objective       --plugin lib.so [--objective name] [--options string]\n"
+    "                  | --expression text [--lower l] [--upper u]   (-100, 100 for every parameter)\n"
+    "                  (neither: the built-in objective \"func\")\n"
+    "  --dimension n            number of parameters (4)\n"
+    "  --population n           population size (50)\n"
+    "  --F f --CR cr            weight and crossover rate (0.5, 0.5)\n"
+    "  --strategy s             mutation and crossover: rand1bin (rand1bin)\n"
+    "  --mode m                 serial | deterministic | batch (serial; deterministic with --threads > 1)\n"
+    "  --threads n              worker threads (1)\n"
+    "  --restart s              none | ipop | bipop (none)\n"
+    "  --initialization s       uniform | lhs | sobol | opposition (uniform)\n"
+    "  --generations n          generations per run (1000)\n"
+    "  --max-evaluations n      evaluations per run (0: unlimited)\n"
+    "  --time-budget s          seconds per run (0: unlimited)\n"
+    "  --seeds list             one run per seed, e.g. 1,2,10-19 (123)\n"
+    "  --output file            JSON results (default: standard output)\n"
+    "  --verbose true|false     print every generation to standard error (false)\n"
+    "A config file holds the same keys as \"key = value\" lines (# comments); flags override it.\n";
+
+// Run configuration
+struct RunnerConfig
+{
+    std::string plugin;
+    std::string objective;
+    std::string options;
+    std::string expression;
+    double lower = -100;
+    double upper = 100;
+    unsigned int dimension = 4;
+    unsigned int populationSize = 50;
+    double F = 0.5;
+    double CR = 0.5;
+    // DE/rand/1/bin是目前唯一的strategy
+    std::string strategy = "rand1bin";
+    std::string mode;
+    unsigned int threads = 1;
+    std::string restart = "none";
+    std::string initialization = "uniform";
+    int generations = 1000;
+    unsigned long long maxEvaluations = 0;
+    double timeBudget = 0;
+    std::vector<int> seeds{123};
+    std::string output;
+    bool verbose = false;
+};
+
+// 數值必須完整 (不接受"12abc") 錯誤訊息包含key與value
+template <class T, class Convert>
+static T ParseNumber(const std::string& key, const std::string& value, Convert convert)
+{
+    try{
+        size_t used = 0;
+        T number = convert(value, &used);
+        if (used == value.size()){
+            return number;
+        }
+    }
+    catch (const std::logic_error&){
+        // std::invalid_argument or std::out_of_range
+    }
+    throw std::invalid_argument("invalid value \"" + value + "\" for " + key);
+}
+
+static double ToDouble(const std::string& key, const std::string& value)
+{
+    return ParseNumber<double>(key, value, [](const std::string& s, size_t* used){ return std::stod(s, used); });
+}
+
+static int ToInt(const std::string& key, const std::string& value)
+{
+    return ParseNumber<int>(key, value, [](const std::string& s, size_t* used){ return std::stoi(s, used); });
+}
+
+// std::stoul accepts "-1" (as ULONG_MAX)
+static unsigned long long ToUnsigned(const std::string& key, const std::string& value,
+                                     unsigned long long max = std::numeric_limits<unsigned int>::max())
+{
+    unsigned long long number = ParseNumber<unsigned long long>(key, value,
+        [](const std::string& s, size_t* used){ return std::stoull(s, used); });
+    if (value.find('-') != std::string::npos || number > max){
+        throw std::invalid_argument("invalid value \"" + value + "\" for " + key);
+    }
+    return number;
+}
+
+static std::vector<int> ParseSeeds(const std::string& value)
+{
+    std::vector<int> seeds;
+    std::stringstream list(value);
+    std::string item;
+    while (std::getline(list, item, ',')){
+        size_t dash = item.find('-', 1);
+        if (dash == std::string::npos){
+            seeds.push_back(ToInt("seeds", item));
+        }
+        else{
+            int first = ToInt("seeds", item.substr(0, dash));
+            int last = ToInt("seeds", item.substr(dash + 1));
+            for (int s = first; s <= last; s++){
+                seeds.push_back(s);
+            }
+        }
+    }
+    if (seeds.empty()){
+        throw std::invalid_argument("no seeds in \"" + value + "\"");
+    }
+    return seeds;
+}
+
+static void Set(RunnerConfig& config, const std::string& key, const std::string& value)
+{
+    if (key == "plugin") config.plugin = value;
+    else if (key == "objective") config.objective = value;
+    else if (key == "options") config.options = value;
+    else if (key == "expression") config.expression = value;
+    else if (key == "lower") config.lower = ToDouble(key, value);
+    else if (key == "upper") config.upper = ToDouble(key, value);
+    else if (key == "dimension") config.dimension = ToUnsigned(key, value);
+    else if (key == "population") config.populationSize = ToUnsigned(key, value);
+    else if (key == "F") config.F = ToDouble(key, value);
+    else if (key == "CR") config.CR = ToDouble(key, value);
+    else if (key == "strategy") config.strategy = value;
+    else if (key == "mode") config.mode = value;
+    else if (key == "threads") config.threads = ToUnsigned(key, value);
+    else if (key == "restart") config.restart = value;
+    else if (key == "initialization") config.initialization = value;
+    else if (key == "generations") config.generations = ToInt(key, value);
+    else if (key == "max-evaluations") config.maxEvaluations = ToUnsigned(key, value, std::numeric_limits<unsigned long long>::max());
+    else if (key == "time-budget") config.timeBudget = ToDouble(key, value);
+    else if (key == "seeds") config.seeds = ParseSeeds(value);
+    else if (key == "output") config.output = value;
+    else if (key == "verbose") config.verbose = value == "true" || value == "1";
+    else throw std::invalid_argument("unknown option \"" + key + "\"");
+}
+
+static std::string Trim(const std::string& s)
+{
+    size_t first = s.find_first_not_of(" \t\r");
+    size_t last = s.find_last_not_of(" \t\r");
+    return first == std::string::npos ? "" : s.substr(first, last - first + 1);
+}
+
+static void ReadConfigFile(RunnerConfig& config, const std::string& path)
+{
+    std::ifstream file(path);
+    if (!file){
+        throw std::runtime_error("cannot open config file " + path);
+    }
+    std::string line;
+    int number = 0;
+    while (std::getline(file, line)){
+        number++;
+        line = Trim(line.substr(0, line.find('#')));
+        if (line.empty()){
+            continue;
+        }
+        size_t eq = line.find('=');
+        if (eq == std::string::npos){
+            throw std::invalid_argument(path + ":" + std::to_string(number) + ": expected key = value");
+        }
+        Set(config, Trim(line.substr(0, eq)), Trim(line.substr(eq + 1)));
+    }
+}
+
+static RunnerConfig ParseArguments(int argc, char** argv)
+{
+    RunnerConfig config;
+    // 先讀config file 再用flags覆寫
+    for (int i = 1; i + 1 < argc; i++){
+        if (std::string(argv[i]) == "--config"){
+            ReadConfigFile(config, argv[i + 1]);
+        }
+    }
+    for (int i = 1; i < argc; i++){
+        std::string flag = argv[i];
+        if (flag.compare(0, 2, "--") != 0 || i + 1 >= argc){
+            throw std::invalid_argument("expected --key value, got \"" + flag + "\"");
+        }
+        if (flag != "--config"){
+            Set(config, flag.substr(2), argv[i + 1]);
+        }
+        i++;
+    }
+    if (config.mode.empty()){
+        config.mode = config.threads > 1 ? "deterministic" : "serial";
+    }
+    if (config.mode != "serial" && config.mode != "deterministic" && config.mode != "batch"){
+        throw std::invalid_argument("unknown mode \"" + config.mode + "\"");
+    }
+    if (config.mode == "serial" && config.threads > 1){
+        throw std::invalid_argument("serial mode runs on one thread (use --mode deterministic or batch)");
+    }
+    if (config.strategy != "rand1bin"){
+        throw std::invalid_argument("unknown strategy \"" + config.strategy + "\" (only rand1bin is available)");
+    }
+    if (config.restart != "none" && config.restart != "ipop" && config.restart != "bipop"){
+        throw std::invalid_argument("unknown restart strategy \"" + config.restart + "\"");
+    }
+    if (config.initialization != "uniform" && config.initialization != "lhs" &&
+        config.initialization != "sobol" && config.initialization != "opposition"){
+        throw std::invalid_argument("unknown initialization \"" + config.initialization + "\"");
+    }
+    if (config.populationSize < 4 || config.dimension == 0 || config.threads == 0){
+        throw std::invalid_argument("population >= 4, dimension >= 1 and threads >= 1 are required");
+    }
+    return config;
+}
+
+
+// JSON output
+static std::string JsonString(const std::string& s)
+{
+    std::string out = "\"";
+    for (char c : s){
+        switch (c){
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20){
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    out += buffer;
+                }
+                else{
+                    out += c;
+                }
+        }
+    }
+    return out + "\"";
+}
+
+// 不是有限值的數字輸出為null
+static std::string JsonNumber(double v)
+{
+    if (!std::isfinite(v)){
+        return "null";
+    }
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.17g", v);
+    return buffer;
+}
+
+// Result of one seed
+struct SeedResult
+{
+    int seed;
+    double bestCost;
+    std::vector<double> bestAgent;
+    int generations;
+    unsigned long long evaluations;
+    double seconds;
+    std::string stopReason;
+};
+
+// SIGINT: the current run returns its best-so-far and no further seeds are run
+static DE::CancellationToken interrupt;
+
+static void OnInterrupt(int)
+{
+    interrupt.Cancel();
+}
+
+static SeedResult RunSeed(const RunnerConfig& config, const DE::Optimize& objective,
+                          DE::Evaluator* evaluator, DE::ThreadPool* pool, int seed)
+{
+    DE::DifferentialEvolution de(objective, config.populationSize, config.F, config.CR, seed);
+    if (config.mode == "deterministic"){
+        de.EnableDeterministicParallel(pool);
+    }
+    else if (config.mode == "batch"){
+        de.SetEvaluator(evaluator);
+    }
+    if (config.restart != "none"){
+        de.EnableRestarts(DE::RestartConfig(config.restart == "bipop" ? DE::RestartStrategy::BIPOP : DE::RestartStrategy::IPOP));
+    }
+    if (config.initialization == "lhs") de.SetInitialization(DE::Initialization::LatinHypercube);
+    else if (config.initialization == "sobol") de.SetInitialization(DE::Initialization::Sobol);
+    else if (config.initialization == "opposition") de.SetInitialization(DE::Initialization::Opposition);
+    de.SetCancellationToken(&interrupt);
+
+    auto start = std::chrono::steady_clock::now();
+    if (config.timeBudget > 0){
+        de.SetTimeBudget(config.timeBudget);
+    }
+    SeedResult result;
+    result.seed = seed;
+    result.stopReason = "generations";
+    de.InitializePopulation();
+    int g = 0;
+    for (; g < config.generations; g++){
+        if (config.maxEvaluations && de.GetNumOfEvaluations() >= config.maxEvaluations){
+            result.stopReason = "evaluations";
+            break;
+        }
+        de.SelectAndCross();
+        if (de.GetStopReason() != DE::StopReason::Completed){
+            result.stopReason = de.GetStopReason() == DE::StopReason::Deadline ? "time" : "interrupted";
+            break;
+        }
+        if (config.verbose){
+            std::cerr << "seed " << seed << " generation " << g << " best " << de.GetGlobalBestCost() << std::endl;
+        }
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.generations = de.GetGeneration();
+    result.evaluations = de.GetNumOfEvaluations();
+    result.bestCost = de.GetGlobalBestCost();
+    result.bestAgent = de.GetGlobalBestAgent();
+    return result;
+}
+
+static void WriteResults(std::ostream& out, const RunnerConfig& config, const std::string& objectiveName,
+                         const std::vector<SeedResult>& results, double seconds)
+{
+    out << "{\n";
+    out << "  \"objective\": {\"name\": " << JsonString(objectiveName)
+        << ", \"plugin\": " << JsonString(config.plugin)
+        << ", \"options\": " << JsonString(config.options)
+        << ", \"expression\": " << JsonString(config.expression)
+        << ", \"dimension\": " << config.dimension << "},\n";
+    out << "  \"config\": {\"population\": " << config.populationSize
+        << ", \"F\": " << JsonNumber(config.F)
+        << ", \"CR\": " << JsonNumber(config.CR)
+        << ", \"strategy\": " << JsonString(config.strategy)
+        << ", \"mode\": " << JsonString(config.mode)
+        << ", \"threads\": " << config.threads
+        << ", \"restart\": " << JsonString(config.restart)
+        << ", \"initialization\": " << JsonString(config.initialization)
+        << ", \"generations\": " << config.generations
+        << ", \"maxEvaluations\": " << config.maxEvaluations
+        << ", \"timeBudget\": " << JsonNumber(config.timeBudget) << "},\n";
+    out << "  \"runs\": [";
+    for (size_t r = 0; r < results.size(); r++){
+        const SeedResult& s = results[r];
+        out << (r ? ",\n" : "\n") << "    {\"seed\": " << s.seed
+            << ", \"bestCost\": " << JsonNumber(s.bestCost)
+            << ", \"generations\": " << s.generations
+            << ", \"evaluations\": " << s.evaluations
+            << ", \"seconds\": " << JsonNumber(s.seconds)
+            << ", \"evaluationsPerSecond\": " << JsonNumber(s.seconds > 0 ? s.evaluations / s.seconds : 0.0)
+            << ", \"stopReason\": " << JsonString(s.stopReason)
+            << ", \"bestAgent\": [";
+        for (size_t i = 0; i < s.bestAgent.size(); i++){
+            out << (i ? ", " : "") << JsonNumber(s.bestAgent[i]);
+        }
+        out << "]}";
+    }
+    out << "\n  ],\n";
+
+    // 所有seed的摘要
+    std::vector<double> costs;
+    for (const SeedResult& s : results){
+        costs.push_back(s.bestCost);
+    }
+    std::sort(costs.begin(), costs.end());
+    double mean = 0;
+    for (double c : costs){
+        mean += c / costs.size();
+    }
+    double median = costs.empty() ? NAN :
+        (costs[(costs.size() - 1) / 2] + costs[costs.size() / 2]) / 2;
+    out << "  \"summary\": {\"runs\": " << results.size()
+        << ", \"bestCost\": " << JsonNumber(costs.empty() ? NAN : costs.front())
+        << ", \"medianCost\": " << JsonNumber(median)
+        << ", \"meanCost\": " << JsonNumber(costs.empty() ? NAN : mean)
+        << ", \"worstCost\": " << JsonNumber(costs.empty() ? NAN : costs.back())
+        << ", \"seconds\": " << JsonNumber(seconds) << "}\n";
+    out << "}\n";
+}
+
+static int Run(int argc, char** argv)
+{
+    RunnerConfig config = ParseArguments(argc, argv);
+
+    // objective: plugin, expression或內建的Func
+    std::unique_ptr<DE::PluginLibrary> library;
+    std::unique_ptr<DE::Optimize> objective;
+    std::string objectiveName;
+    DE::PluginObjective* plugin = nullptr;
+    DE::ExpressionObjective* expression = nullptr;
+    if (!config.plugin.empty() && !config.expression.empty()){
+        throw std::invalid_argument("--plugin and --expression are exclusive");
+    }
+    if (!config.expression.empty()){
+        if (!(config.lower < config.upper)){
+            throw std::invalid_argument("--lower must be less than --upper");
+        }
+        expression = new DE::ExpressionObjective(config.expression, config.dimension, config.lower, config.upper);
+        objective.reset(expression);
+        objectiveName = "expression";
+    }
+    else if (!config.plugin.empty()){
+        library.reset(new DE::PluginLibrary(config.plugin));
+        plugin = new DE::PluginObjective(*library, config.objective, config.dimension, config.options);
+        objective.reset(plugin);
+        objectiveName = plugin->Name();
+        if (config.threads > 1 && !plugin->ThreadSafe()){
+            throw std::invalid_argument(objectiveName + " is not thread-safe (DE_PLUGIN_THREAD_SAFE): use --threads 1");
+        }
+    }
+    else if (config.objective.empty() || config.objective == "func"){
+        objective.reset(new DE::Func(config.dimension));
+        objectiveName = "func";
+    }
+    else{
+        throw std::invalid_argument("unknown built-in objective \"" + config.objective + "\" (use --plugin)");
+    }
+
+    // 執行緒與evaluator (所有seed共用)
+    std::unique_ptr<DE::ThreadPool> pool;
+    std::unique_ptr<DE::Evaluator> evaluator;
+    if (config.threads > 1){
+        pool.reset(new DE::ThreadPool(config.threads));
+    }
+    if (config.mode == "batch"){
+        if (pool){
+            evaluator.reset(new DE::ThreadPoolEvaluator(*objective, *pool));
+        }
+        else if (expression){
+            evaluator.reset(new DE::ExpressionEvaluator(*expression));
+        }
+        else if (plugin && plugin->HasBatch()){
+            // 整個batch一次交給plugin的evaluateBatch
+            evaluator.reset(new DE::VectorizedEvaluator(config.dimension,
+                [plugin](const double* x, size_t n, unsigned int, double* costs){
+                    plugin->EvaluateRows(x, n, costs);
+                }));
+        }
+        else{
+            evaluator.reset(new DE::SerialEvaluator(*objective));
+        }
+    }
+
+    std::signal(SIGINT, OnInterrupt);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<SeedResult> results;
+    for (int seed : config.seeds){
+        if (interrupt.IsCancelled()){
+            break;
+        }
+        results.push_back(RunSeed(config, *objective, evaluator.get(), pool.get(), seed));
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    // evaluator與objective在library之前釋放
+    evaluator.reset();
+    objective.reset();
+
+    if (config.output.empty()){
+        WriteResults(std::cout, config, objectiveName, results, seconds);
+    }
+    else{
+        std::ofstream file(config.output);
+        if (!file){
+            throw std::runtime_error("cannot write " + config.output);
+        }
+        WriteResults(file, config, objectiveName, results, seconds);
+    }
+    return interrupt.IsCancelled() ? 130 : 0;
+}
+
+int main(int argc, char** argv){
 
-int main(){
+    if (argc > 1){
+        if (std::string(argv[1]) == "--help" || std::string(argv[1]) == "-h"){
+            std::cout << usage;
+            return 0;
+        }
+        try{
+            return Run(argc, argv);
+        }
+        catch (const std::exception& e){
+            std::cerr << "DE: " << e.what() << std::endl << usage;
+            return 2;
+        }
+    }
 
     // Create a function object
     int dimension = 4;
@@ -17,8 +514,8 @@ int main(){
     // Optimize the function
     de.OptimizeStep(1000);
 
-    // print population 
-    //de.printPopulation(); 
+    // print population
+    //de.printPopulation();
     return 0;
 
-}
\ No newline at end of file
+}
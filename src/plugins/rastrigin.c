@@ -0,0 +1,112 @@
+/* Example objective plugin (C): rastrigin (default) and sphere */
+/*
+    * build: cc -O2 -shared -fPIC -I../../include rastrigin.c -o librastrigin.so -lm
+    * run:   ./DE --plugin ./librastrigin.so --dimension 10 --options A=10
+*/
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "../../include/plugin.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+typedef struct
+{
+    unsigned int dim;
+    double A;
+} State;
+
+static char lastError[128];
+
+static void* Create(unsigned int dimension, const char* options)
+{
+    State* s;
+    const char* a;
+    if (dimension == 0){
+        snprintf(lastError, sizeof(lastError), "dimension must be positive");
+        return NULL;
+    }
+    s = (State*)malloc(sizeof(State));
+    s->dim = dimension;
+    s->A = 10.0;
+    /* options: "A=<value>" */
+    a = strstr(options, "A=");
+    if (a){
+        s->A = atof(a + 2);
+    }
+    return s;
+}
+
+static void Destroy(void* state)
+{
+    free(state);
+}
+
+static void Bounds(void* state, double* lower, double* upper)
+{
+    unsigned int i;
+    for (i = 0; i < ((State*)state)->dim; i++){
+        lower[i] = -5.12;
+        upper[i] = 5.12;
+    }
+}
+
+static double Rastrigin(void* state, const double* x, unsigned int n)
+{
+    double A = ((State*)state)->A;
+    double sum = A * n;
+    unsigned int i;
+    for (i = 0; i < n; i++){
+        sum += x[i] * x[i] - A * cos(2.0 * M_PI * x[i]);
+    }
+    return sum;
+}
+
+static void RastriginBatch(void* state, const double* x, size_t rows, unsigned int n, double* costs)
+{
+    size_t r;
+    for (r = 0; r < rows; r++){
+        costs[r] = Rastrigin(state, x + r * n, n);
+    }
+}
+
+static double Sphere(void* state, const double* x, unsigned int n)
+{
+    double sum = 0.0;
+    unsigned int i;
+    (void)state;
+    for (i = 0; i < n; i++){
+        sum += x[i] * x[i];
+    }
+    return sum;
+}
+
+static const char* Error(void)
+{
+    return lastError;
+}
+
+static const DEObjectivePlugin rastrigin = {
+    DE_PLUGIN_ABI_VERSION, DE_PLUGIN_THREAD_SAFE, "rastrigin",
+    Create, Destroy, Bounds, Rastrigin, RastriginBatch, Error
+};
+
+static const DEObjectivePlugin sphere = {
+    DE_PLUGIN_ABI_VERSION, DE_PLUGIN_THREAD_SAFE, "sphere",
+    Create, Destroy, Bounds, Sphere, NULL, Error
+};
+
+const DEObjectivePlugin* de_objective_plugin(const char* name)
+{
+    if (!name || !*name || strcmp(name, "rastrigin") == 0){
+        return &rastrigin;
+    }
+    if (strcmp(name, "sphere") == 0){
+        return &sphere;
+    }
+    return NULL;
+}
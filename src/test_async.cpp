@@ -0,0 +1,166 @@
+// Checks of the coroutine-based asynchronous DE (async.h), run by CTest with -DDE_BUILD_ASYNC=ON
+#include "../include/DE.h"
+#include "../include/functions.h"
+#include "../include/async.h"
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+
+// assert() is compiled out in release builds
+static int failures = 0;
+#define CHECK(condition) \
+    do{ \
+        if (!(condition)){ \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed" << std::endl; \
+            failures++; \
+        } \
+    } while (0)
+
+// Completes without suspending: the engine sees every cost as soon as it launches the trial
+class InlineObjective : public DE::AsyncOptimize
+{
+    private:
+        const DE::Optimize& costFunction;
+
+    public:
+        explicit InlineObjective(const DE::Optimize& costFunction) : costFunction(costFunction) {}
+
+        DE::CostTask EvaluateCostAsync(std::vector<double> input) const override
+        {
+            co_return costFunction.EvaluateCost(input);
+        }
+
+        unsigned int numOfParameters() const override
+        {
+            return costFunction.numOfParameters();
+        }
+
+        std::vector<DE::Optimize::Constraint> getConstraints() const override
+        {
+            return costFunction.getConstraints();
+        }
+};
+
+// Throws from the given evaluation on
+class FailingObjective : public DE::Func
+{
+    private:
+        mutable std::atomic<int> calls{0};
+        int failAt;
+
+    public:
+        FailingObjective(unsigned int dimension, int failAt) : DE::Func(dimension), failAt(failAt) {}
+
+        double EvaluateCostView(DE::VectorView input) const override
+        {
+            if (++calls >= failAt){
+                throw std::runtime_error("objective failed");
+            }
+            return DE::Func::EvaluateCostView(input);
+        }
+};
+
+// Records how many evaluations run at the same time
+class ConcurrencyProbe : public DE::Func
+{
+    private:
+        mutable std::atomic<unsigned int> running{0};
+
+    public:
+        mutable std::atomic<unsigned int> maxRunning{0};
+
+        explicit ConcurrencyProbe(unsigned int dimension) : DE::Func(dimension) {}
+
+        double EvaluateCostView(DE::VectorView input) const override
+        {
+            unsigned int now = ++running;
+            unsigned int seen = maxRunning.load();
+            while (now > seen && !maxRunning.compare_exchange_weak(seen, now)){
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+            running--;
+            return DE::Func::EvaluateCostView(input);
+        }
+};
+
+// One trial in flight: the executor only changes the thread, not the sequence
+static void TestMatchesSynchronous()
+{
+    DE::Func f(4);
+    InlineObjective synchronous(f);
+    DE::AsyncDifferentialEvolution reference(synchronous, 20, 0.5, 0.9, 1, 7);
+    reference.OptimizeStep(50);
+
+    DE::AsyncExecutor executor(4);
+    DE::AsyncAdaptor asynchronous(f, executor);
+    DE::AsyncDifferentialEvolution de(asynchronous, 20, 0.5, 0.9, 1, 7);
+    de.OptimizeStep(50);
+
+    CHECK(de.getPopulation() == reference.getPopulation());
+    CHECK(de.GetBestCost() == reference.GetBestCost());
+    CHECK(de.GetNumOfEvaluations() == 20u * 51u);
+}
+
+// Many trials in flight: every kept agent has its own cost and the best is the minimum
+static void TestSelectionConsistent()
+{
+    DE::Func f(4);
+    DE::AsyncExecutor executor(4);
+    DE::AsyncAdaptor asynchronous(f, executor);
+    DE::AsyncDifferentialEvolution de(asynchronous, 20, 0.5, 0.9, 8, 7);
+    de.OptimizeStep(50);
+
+    double best = std::numeric_limits<double>::infinity();
+    for (const auto& agent : de.getPopulation()){
+        best = std::min(best, f.EvaluateCost(agent));
+    }
+    CHECK(de.GetBestCost() == best);
+    CHECK(f.EvaluateCost(de.GetBestAgent()) == de.GetBestCost());
+    CHECK(de.GetNumOfEvaluations() == 20u * 51u);
+}
+
+static void TestExceptionPropagates()
+{
+    FailingObjective f(4, 100);
+    DE::AsyncExecutor executor(4);
+    DE::AsyncAdaptor asynchronous(f, executor);
+    DE::AsyncDifferentialEvolution de(asynchronous, 20, 0.5, 0.9, 8);
+    bool thrown = false;
+    try{
+        de.OptimizeStep(50);
+    }
+    catch (const std::runtime_error& e){
+        thrown = std::string(e.what()) == "objective failed";
+    }
+    CHECK(thrown);
+}
+
+static void TestMaxInFlight()
+{
+    for (unsigned int maxInFlight : {1u, 3u}){
+        ConcurrencyProbe f(4);
+        DE::AsyncExecutor executor(8);
+        DE::AsyncAdaptor asynchronous(f, executor);
+        DE::AsyncDifferentialEvolution de(asynchronous, 20, 0.5, 0.9, maxInFlight);
+        de.OptimizeStep(10);
+        CHECK(f.maxRunning.load() <= maxInFlight);
+        CHECK(f.maxRunning.load() >= 1u);
+    }
+}
+
+int main(){
+
+    TestMatchesSynchronous();
+    TestSelectionConsistent();
+    TestExceptionPropagates();
+    TestMaxInFlight();
+
+    if (failures){
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "async: all checks passed" << std::endl;
+    return 0;
+
+}
@@ -0,0 +1,120 @@
+// Checks of NonDominatedSort (multi_objective.h) against the O(M N^2) definition, run by CTest
+#include "../include/multi_objective.h"
+#include <iostream>
+#include <random>
+
+// assert() is compiled out in release builds
+static int failures = 0;
+#define CHECK(condition) \
+    do{ \
+        if (!(condition)){ \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed" << std::endl; \
+            failures++; \
+        } \
+    } while (0)
+
+// rank = length of the longest chain of points dominating the point
+static std::vector<unsigned int> NaiveRanks(const std::vector<std::vector<double>>& costs)
+{
+    size_t n = costs.size();
+    std::vector<size_t> order(n);
+    for (size_t i = 0; i < n; i++){
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&costs](size_t a, size_t b){
+        return costs[a] < costs[b];
+    });
+    std::vector<unsigned int> rank(n, 0);
+    for (size_t i = 0; i < n; i++){
+        for (size_t j = 0; j < i; j++){
+            if (DE::Dominates(costs[order[j]], costs[order[i]])){
+                rank[order[i]] = std::max(rank[order[i]], rank[order[j]] + 1);
+            }
+        }
+    }
+    return rank;
+}
+
+// levels > 0: integer costs in [0, levels) (many ties and duplicates)
+static std::vector<std::vector<double>> RandomCosts(size_t n, unsigned int m, int levels, std::mt19937& generator)
+{
+    std::uniform_real_distribution<double> uniform(0, 1);
+    std::uniform_int_distribution<int> grid(0, std::max(levels, 1) - 1);
+    std::vector<std::vector<double>> costs(n, std::vector<double>(m));
+    for (auto& c : costs){
+        for (auto& v : c){
+            v = levels > 0 ? grid(generator) : uniform(generator);
+        }
+    }
+    return costs;
+}
+
+int main(){
+
+    std::mt19937 generator(42);
+
+    // N in the thousands, three objectives
+    for (int levels : {0, 20, 4}){
+        auto costs = RandomCosts(3000, 3, levels, generator);
+        CHECK(DE::NonDominatedSort(costs) == NaiveRanks(costs));
+    }
+    // 兩個及四個objectives
+    for (unsigned int m : {2u, 4u}){
+        for (int levels : {0, 6}){
+            auto costs = RandomCosts(1500, m, levels, generator);
+            CHECK(DE::NonDominatedSort(costs) == NaiveRanks(costs));
+        }
+    }
+    // many fronts: points on a line are a chain
+    {
+        std::vector<std::vector<double>> costs;
+        for (int i = 2000; i-- > 0;){
+            costs.push_back({double(i), double(i), double(i)});
+        }
+        std::vector<unsigned int> rank = DE::NonDominatedSort(costs);
+        CHECK(rank.front() == 1999 && rank.back() == 0);
+        CHECK(rank == NaiveRanks(costs));
+    }
+    // one front: a plane x + y + z = 1
+    {
+        auto costs = RandomCosts(3000, 3, 0, generator);
+        for (auto& c : costs){
+            c[2] = 1.0 - c[0] - c[1];
+            c[1] = c[1] - c[0];
+        }
+        std::vector<unsigned int> naive = NaiveRanks(costs);
+        CHECK(DE::NonDominatedSort(costs) == naive);
+    }
+    // infeasible points follow the feasible fronts, grouped by violation
+    {
+        auto costs = RandomCosts(1000, 3, 0, generator);
+        std::vector<double> violations(costs.size(), 0.0);
+        for (size_t i = 0; i < costs.size(); i += 3){
+            violations[i] = double(i % 2 + 1);
+        }
+        std::vector<std::vector<double>> feasibleCosts;
+        for (size_t i = 0; i < costs.size(); i++){
+            if (violations[i] <= 0){
+                feasibleCosts.push_back(costs[i]);
+            }
+        }
+        std::vector<unsigned int> feasibleRank = NaiveRanks(feasibleCosts);
+        unsigned int numOfFronts = *std::max_element(feasibleRank.begin(), feasibleRank.end()) + 1;
+        std::vector<unsigned int> rank = DE::NonDominatedSort(costs, &violations);
+        for (size_t i = 0, f = 0; i < costs.size(); i++){
+            if (violations[i] <= 0){
+                CHECK(rank[i] == feasibleRank[f++]);
+            }
+            else{
+                CHECK(rank[i] == numOfFronts + static_cast<unsigned int>(violations[i]) - 1);
+            }
+        }
+    }
+
+    if (failures){
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "multi_objective: all checks passed" << std::endl;
+    return 0;
+}
@@ -0,0 +1,93 @@
+// Checks of FunctionObjective / MakeObjective (functions.h), run by CTest
+#include "../include/DE.h"
+#include "../include/functions.h"
+#include <iostream>
+#include <cmath>
+
+// assert() is compiled out in release builds
+static int failures = 0;
+#define CHECK(condition) \
+    do{ \
+        if (!(condition)){ \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed" << std::endl; \
+            failures++; \
+        } \
+    } while (0)
+
+static double Rastrigin(const double* x, unsigned int n)
+{
+    double sum = 10.0 * n;
+    for (unsigned int i = 0; i < n; i++){
+        sum += x[i] * x[i] - 10.0 * std::cos(2.0 * M_PI * x[i]);
+    }
+    return sum;
+}
+
+int main(){
+
+    const unsigned int dimension = 5;
+    DE::customFunction reference(dimension, [](const std::vector<double>& x){
+        return Rastrigin(x.data(), static_cast<unsigned int>(x.size()));
+    }, -5.12, 5.12);
+
+    // fn(VectorView)
+    auto view = DE::MakeObjective(dimension, [](DE::VectorView x){
+        return Rastrigin(x.data(), x.size());
+    }, -5.12, 5.12);
+    // fn(const double*, unsigned int)
+    auto pointer = DE::MakeObjective(dimension, [](const double* x, unsigned int n){
+        return Rastrigin(x, n);
+    }, -5.12, 5.12);
+    // fn(VectorView, threshold): stops once the partial sum exceeds threshold
+    auto bounded = DE::MakeObjective(dimension, [](DE::VectorView x, double threshold){
+        double sum = 10.0 * x.size();
+        for (unsigned int i = 0; i < x.size(); i++){
+            sum += x[i] * x[i] - 10.0 * std::cos(2.0 * M_PI * x[i]);
+            // every remaining term is >= -10
+            if (sum - 10.0 * (x.size() - i - 1) > threshold){
+                return std::numeric_limits<double>::infinity();
+            }
+        }
+        return sum;
+    }, -5.12, 5.12);
+
+    const std::vector<std::vector<double>> points = {
+        {0, 0, 0, 0, 0}, {1, -2, 3.5, -4, 5}, {0.25, 0.5, -0.75, 1.25, -5.12}
+    };
+    for (const auto& x : points){
+        double cost = reference.EvaluateCost(x);
+        CHECK(view.EvaluateCost(x) == cost);
+        CHECK(pointer.EvaluateCost(x) == cost);
+        CHECK(bounded.EvaluateCost(x) == cost);
+        CHECK(view.EvaluateCostView(x) == cost);
+        CHECK(pointer.EvaluateCostView(x) == cost);
+        CHECK(bounded.EvaluateCostBounded(x, cost) == cost);
+        // below the cost: the exact cost or "worse than threshold"
+        double early = bounded.EvaluateCostBounded(x, cost / 2);
+        CHECK(early == cost || (std::isinf(early) && cost > cost / 2));
+        // without a threshold overload the bound is ignored
+        CHECK(pointer.EvaluateCostBounded(x, -1.0) == cost);
+    }
+    CHECK(view.numOfParameters() == dimension);
+    CHECK(pointer.getConstraints().size() == dimension);
+    CHECK(pointer.getConstraints()[0].lower == -5.12 && pointer.getConstraints()[0].upper == 5.12);
+
+    // The templated front end runs the same optimization as the virtual one
+    DE::DifferentialEvolution virtualDE(reference, 30, 0.5, 0.9, 11);
+    virtualDE.OptimizeStep(100, false);
+    DE::BasicDifferentialEvolution<decltype(pointer)> pointerDE(pointer, 30, 0.5, 0.9, 11);
+    pointerDE.OptimizeStep(100, false);
+    DE::BasicDifferentialEvolution<decltype(view)> viewDE(view, 30, 0.5, 0.9, 11);
+    viewDE.OptimizeStep(100, false);
+    CHECK(pointerDE.GetBestCost() == virtualDE.GetBestCost());
+    CHECK(viewDE.GetBestCost() == virtualDE.GetBestCost());
+    CHECK(pointerDE.GetBestAgent() == virtualDE.GetBestAgent());
+
+    if (failures){
+        std::cerr << failures << " check(s) failed" << std::endl;
+        return 1;
+    }
+    std::cout << "objective: all checks passed" << std::endl;
+    return 0;
+
+}
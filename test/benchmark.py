@@ -0,0 +1,418 @@
+"""
+Benchmark matrix: pyde against SciPy's differential_evolution
+
+Every case runs in a fresh interpreter, so the peak RSS read from /proc is the
+case's own and not the accumulated noise of earlier cases. The results are
+written as JSON and can be compared with a stored baseline:
+
+    python benchmark.py --output results.json
+    python benchmark.py --quick --output results.json --baseline baseline.json --threshold 0.15
+    python benchmark.py --output baseline.json          # record a new baseline
+
+The exit status is 1 when a case regresses by more than the threshold (lower
+evaluations/s, longer time-to-target, higher peak RSS or a target no longer
+reached). Baselines are machine specific: record them on the machine that
+runs the comparison.
+"""
+import argparse
+import itertools
+import json
+import math
+import os
+import platform
+import statistics
+import subprocess
+import sys
+import time
+
+
+""" Objectives """
+# (lower, upper, optimum as a function of the dimension)
+BOUNDS = {
+    "sphere": (-5.12, 5.12, lambda d: 0.0),
+    "rastrigin": (-5.12, 5.12, lambda d: 0.0),
+    "rosenbrock": (-5.0, 10.0, lambda d: 0.0),
+    "ackley": (-32.768, 32.768, lambda d: 0.0),
+    # pyde.Func: every term is at least -200 (x = 0)
+    "func": (-100.0, 100.0, lambda d: 1400.0 - 200.0 * d),
+}
+
+
+# Per-call Python objectives (one agent, pure Python)
+def sphere(x):
+    return sum(v * v for v in x)
+
+def rastrigin(x):
+    return 10.0 * len(x) + sum(v * v - 10.0 * math.cos(2.0 * math.pi * v) for v in x)
+
+def rosenbrock(x):
+    return sum(100.0 * (x[i + 1] - x[i] ** 2) ** 2 + (1.0 - x[i]) ** 2 for i in range(len(x) - 1))
+
+def ackley(x):
+    n = len(x)
+    s1 = sum(v * v for v in x)
+    s2 = sum(math.cos(2.0 * math.pi * v) for v in x)
+    return -20.0 * math.exp(-0.2 * math.sqrt(s1 / n)) - math.exp(s2 / n) + 20.0 + math.e
+
+def func(x):
+    return sum(v * v - 100.0 * math.cos(v) ** 2 - 100.0 * math.cos(v * v / 30.0) for v in x) + 1400.0
+
+PER_CALL = {"sphere": sphere, "rastrigin": rastrigin, "rosenbrock": rosenbrock, "ackley": ackley, "func": func}
+
+
+# Vectorized objectives: X has one agent per row, returns one cost per row
+def vectorized(name):
+    import numpy as np
+
+    def v_sphere(X):
+        return np.sum(X * X, axis=1)
+
+    def v_rastrigin(X):
+        return 10.0 * X.shape[1] + np.sum(X * X - 10.0 * np.cos(2.0 * np.pi * X), axis=1)
+
+    def v_rosenbrock(X):
+        return np.sum(100.0 * (X[:, 1:] - X[:, :-1] ** 2) ** 2 + (1.0 - X[:, :-1]) ** 2, axis=1)
+
+    def v_ackley(X):
+        n = X.shape[1]
+        s1 = np.sum(X * X, axis=1)
+        s2 = np.sum(np.cos(2.0 * np.pi * X), axis=1)
+        return -20.0 * np.exp(-0.2 * np.sqrt(s1 / n)) - np.exp(s2 / n) + 20.0 + np.e
+
+    def v_func(X):
+        return np.sum(X * X - 100.0 * np.cos(X) ** 2 - 100.0 * np.cos(X * X / 30.0), axis=1) + 1400.0
+
+    return {"sphere": v_sphere, "rastrigin": v_rastrigin, "rosenbrock": v_rosenbrock,
+            "ackley": v_ackley, "func": v_func}[name]
+
+
+# Expression objectives: compiled by pyde.ExpressionObjective, no Python per call
+EXPRESSIONS = {
+    "sphere": "sum(i, 0, n-1, x[i]^2)",
+    "rastrigin": "10*n + sum(i, 0, n-1, x[i]^2 - 10*cos(2*pi*x[i]))",
+    "rosenbrock": "sum(i, 0, n-2, 100*(x[i+1] - x[i]^2)^2 + (1 - x[i])^2)",
+    "ackley": "-20*exp(-0.2*sqrt(sum(i, 0, n-1, x[i]^2)/n)) - exp(sum(i, 0, n-1, cos(2*pi*x[i]))/n) + 20 + e",
+    "func": "sum(i, 0, n-1, x[i]^2 - 100*cos(x[i])^2 - 100*cos(x[i]^2/30)) + 1400",
+}
+
+
+# Native (C++) objectives available in pyde
+def native(pyde, name, dim):
+    if name == "func":
+        return pyde.Func(dim)
+    return None
+
+
+""" Measurements """
+def read_status_kb(field):
+    # VmHWM: peak resident set size, VmRSS: current (Linux only)
+    try:
+        with open("/proc/self/status") as f:
+            for line in f:
+                if line.startswith(field + ":"):
+                    return int(line.split()[1])
+    except OSError:
+        pass
+    return None
+
+
+def run_pyde(case):
+    import pyde
+
+    name, dim, kind = case["function"], case["dimension"], case["kind"]
+    lower, upper, _ = BOUNDS[name]
+    evaluator = None
+    if kind == "native":
+        problem = native(pyde, name, dim)
+    elif kind == "expression":
+        problem = pyde.ExpressionObjective(EXPRESSIONS[name], dim, lower, upper)
+        if case["threads"] == 1:
+            evaluator = pyde.ExpressionEvaluator(problem)
+    else:
+        problem = pyde.customFunction(dim, PER_CALL[name], lower, upper)
+    if kind == "vectorized":
+        import numpy as np
+        f = vectorized(name)
+        evaluator = pyde.VectorizedEvaluator(dim, lambda X: f(np.asarray(X)))
+
+    de = pyde.DifferentialEvolution(problem, case["populationSize"], case["F"], case["CR"],
+                                    case["seed"], True, None, None)
+    pool = None
+    if evaluator is not None:
+        de.SetEvaluator(evaluator)
+    elif case["threads"] > 1:
+        pool = pyde.ThreadPool(case["threads"])
+        de.EnableDeterministicParallel(pool)
+
+    target = case["target"]
+    timeToTarget = None
+    start = time.perf_counter()
+    de.InitializePopulation()
+    for _ in range(case["generations"]):
+        de.SelectAndCross()
+        if timeToTarget is None and de.GetBestCost() <= target:
+            timeToTarget = time.perf_counter() - start
+    elapsed = time.perf_counter() - start
+    return elapsed, de.GetNumOfEvaluations(), de.GetBestCost(), timeToTarget
+
+
+def run_scipy(case):
+    import numpy as np
+    from scipy.optimize import differential_evolution
+
+    name, dim, kind, n = case["function"], case["dimension"], case["kind"], case["populationSize"]
+    lower, upper, _ = BOUNDS[name]
+    rng = np.random.default_rng(case["seed"])
+    options = dict(
+        bounds=[(lower, upper)] * dim,
+        maxiter=case["generations"],
+        # exactly populationSize individuals (popsize is a multiplier of the dimension)
+        init=rng.uniform(lower, upper, size=(n, dim)),
+        mutation=case["F"],
+        recombination=case["CR"],
+        seed=case["seed"],
+        tol=0,
+        polish=False,
+        updating="deferred",
+    )
+    if kind == "vectorized":
+        f = vectorized(name)
+        # SciPy passes one agent per column
+        objective = lambda X: f(X.T)
+        options["vectorized"] = True
+    else:
+        objective = PER_CALL[name]
+        options["workers"] = case["threads"]
+
+    target = case["target"]
+    state = {"timeToTarget": None, "start": 0.0}
+
+    def callback(intermediate_result):
+        if state["timeToTarget"] is None and intermediate_result.fun <= target:
+            state["timeToTarget"] = time.perf_counter() - state["start"]
+
+    state["start"] = time.perf_counter()
+    result = differential_evolution(objective, callback=callback, **options)
+    elapsed = time.perf_counter() - state["start"]
+    return elapsed, result.nfev, float(result.fun), state["timeToTarget"]
+
+
+def run_case(case):
+    """Runs one case (in this process) and returns its metrics."""
+    rssBefore = read_status_kb("VmRSS")
+    runner = run_pyde if case["engine"] == "pyde" else run_scipy
+    samples = []
+    for r in range(case["repeats"]):
+        c = dict(case, seed=case["seed"] + r)
+        elapsed, evaluations, best, timeToTarget = runner(c)
+        samples.append({"seconds": elapsed, "evaluations": evaluations, "bestCost": best,
+                        "timeToTarget": timeToTarget})
+    peak = read_status_kb("VmHWM")
+    reached = [s["timeToTarget"] for s in samples if s["timeToTarget"] is not None]
+    return {
+        "seconds": statistics.median(s["seconds"] for s in samples),
+        "evaluationsPerSecond": statistics.median(s["evaluations"] / s["seconds"] for s in samples),
+        "bestCost": statistics.median(s["bestCost"] for s in samples),
+        # median over the repeats that reached the target
+        "timeToTarget": statistics.median(reached) if reached else None,
+        "reachedTarget": len(reached),
+        "peakRssMB": peak / 1024.0 if peak is not None else None,
+        "rssGrowthMB": (peak - rssBefore) / 1024.0 if peak is not None and rssBefore is not None else None,
+        "samples": samples,
+    }
+
+
+""" Matrix """
+def unsupported(case, available):
+    # reason a case cannot run (None: it can)
+    engine, kind, threads = case["engine"], case["kind"], case["threads"]
+    if engine not in available:
+        return engine + " is not installed"
+    if kind == "vectorized" and "numpy" not in available:
+        return "numpy is not installed"
+    if kind == "native":
+        if engine == "scipy":
+            return "SciPy has no native objectives"
+        if case["function"] != "func":
+            return "no native implementation"
+    if kind == "expression" and engine == "scipy":
+        return "SciPy has no expression objectives"
+    if kind == "vectorized" and threads > 1:
+        # one call per generation: nothing to run in parallel
+        return "vectorized objectives run on one thread"
+    return None
+
+
+def available_modules():
+    available = set()
+    for module, key in (("pyde", "pyde"), ("scipy.optimize", "scipy"), ("numpy", "numpy")):
+        try:
+            __import__(module)
+            available.add(key)
+        except ImportError:
+            pass
+    return available
+
+
+def build_matrix(args):
+    cases = []
+    for engine, kind, name, dim, n, threads in itertools.product(
+            args.engines, args.kinds, args.functions, args.dimensions, args.populations, args.threads):
+        cases.append({
+            "engine": engine, "kind": kind, "function": name, "dimension": dim,
+            "populationSize": n, "threads": threads,
+            "generations": args.generations, "repeats": args.repeats,
+            "F": args.F, "CR": args.CR, "seed": args.seed,
+            "target": BOUNDS[name][2](dim) + args.target_tolerance,
+        })
+    return cases
+
+
+def case_key(case):
+    return "{engine}/{kind}/{function}/d{dimension}/n{populationSize}/t{threads}".format(**case)
+
+
+def run_isolated(case, timeout):
+    # a fresh interpreter per case: the peak RSS is the case's own
+    process = subprocess.run([sys.executable, os.path.abspath(__file__), "--run-case", json.dumps(case)],
+                             capture_output=True, text=True, timeout=timeout,
+                             cwd=os.path.dirname(os.path.abspath(__file__)))
+    if process.returncode != 0:
+        return {"error": process.stderr.strip().splitlines()[-1] if process.stderr.strip() else
+                "exit status %d" % process.returncode}
+    return json.loads(process.stdout.strip().splitlines()[-1])
+
+
+""" Regression check """
+def compare(results, baseline, threshold):
+    """Returns the list of regressions of results against baseline."""
+    base = {r["key"]: r for r in baseline["results"] if "metrics" in r}
+    regressions = []
+    for r in results:
+        if "metrics" not in r or r["key"] not in base:
+            continue
+        new, old = r["metrics"], base[r["key"]]["metrics"]
+
+        def regress(metric, message):
+            regressions.append({"key": r["key"], "metric": metric, "baseline": old[metric],
+                                "current": new[metric], "message": message})
+
+        if new["evaluationsPerSecond"] < old["evaluationsPerSecond"] * (1.0 - threshold):
+            regress("evaluationsPerSecond", "throughput dropped")
+        if old["timeToTarget"] is not None:
+            if new["timeToTarget"] is None:
+                regress("timeToTarget", "target no longer reached")
+            elif new["timeToTarget"] > old["timeToTarget"] * (1.0 + threshold):
+                regress("timeToTarget", "slower to reach the target")
+        if old["peakRssMB"] is not None and new["peakRssMB"] is not None \
+                and new["peakRssMB"] > old["peakRssMB"] * (1.0 + threshold):
+            regress("peakRssMB", "peak RSS grew")
+    return regressions
+
+
+def print_header():
+    print("%-44s %12s %10s %10s %9s" % ("case", "evals/s", "target s", "best", "peak MB"))
+
+
+def print_table(results):
+    for r in results:
+        if "skipped" in r:
+            print("%-44s skipped: %s" % (r["key"], r["skipped"]))
+        elif "error" in r:
+            print("%-44s error: %s" % (r["key"], r["error"]))
+        else:
+            m = r["metrics"]
+            print("%-44s %12.0f %10s %10.4g %9s" % (
+                r["key"], m["evaluationsPerSecond"],
+                "%.4f" % m["timeToTarget"] if m["timeToTarget"] is not None else "-",
+                m["bestCost"],
+                "%.1f" % m["peakRssMB"] if m["peakRssMB"] is not None else "-"))
+
+
+def parse_args(argv):
+    parser = argparse.ArgumentParser(description="pyde vs SciPy benchmark matrix")
+    parser.add_argument("--engines", nargs="+", default=["pyde", "scipy"], choices=["pyde", "scipy"])
+    parser.add_argument("--kinds", nargs="+", default=["native", "expression", "python", "vectorized"],
+                        choices=["native", "expression", "python", "vectorized"])
+    parser.add_argument("--functions", nargs="+", default=sorted(BOUNDS), choices=sorted(BOUNDS))
+    parser.add_argument("--dimensions", nargs="+", type=int, default=[10, 30])
+    parser.add_argument("--populations", nargs="+", type=int, default=[50, 200])
+    parser.add_argument("--threads", nargs="+", type=int, default=[1, 4])
+    parser.add_argument("--generations", type=int, default=300)
+    parser.add_argument("--repeats", type=int, default=3)
+    parser.add_argument("--F", type=float, default=0.5)
+    parser.add_argument("--CR", type=float, default=0.9)
+    parser.add_argument("--seed", type=int, default=123)
+    parser.add_argument("--target-tolerance", type=float, default=1e-2,
+                        help="time-to-target: first time the best cost is within this of the optimum")
+    parser.add_argument("--quick", action="store_true", help="small matrix (d=10, n=50, 100 generations, 1 repeat)")
+    parser.add_argument("--timeout", type=float, default=1800, help="seconds per case")
+    parser.add_argument("--output", help="write the results as JSON")
+    parser.add_argument("--baseline", help="JSON results to compare against")
+    parser.add_argument("--threshold", type=float, default=0.15, help="allowed relative regression")
+    parser.add_argument("--run-case", help=argparse.SUPPRESS)
+    args = parser.parse_args(argv)
+    if args.quick:
+        args.dimensions, args.populations, args.generations, args.repeats = [10], [50], 100, 1
+    return args
+
+
+def main(argv=None):
+    args = parse_args(argv)
+    if args.run_case:
+        print(json.dumps(run_case(json.loads(args.run_case))))
+        return 0
+
+    available = available_modules()
+    results = []
+    print_header()
+    for case in build_matrix(args):
+        entry = {"key": case_key(case), "case": case}
+        reason = unsupported(case, available)
+        if reason:
+            entry["skipped"] = reason
+        else:
+            try:
+                outcome = run_isolated(case, args.timeout)
+            except subprocess.TimeoutExpired:
+                outcome = {"error": "timeout after %g s" % args.timeout}
+            if "error" in outcome:
+                entry["error"] = outcome["error"]
+            else:
+                entry["metrics"] = outcome
+        results.append(entry)
+        print_table([entry])
+        sys.stdout.flush()
+
+    report = {
+        "meta": {
+            "time": time.strftime("%Y-%m-%dT%H:%M:%S%z"),
+            "python": platform.python_version(),
+            "platform": platform.platform(),
+            "machine": platform.machine(),
+            "cpus": os.cpu_count(),
+            "modules": sorted(available),
+            "argv": sys.argv[1:] if argv is None else argv,
+        },
+        "results": results,
+    }
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(report, f, indent=2)
+
+    status = 0
+    if args.baseline:
+        with open(args.baseline) as f:
+            regressions = compare(results, json.load(f), args.threshold)
+        if regressions:
+            print("\n%d regression(s) beyond %.0f%%:" % (len(regressions), 100 * args.threshold))
+            for g in regressions:
+                print("  %s %s: %s -> %s (%s)" % (g["key"], g["metric"], g["baseline"], g["current"], g["message"]))
+            status = 1
+        else:
+            print("\nno regressions beyond %.0f%%" % (100 * args.threshold))
+    return status
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -87,6 +87,8 @@ def DE_optimize(custom_function,callback,termination_condition):
         callback=callback,
         terminationCondition=termination_condition
     )
+    # SciPy polishes its result with L-BFGS-B by default
+    opt.EnablePolishing(pyde.PolishConfig(pyde.PolishMethod.LBFGSB))
     #print("\nMyDE Optimizing......")
     opt.OptimizeStep(iterations=Iteration, verbose=False)
     return opt
@@ -1,3 +1,4 @@
+import sys
 import pytest
 import pyde
 import numpy as np
@@ -57,6 +58,808 @@ class TestDE:
         cost_2 = de.GetBestCost()
         assert cost_1 > cost_2, "Cost is not decreasing"
 
+    def test_DE_surrogate(self):
+        """Surrogate screening should skip real evaluations and still improve the cost."""
+        Test_function = pyde.customFunction(5, rastrigin,-5.12,5.12)
+        de = pyde.DifferentialEvolution(
+            costFunction=Test_function,
+            populationSize=20,
+            F=0.9,
+            CR=0.9,
+            RandomSeed=123,
+            shouldCheckConstraint=True,
+            callback=None,
+            terminationCondition=None
+        )
+        de.EnableSurrogate(candidates=4, screen=True)
+        de.OptimizeStep(30,False)
+        assert de.GetNumOfSkippedEvaluations() > 0, "Surrogate did not screen any trial"
+        assert de.GetNumOfEvaluations() + de.GetNumOfSkippedEvaluations() == 20 * 31
+        assert de.GetBestCost() < rastrigin([5.12] * 5)
+
+    def test_DE_process_pool(self):
+        """A forked worker pool must give the same result as serial batch evaluation."""
+        Test_function = pyde.customFunction(5, rastrigin,-5.12,5.12)
+
+        def run(make_evaluator):
+            de = pyde.DifferentialEvolution(
+                costFunction=Test_function,
+                populationSize=20,
+                F=0.9,
+                CR=0.9,
+                RandomSeed=123,
+                shouldCheckConstraint=True,
+                callback=None,
+                terminationCondition=None
+            )
+            evaluator = make_evaluator()
+            de.SetEvaluator(evaluator)
+            de.OptimizeStep(10,False)
+            return de.GetPopulationCost()
+
+        serial = run(lambda: pyde.SerialEvaluator(Test_function))
+        pooled = run(lambda: pyde.ProcessPoolEvaluator(Test_function, numOfWorkers=2))
+        assert serial == pooled, "Process pool changed the optimization result"
+
+    def test_DE_process_pool_worker_crash(self, tmp_path):
+        """A dead worker makes the pool fail immediately instead of hanging or returning stale costs."""
+        import os
+        marker = tmp_path / "crash"
+
+        def objective(x):
+            if marker.exists():
+                os._exit(3)
+            return sum(v * v for v in x)
+
+        problem = pyde.customFunction(3, objective, -1.0, 1.0)
+        pool = pyde.ProcessPoolEvaluator(problem, numOfWorkers=2)
+        de = pyde.DifferentialEvolution(problem, 10, 0.5, 0.9, 1, True, None, None)
+        de.SetEvaluator(pool)
+        de.OptimizeStep(2, False)
+        marker.touch()
+        # the first call notices the crash, the second one fails at once
+        for _ in range(2):
+            with pytest.raises(RuntimeError):
+                de.OptimizeStep(1, False)
+
+    @pytest.mark.skipif(not sys.platform.startswith("linux"), reason="reads /proc")
+    def test_DE_process_pool_parent_death(self):
+        """Workers exit when the process that forked them is killed."""
+        import os
+        import signal
+        import subprocess
+        import time
+
+        def state(pid):
+            # (state, ppid) from /proc/<pid>/stat, None once the process is gone
+            try:
+                with open("/proc/%d/stat" % pid) as f:
+                    fields = f.read().rsplit(")", 1)[1].split()
+            except OSError:
+                return None
+            return fields[0], int(fields[1])
+
+        parent = subprocess.Popen(
+            [sys.executable, "-c",
+             "import pyde, time\n"
+             "f = pyde.Func(3)\n"
+             "pool = pyde.ProcessPoolEvaluator(f, numOfWorkers=3)\n"
+             "print('ready', flush=True)\n"
+             "time.sleep(60)\n"],
+            cwd=os.path.dirname(os.path.abspath(__file__)), stdout=subprocess.PIPE, text=True)
+        try:
+            assert parent.stdout.readline().strip() == "ready"
+            workers = [int(p) for p in os.listdir("/proc")
+                       if p.isdigit() and (state(int(p)) or (None, None))[1] == parent.pid]
+            assert len(workers) == 3
+        finally:
+            parent.send_signal(signal.SIGKILL)
+            parent.wait()
+        # gone, or a zombie waiting for a reaper other than us
+        deadline = time.time() + 10
+        while time.time() < deadline:
+            alive = [w for w in workers if state(w) is not None and state(w)[0] != "Z"]
+            if not alive:
+                break
+            time.sleep(0.01)
+        assert not alive, "workers outlived their parent: %s" % alive
+
+    def test_run_many(self):
+        """RunMany must return the same result as running each job on its own."""
+        func = pyde.Func(4)
+        configs = [pyde.RunConfig(populationSize=20, F=0.5, CR=0.9, RandomSeed=seed, iterations=20)
+                   for seed in range(6)]
+        results = pyde.RunMany([(func, c) for c in configs], numOfThreads=3)
+        assert len(results) == len(configs)
+
+        for config, result in zip(configs, results):
+            de = pyde.DifferentialEvolution(
+                costFunction=func,
+                populationSize=config.populationSize,
+                F=config.F,
+                CR=config.CR,
+                RandomSeed=config.RandomSeed,
+                shouldCheckConstraint=True,
+                callback=None,
+                terminationCondition=None
+            )
+            de.OptimizeStep(config.iterations,False)
+            assert result.generations == config.iterations
+            assert result.bestCost == de.GetBestCost()
+            assert result.bestAgent == de.GetBestAgent()
+
+    def test_numa_thread_pool(self):
+        """Pinned pools, node-local RunMany and the thread-pool evaluator keep results unchanged."""
+        topology = pyde.CpuTopology()
+        assert topology.numOfNodes() >= 1
+        placement = topology.Placement(4)
+        assert len(placement) == 4
+        for cpus in placement:
+            assert topology.NodeOfCpu(cpus[0]) >= 0
+
+        func = pyde.Func(4)
+        def run(evaluator):
+            de = pyde.DifferentialEvolution(
+                costFunction=func,
+                populationSize=20,
+                F=0.5,
+                CR=0.9,
+                RandomSeed=7,
+                shouldCheckConstraint=True,
+                callback=None,
+                terminationCondition=None
+            )
+            if evaluator is not None:
+                de.SetEvaluator(evaluator)
+            de.OptimizeStep(30,False)
+            return de.GetBestCost(), de.GetBestAgent()
+
+        pool = pyde.ThreadPool(2, placement)
+        serial = run(pyde.SerialEvaluator(func))
+        assert run(pyde.ThreadPoolEvaluator(func, pool)) == serial
+        assert run(pyde.ThreadPoolEvaluator(func, pool, firstTouch=True)) == serial
+        assert run(pyde.ThreadPoolEvaluator(func, pool, firstTouch=False)) == serial
+        assert pyde.ThreadPoolEvaluator(func, pool).FirstTouch() == (topology.numOfNodes() > 1)
+
+        configs = [pyde.RunConfig(populationSize=20, RandomSeed=seed, iterations=20) for seed in range(4)]
+        shared = pyde.RunMany([(func, c) for c in configs], numOfThreads=2)
+        local = pyde.RunMany([(func, c) for c in configs], numOfThreads=2, nodeLocal=True)
+        assert [r.bestCost for r in shared] == [r.bestCost for r in local]
+
+    @pytest.mark.parametrize("strategy", ["plain", "surrogate", "feasibility", "epsilon", "evaluator"])
+    def test_deterministic_parallel(self, strategy):
+        """Deterministic mode gives bit-identical populations on any number of threads."""
+        def sphere(x):
+            return sum(v * v for v in x)
+
+        def run(numOfThreads):
+            if strategy in ("feasibility", "epsilon"):
+                func = pyde.customFunction(3, sphere, -5, 5)
+                func.AddConstraint(pyde.Optimize.NonlinearConstraint(
+                    lambda x: 1.0 - x[0] - x[1], pyde.Optimize.NonlinearConstraint.Inequality, cost=1.0))
+            else:
+                func = pyde.Func(4)
+            de = pyde.DifferentialEvolution(
+                costFunction=func,
+                populationSize=20,
+                F=0.7,
+                CR=0.9,
+                RandomSeed=42,
+                shouldCheckConstraint=True,
+                callback=None,
+                terminationCondition=None
+            )
+            pool = pyde.ThreadPool(numOfThreads) if numOfThreads else None
+            de.EnableDeterministicParallel(pool)
+            if strategy == "surrogate":
+                de.EnableSurrogate(candidates=4, archiveSize=64, neighbours=5, screen=True)
+            if strategy == "epsilon":
+                de.SetConstraintHandling(pyde.ConstraintHandling.EpsilonConstrained, controlGenerations=20)
+            if strategy == "evaluator":
+                de.SetEvaluator(pyde.SerialEvaluator(func))
+            de.OptimizeStep(30,False)
+            return de.getPopulation(), de.GetBestCost(), de.GetNumOfEvaluations()
+
+        reference = run(0)
+        for numOfThreads in (1, 8, 64):
+            assert run(numOfThreads) == reference
+
+    def test_bounded_evaluation(self):
+        """Early-aborted evaluations never change the optimization result."""
+        func = pyde.Func(10)
+        x = [1.0] * 10
+        assert func.EvaluateCostBounded(x, float("inf")) == func.EvaluateCost(x)
+        assert func.EvaluateCostBounded(x, func.EvaluateCost(x) - 1.0) == float("inf")
+
+        def run(bounded):
+            de = pyde.DifferentialEvolution(
+                costFunction=func,
+                populationSize=20,
+                F=0.5,
+                CR=0.9,
+                RandomSeed=3,
+                shouldCheckConstraint=False,
+                callback=None,
+                terminationCondition=None
+            )
+            de.SetIncrementalEvaluation(False)
+            de.SetBoundedEvaluation(bounded)
+            de.OptimizeStep(100,False)
+            return de.getPopulation(), de.GetBestCost(), de.GetNumOfAbortedEvaluations()
+
+        population, best, aborted = run(True)
+        assert aborted > 0
+        assert run(False) == (population, best, 0)
+
+    def test_incremental_evaluation(self):
+        """Separable objectives only recompute the changed terms, with identical results."""
+        dim = 200
+        func = pyde.Func(dim)
+        assert func.numOfTerms() == dim
+        x = [float(i % 7) for i in range(dim)]
+        total = sum(func.EvaluateTerm(t, x) for t in range(dim)) + func.ConstantTerm()
+        assert abs(total - func.EvaluateCost(x)) < 1e-9
+
+        def run(incremental):
+            de = pyde.DifferentialEvolution(
+                costFunction=func,
+                populationSize=20,
+                F=0.5,
+                CR=0.1,
+                RandomSeed=9,
+                shouldCheckConstraint=False,
+                callback=None,
+                terminationCondition=None
+            )
+            de.SetIncrementalEvaluation(incremental)
+            de.OptimizeStep(50,False)
+            return de.getPopulation(), de.GetBestCost(), de.GetNumOfEvaluations(), de.GetNumOfTermEvaluations()
+
+        population, best, evaluations, terms = run(True)
+        assert run(False)[:3] == (population, best, evaluations)
+        # CR = 0.1: a trial differs from its parent in about 10% of the coordinates
+        assert terms < 0.3 * evaluations * dim
+
+    def test_population_statistics(self):
+        """Incrementally maintained statistics match a recomputation from the population."""
+        de = pyde.DifferentialEvolution(
+            costFunction=pyde.Func(6),
+            populationSize=20,
+            F=0.5,
+            CR=0.9,
+            RandomSeed=5,
+            shouldCheckConstraint=True,
+            callback=None,
+            terminationCondition=None
+        )
+        de.InitializePopulation()
+        for generation in range(200):
+            de.SelectAndCross()
+            if generation % 50 == 49:
+                population = np.array(de.getPopulation())
+                costs = np.array([cost for _, cost in de.GetPopulationCost()])
+                stats = de.GetStatistics()
+                assert np.allclose(stats.Centroid(), population.mean(axis=0), rtol=1e-9, atol=1e-12)
+                assert np.allclose(stats.Variance(), population.var(axis=0), rtol=1e-6, atol=1e-12)
+                assert np.array_equal(stats.Lower(), population.min(axis=0))
+                assert np.array_equal(stats.Upper(), population.max(axis=0))
+                assert stats.MinCost() == costs.min() == de.GetBestCost()
+                assert stats.MaxCost() == costs.max()
+                assert abs(stats.MeanCost() - costs.mean()) <= 1e-9 * (1 + abs(costs.mean()))
+                assert abs(stats.CostStd() - costs.std()) <= 1e-6 * (1 + costs.std())
+
+    def test_expression_objective(self):
+        """Expression objectives are compiled once and evaluated without calling Python."""
+        import math
+
+        x = [0.5, -1.25, 2.0, 3.5]
+        func = pyde.Func(4)
+        text = "sum(i, 0, n-1, x[i]^2 - 100*cos(x[i])^2 - 100*cos(x[i]^2/30)) + 1400"
+        problem = pyde.ExpressionObjective(text, 4, -100.0, 100.0)
+        assert problem.EvaluateCost(x) == pytest.approx(func.EvaluateCost(x))
+        assert problem.expression == text
+        assert problem.numOfParameters() == 4
+
+        # the same objective as a small AST
+        term = ("-", ("-", ("^", ("x", "i"), 2), ("*", 100, ("^", ("cos", ("x", "i")), 2))),
+                ("*", 100, ("cos", ("/", ("^", ("x", "i"), 2), 30))))
+        tree = pyde.ExpressionObjective(("+", ("sum", "i", 0, ("-", "n", 1), term), 1400), 4, -100.0, 100.0)
+        assert tree.EvaluateCost(x) == pytest.approx(func.EvaluateCost(x))
+
+        rosenbrock = pyde.ExpressionObjective(
+            "sum(i, 0, n-2, 100*(x[i+1] - x[i]^2)^2 + (1 - x[i])^2)", 3, -5.0, 5.0)
+        assert rosenbrock.EvaluateCost([1.0, 1.0, 1.0]) == 0.0
+        assert rosenbrock.EvaluateCost([0.0, 0.0, 0.0]) == pytest.approx(2.0)
+        assert pyde.ExpressionObjective("prod(i, 1, n, cos(x[i-1]/sqrt(i)))", 2, -1.0, 1.0).EvaluateCost(
+            [0.3, 0.4]) == pytest.approx(math.cos(0.3) * math.cos(0.4 / math.sqrt(2)))
+
+        for bad in ("x[n]", "x[x[0]]", "foo(x[0])", "1 +", "y",
+                    "sum(i, 0, 1e400, x[0])", "sum(i, 0, 1e12, x[0])",
+                    "(" * 100000 + "x[0]" + ")" * 100000, "+".join(["x[0]"] * 100000)):
+            with pytest.raises(ValueError):
+                pyde.ExpressionObjective(bad, 2, -1.0, 1.0)
+
+        # batches go through the blocked interpreter with the GIL released
+        population, generations = 40, 50
+        de = pyde.DifferentialEvolution(problem, population, 0.5, 0.9, 1, True, None, None)
+        de.SetEvaluator(pyde.ExpressionEvaluator(problem))
+        de.OptimizeStep(generations, False)
+        assert de.GetBestCost() == pytest.approx(func.EvaluateCost(de.GetBestAgent()))
+
+    def test_vectorized_evaluator(self):
+        """A NumPy objective evaluates each generation's batch in one call."""
+        calls = []
+
+        def sphere_rows(X):
+            X = np.asarray(X)
+            calls.append(X.shape)
+            return np.sum(X * X, axis=1)
+
+        population, generations = 20, 30
+        problem = pyde.customFunction(5, lambda x: sum(v * v for v in x), -5.0, 5.0)
+        de = pyde.DifferentialEvolution(problem, population, 0.5, 0.9, 1, True, None, None)
+        de.SetEvaluator(pyde.VectorizedEvaluator(5, sphere_rows))
+        de.OptimizeStep(generations, False)
+        assert calls[0] == (population, 5)
+        assert len(calls) == generations + 1
+        assert de.GetBestCost() == pytest.approx(sum(v * v for v in de.GetBestAgent()))
+
+        de.SetEvaluator(pyde.VectorizedEvaluator(5, lambda X: [0.0]))
+        with pytest.raises(ValueError):
+            de.OptimizeStep(1, False)
+
+    def test_profiling(self):
+        """Per-phase profile of SelectAndCross; counters degrade to NaN without a PMU."""
+        import math
+
+        population, generations = 20, 30
+        func = pyde.Func(4)
+        de = pyde.DifferentialEvolution(func, population, 0.5, 0.9, 1, True, None, None)
+        assert de.GetProfile().trialConstruction.calls == 0
+        de.EnableProfiling()
+        de.OptimizeStep(generations, False)
+        report = de.GetProfile()
+        # the serial loop enters every phase once per trial
+        for phase in (report.trialConstruction, report.evaluation, report.selection):
+            assert phase.calls == population * generations
+            assert phase.seconds > 0
+        if report.countersAvailable:
+            assert report.evaluation.instructions > 0
+            assert report.evaluation.ipc > 0
+        else:
+            assert report.reason
+            assert math.isnan(report.evaluation.cycles)
+
+        # evaluator mode: one entry per generation
+        de.ResetProfile()
+        evaluator = pyde.SerialEvaluator(func)
+        de.SetEvaluator(evaluator)
+        de.OptimizeStep(generations, False)
+        assert de.GetProfile().evaluation.calls == generations
+        de.DisableProfiling()
+        assert de.GetProfile().selection.calls == 0
+
+    def test_deadline_and_cancellation(self):
+        """OptimizeStep returns the best-so-far at a deadline, on Cancel() and on SIGINT."""
+        import os
+        import signal
+        import threading
+        import time
+
+        def slow_sphere(x):
+            time.sleep(0.0005)
+            return sum(v * v for v in x)
+
+        problem = pyde.customFunction(4, slow_sphere, -5.0, 5.0)
+        de = pyde.DifferentialEvolution(problem, 20, 0.5, 0.9, 1, True, None, None)
+        start = time.monotonic()
+        de.SetDeadline(time.time() + 0.2)
+        de.OptimizeStep(10 ** 6, False)
+        elapsed = time.monotonic() - start
+        assert de.GetStopReason() == pyde.StopReason.Deadline
+        # one trial at most is in flight when the deadline passes
+        assert 0 <= de.GetDeadlineOvershoot() < 0.05
+        assert elapsed < 0.2 + 0.05
+        assert de.GetBestCost() == pytest.approx(slow_sphere(de.GetBestAgent()))
+
+        de.ClearDeadline()
+        token = pyde.CancellationToken()
+        de.SetCancellationToken(token)
+        timer = threading.Timer(0.1, token.Cancel)
+        timer.start()
+        de.OptimizeStep(10 ** 6, False)
+        timer.join()
+        assert de.GetStopReason() == pyde.StopReason.Cancelled
+        token.Reset()
+        de.OptimizeStep(3, False)
+        assert de.GetStopReason() == pyde.StopReason.Completed
+
+        # Ctrl-C under the default handler while a C++ objective runs with the GIL
+        # released: the KeyboardInterrupt cancels the token instead of being raised
+        func = pyde.Func(4)
+        token = pyde.CancellationToken(handleSignals=True, pollInterval=0.01)
+        de = pyde.DifferentialEvolution(func, 20, 0.5, 0.9, 1, True, None, None)
+        de.SetCancellationToken(token)
+        previous = signal.signal(signal.SIGINT, signal.default_int_handler)
+        try:
+            timer = threading.Timer(0.1, os.kill, (os.getpid(), signal.SIGINT))
+            start = time.monotonic()
+            timer.start()
+            de.OptimizeStep(10 ** 8, False)
+            elapsed = time.monotonic() - start
+            timer.join()
+        finally:
+            signal.signal(signal.SIGINT, previous)
+        assert de.GetStopReason() == pyde.StopReason.Cancelled
+        assert token.IsCancelled()
+        assert elapsed < 5
+        assert de.GetBestCost() == pytest.approx(func.EvaluateCost(de.GetBestAgent()))
+        assert de.GetBestCost() < func.EvaluateCost([5.0] * 4)
+
+        # A Python objective runs the handlers itself: a handler that cancels the token
+        token = pyde.CancellationToken()
+        de = pyde.DifferentialEvolution(problem, 20, 0.5, 0.9, 1, True, None, None)
+        de.SetCancellationToken(token)
+        previous = signal.signal(signal.SIGINT, lambda *args: token.Cancel())
+        try:
+            timer = threading.Timer(0.1, os.kill, (os.getpid(), signal.SIGINT))
+            timer.start()
+            de.OptimizeStep(10 ** 6, False)
+            timer.join()
+        finally:
+            signal.signal(signal.SIGINT, previous)
+        assert de.GetStopReason() == pyde.StopReason.Cancelled
+        assert de.GetBestCost() == pytest.approx(slow_sphere(de.GetBestAgent()))
+
+    def test_dynamic_objective(self):
+        """After a data change only part of the population is re-evaluated; the best cost is always current."""
+        center = [0.0] * 6
+
+        def moving_sphere(x):
+            return sum((xi - c) ** 2 for xi, c in zip(x, center))
+
+        problem = pyde.customFunction(6, moving_sphere, -5.0, 5.0)
+        de = pyde.DifferentialEvolution(problem, populationSize=40, F=0.5, CR=0.9, RandomSeed=2,
+                                        shouldCheckConstraint=True, callback=None, terminationCondition=None)
+        de.EnableDynamicObjective(pyde.DynamicConfig(eliteFraction=0.1, sampleFraction=0.1, immigrantFraction=0.1))
+        de.OptimizeStep(100, False)
+        assert de.GetNumOfDataChanges() == 0 and de.GetNumOfStale() == 0
+
+        for tick in range(5):
+            center[:] = [c + 0.1 for c in center]
+            problem.UpdateData()
+            evaluations = de.GetNumOfEvaluations()
+            de.SelectAndCross()
+            assert de.GetNumOfDataChanges() == tick + 1
+            # 12 re-evaluated at the change, the rest lazily when they meet a trial
+            assert de.GetNumOfEvaluations() - evaluations <= 12 + 2 * 40
+            assert de.GetBestCost() == pytest.approx(moving_sphere(de.GetBestAgent()))
+            after_change = de.GetBestCost()
+            # OptimizeStep continues the current population in dynamic mode
+            de.OptimizeStep(20, False)
+            assert de.GetBestCost() == pytest.approx(moving_sphere(de.GetBestAgent()))
+            assert de.GetBestCost() < after_change
+        assert de.GetNumOfReevaluations() >= 5 * 12
+
+    def test_single_precision(self):
+        """float storage keeps the agents in float32, inside the box, and still converges."""
+        def shifted_sphere(x):
+            return sum((xi - 0.1) ** 2 for xi in x)
+
+        # 0.1 is not a float32: rounding must not leave the box [0.1, 0.7]
+        problem = pyde.customFunction(8, shifted_sphere, 0.1, 0.7)
+        results = {}
+        for cls in (pyde.DifferentialEvolution, pyde.DifferentialEvolutionFloat):
+            de = cls(problem, populationSize=20, F=0.5, CR=0.9, RandomSeed=3,
+                     shouldCheckConstraint=True, callback=None, terminationCondition=None)
+            de.OptimizeStep(200, False)
+            population = np.array(de.getPopulation())
+            assert np.all(population >= 0.1) and np.all(population <= 0.7)
+            best = de.GetBestAgent()
+            assert de.GetBestCost() == pytest.approx(shifted_sphere(best))
+            results[cls] = (population, de.GetBestCost())
+
+        population, cost = results[pyde.DifferentialEvolutionFloat]
+        assert np.array_equal(population.astype(np.float32).astype(np.float64), population)
+        assert cost < 1e-6
+        assert isinstance(pyde.DifferentialEvolutionFloat(
+            problem, 10, 0.5, 0.9, 1, True, None, None).GetStatistics(), pyde.PopulationStatisticsFloat)
+
+    def test_cooperative_coevolution(self):
+        """Differential grouping recovers interacting blocks; the context vector only improves."""
+        def blocks(x):
+            # 4 blocks of 3 interacting parameters, then 4 separable parameters
+            cost = sum(sum(x[3 * b:3 * b + 3]) ** 2 for b in range(4))
+            return cost + sum((xi - 1.0) ** 2 for xi in x[12:])
+
+        problem = pyde.customFunction(16, blocks, -5.0, 5.0)
+        config = pyde.CoevolutionConfig(pyde.Grouping.Differential, groupSize=2,
+                                        populationSize=10, generationsPerCycle=5)
+        cc = pyde.CooperativeCoevolution(problem, config, RandomSeed=4)
+        cc.InitializePopulation()
+        groups = sorted(sorted(g) for g in cc.GetGroups())
+        assert groups == [[0, 1, 2], [3, 4, 5], [6, 7, 8], [9, 10, 11], [12, 13], [14, 15]]
+        # 2n + 1 single changes and one evaluation per tested pair
+        assert cc.GetNumOfGroupingEvaluations() == 33 + 15 + 12 + 9 + 6 + 3 + 2 + 1
+
+        costs = [cc.GetBestCost()]
+        for _ in range(10):
+            cc.Cycle()
+            costs.append(cc.GetBestCost())
+        assert all(b <= a for a, b in zip(costs, costs[1:]))
+        assert costs[-1] < 0.01 * costs[0]
+        assert cc.GetBestCost() == pytest.approx(blocks(cc.GetBestAgent()))
+
+        # fixed groups must cover every parameter once
+        fixed = pyde.CoevolutionConfig(pyde.Grouping.Fixed, groups=[[0, 2], [1, 3]], populationSize=8)
+        cc = pyde.CooperativeCoevolution(pyde.Func(4), fixed)
+        cc.OptimizeStep(3)
+        assert cc.GetGroups() == [[0, 2], [1, 3]]
+
+    def test_multi_objective(self):
+        """GDE3 on ZDT1: the returned front is non-dominated and close to f2 = 1 - sqrt(f1)."""
+        def zdt1(x):
+            g = 1.0 + 9.0 * sum(x[1:]) / (len(x) - 1)
+            return [x[0], g * (1.0 - np.sqrt(x[0] / g))]
+
+        problem = pyde.customMultiObjective(10, 2, zdt1, 0.0, 1.0)
+        de = pyde.MultiObjectiveDE(problem, populationSize=40, F=0.5, CR=0.1, RandomSeed=5)
+        de.OptimizeStep(150)
+
+        front = de.GetParetoFront()
+        assert isinstance(front, np.ndarray)
+        assert front.ndim == 2 and front.shape[1] == 2 and len(front) > 0
+        assert de.GetParetoSet().shape == (len(front), 10)
+        for a in front:
+            assert not any(np.all(b <= a) and np.any(b < a) for b in front)
+        assert np.max(front[:, 1] - (1.0 - np.sqrt(front[:, 0]))) < 0.1
+
+        # fast non-dominated sorting matches the pairwise definition
+        rng = np.random.default_rng(3)
+        costs = rng.integers(0, 5, size=(60, 3)).astype(float).tolist()
+        ranks = pyde.NonDominatedSort(costs)
+        for i, a in enumerate(costs):
+            dominators = [ranks[j] for j, b in enumerate(costs)
+                          if all(x <= y for x, y in zip(b, a)) and b != a]
+            assert ranks[i] == (max(dominators) + 1 if dominators else 0)
+
+    def test_initialization(self):
+        """Space-filling initializers cover the box; opposition keeps the best half of the 2N points."""
+        def make(size, function=None):
+            return pyde.DifferentialEvolution(
+                costFunction=function or pyde.Func(5),
+                populationSize=size,
+                F=0.5,
+                CR=0.9,
+                RandomSeed=11,
+                shouldCheckConstraint=False,
+                callback=None,
+                terminationCondition=None
+            )
+
+        # Latin hypercube and Sobol (16 = 2^4 points): one individual per stratum in every dimension
+        for method in (pyde.Initialization.LatinHypercube, pyde.Initialization.Sobol):
+            de = make(16)
+            de.SetInitialization(method)
+            de.InitializePopulation()
+            population = np.array(de.getPopulation())
+            strata = np.floor((population + 100.0) / 200.0 * 16).astype(int)
+            for i in range(5):
+                assert sorted(strata[:, i]) == list(range(16))
+
+        # opposition: 2 * populationSize evaluations, the opposite of x is -x in [-100, 100]
+        shifted = pyde.customFunction(5, lambda x: sum((xi - 30.0) ** 2 for xi in x), -100.0, 100.0)
+        de = make(10, shifted)
+        de.SetInitialization(pyde.Initialization.Opposition)
+        de.InitializePopulation()
+        assert de.GetNumOfEvaluations() == 20
+        # the best 10 of the 20 points: a dropped opposite is not better than any kept point
+        kept = de.GetPopulationCost()
+        worst = max(cost for _, cost in kept)
+        for agent, cost in kept:
+            opposite = [-xi for xi in agent]
+            assert (shifted.EvaluateCost(opposite) >= worst
+                    or any(np.allclose(other, opposite) for other, _ in kept))
+
+        # dimensions without a constraint are sampled in [-unboundedScale, unboundedScale]
+        class Unbounded(pyde.Optimize):
+            def EvaluateCost(self, x):
+                return sum(xi * xi for xi in x)
+            def numOfParameters(self):
+                return 3
+            def getConstraints(self):
+                return [pyde.Optimize.Constraint(0.0, 1.0, False) for _ in range(3)]
+
+        de = make(10, Unbounded())
+        de.SetInitialization(pyde.Initialization.Uniform, 5.0)
+        de.InitializePopulation()
+        population = np.array(de.getPopulation())
+        assert np.all(np.isfinite(population)) and np.all(np.abs(population) <= 5.0)
+
+    def test_polishing(self):
+        """Both local searches improve the best agent and stay inside the Constraint box."""
+        def rosenbrock(x):
+            return sum(100 * (x[i + 1] - x[i] ** 2) ** 2 + (1 - x[i]) ** 2 for i in range(len(x) - 1))
+
+        for method in (pyde.PolishMethod.LBFGSB, pyde.PolishMethod.NelderMead):
+            de = pyde.DifferentialEvolution(
+                costFunction=pyde.customFunction(4, rosenbrock, -2.0, 2.0),
+                populationSize=20,
+                F=0.5,
+                CR=0.9,
+                RandomSeed=3,
+                shouldCheckConstraint=False,
+                callback=None,
+                terminationCondition=None
+            )
+            de.OptimizeStep(50, False)
+            before = de.GetBestCost()
+            evaluations = de.GetNumOfEvaluations()
+            de.EnablePolishing(pyde.PolishConfig(method, maxEvaluations=5000))
+            result = de.Polish()[0]
+            assert result.startCost == before
+            assert result.cost < 1e-6 < before
+            assert de.GetBestCost() == result.cost
+            assert de.GetNumOfEvaluations() - evaluations == result.evaluations == de.GetNumOfPolishEvaluations()
+            assert all(-2.0 <= xi <= 2.0 for xi in de.GetBestAgent())
+
+        # the unconstrained minimum (0) lies outside the box: the polished agent ends on the bound
+        de = pyde.DifferentialEvolution(
+            costFunction=pyde.customFunction(3, lambda x: sum(xi * xi for xi in x), 1.5, 2.0),
+            populationSize=10,
+            F=0.5,
+            CR=0.9,
+            RandomSeed=3,
+            shouldCheckConstraint=True,
+            callback=None,
+            terminationCondition=None
+        )
+        de.EnablePolishing(pyde.PolishConfig(everyGenerations=5))
+        de.OptimizeStep(10, False)
+        assert de.GetBestAgent() == [1.5, 1.5, 1.5]
+        assert de.GetNumOfPolishEvaluations() > 0
+
+    def test_restarts(self):
+        """A stagnating run is restarted with a larger population and the global best is kept."""
+        for strategy in (pyde.RestartStrategy.IPOP, pyde.RestartStrategy.BIPOP):
+            de = pyde.DifferentialEvolution(
+                costFunction=pyde.Func(10),
+                populationSize=20,
+                F=0.5,
+                CR=0.9,
+                RandomSeed=7,
+                shouldCheckConstraint=False,
+                callback=None,
+                terminationCondition=None
+            )
+            de.EnableRestarts(pyde.RestartConfig(strategy, stagnationGenerations=30, maxPopulationSize=160))
+            de.InitializePopulation()
+            for _ in range(1500):
+                de.SelectAndCross()
+                assert de.GetGlobalBestCost() <= de.GetBestCost()
+
+            history = de.GetRestartHistory()
+            assert de.GetNumOfRestarts() == len(history) > 0
+            assert all(a.generation < b.generation for a, b in zip(history, history[1:]))
+            assert all(4 <= r.newPopulationSize <= 160 for r in history)
+            assert de.GetPopulationSize() == history[-1].newPopulationSize
+            assert de.GetGlobalBestCost() <= min(r.bestCost for r in history)
+            if strategy == pyde.RestartStrategy.IPOP:
+                assert history[0].newPopulationSize == 40
+            assert de.GetGeneration() == 1500
+
+            de.InitializePopulation()
+            assert de.GetNumOfRestarts() == 0 and de.GetPopulationSize() == 20
+
+    def test_trace_recorder(self, tmp_path):
+        """Every evaluation is recorded and can be mapped back into NumPy."""
+        path = str(tmp_path / "run.trace")
+        func = pyde.Func(3)
+        de = pyde.DifferentialEvolution(
+            costFunction=func,
+            populationSize=10,
+            F=0.5,
+            CR=0.9,
+            RandomSeed=123,
+            shouldCheckConstraint=True,
+            callback=None,
+            terminationCondition=None
+        )
+        recorder = pyde.TraceRecorder(path, 3)
+        de.SetTraceRecorder(recorder)
+        de.OptimizeStep(5,False)
+        recorder.Close()
+
+        trace = pyde.LoadTrace(path)
+        assert trace["vectors"].shape == (10 * 6, 3)
+        assert trace["generation"].max() == 5
+        assert set(trace["index"]) == set(range(10))
+        assert trace["accepted"][:10].all()
+        for x, cost in zip(trace["vectors"][:5], trace["costs"][:5]):
+            assert func.EvaluateCost(list(x)) == cost
+
+    def test_nonlinear_constraints(self):
+        """Infeasible trials are rejected before the objective and the best agent is feasible."""
+        calls = []
+        def sphere(x):
+            calls.append(1)
+            return sum(xi**2 for xi in x)
+
+        Test_function = pyde.customFunction(3, sphere, -5, 5)
+        # x0 + x1 >= 1, cheap
+        Test_function.AddConstraint(pyde.Optimize.NonlinearConstraint(
+            lambda x: 1 - x[0] - x[1], pyde.Optimize.NonlinearConstraint.Inequality, 1.0))
+        # x2 == 0.5, more expensive
+        Test_function.AddConstraint(pyde.Optimize.NonlinearConstraint(
+            lambda x: x[2] - 0.5, pyde.Optimize.NonlinearConstraint.Equality, 2.0, 1e-3))
+
+        for mode in (pyde.ConstraintHandling.FeasibilityRules, pyde.ConstraintHandling.EpsilonConstrained):
+            calls.clear()
+            de = pyde.DifferentialEvolution(
+                costFunction=Test_function,
+                populationSize=30,
+                F=0.6,
+                CR=0.9,
+                RandomSeed=123,
+                shouldCheckConstraint=True,
+                callback=None,
+                terminationCondition=None
+            )
+            de.SetConstraintHandling(mode, controlGenerations=50)
+            de.OptimizeStep(150,False)
+            best = de.GetBestAgent()
+            assert de.GetBestViolation() == 0
+            assert best[0] + best[1] >= 1
+            assert abs(best[2] - 0.5) <= 1e-3
+            assert de.GetNumOfConstraintRejections() > 0
+            assert len(calls) < 30 * 151
+
+    def test_zero_copy_view(self):
+        """ Python objectives receive a read-only view of the agent instead of a list """
+        seen = []
+        def f(x):
+            seen.append(type(x))
+            with pytest.raises(TypeError):
+                x[0] = 0.0
+            return rastrigin(x)
+        Test_function = pyde.customFunction(4, f, -5.12, 5.12)
+        assert Test_function.EvaluateCost([1.0, 2.0, 3.0, 4.0]) == rastrigin([1.0, 2.0, 3.0, 4.0])
+        de = pyde.DifferentialEvolution(
+            costFunction=Test_function,
+            populationSize=20,
+            F=0.8,
+            CR=0.9,
+            RandomSeed=123,
+            shouldCheckConstraint=True,
+            callback=callback,
+            terminationCondition=termination_condition
+        )
+        de.OptimizeStep(5,False)
+        assert len(seen) > 0
+        assert all(t is memoryview for t in seen)
+
+    def test_agent_view_cannot_outlive_call(self):
+        """An array kept from the agent view raises instead of aliasing reused storage"""
+        kept = []
+        def keep(x):
+            kept.append(np.asarray(x))
+            return 0.0
+        with pytest.raises(BufferError):
+            pyde.customFunction(2, keep, -1.0, 1.0).EvaluateCost([1.0, 2.0])
+        # a copy may be kept
+        copies = []
+        def copy(x):
+            copies.append(np.array(x))
+            return 0.0
+        assert pyde.customFunction(2, copy, -1.0, 1.0).EvaluateCost([1.0, 2.0]) == 0.0
+        assert copies[0].tolist() == [1.0, 2.0]
+        # the view is also released when the objective raises
+        def fail(x):
+            a = np.asarray(x)
+            raise ValueError("bad agent")
+        with pytest.raises(ValueError):
+            pyde.customFunction(2, fail, -1.0, 1.0).EvaluateCost([1.0, 2.0])
+
     
     def test_Constraint_check(self):
         """Test constraint checking within Optimize."""
@@ -0,0 +1,167 @@
+"""
+Tests of the native DE runner (src/main.cpp) and its plugin loader.
+
+CTest passes the built runner and rastrigin_plugin in DE_RUNNER and DE_PLUGIN.
+Without them (plain pytest) both are compiled here, which needs a C and a C++
+compiler.
+"""
+import json
+import os
+import shutil
+import subprocess
+
+import pytest
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+SOURCE = os.path.join(HERE, "..", "src")
+INCLUDE = os.path.join(HERE, "..", "include")
+
+# plugin whose only objective was built for another ABI version
+ABI_MISMATCH = r"""
+#include "plugin.h"
+static const DEObjectivePlugin objective = {DE_PLUGIN_ABI_VERSION + 1, 0, "future"};
+const DEObjectivePlugin* de_objective_plugin(const char* name){ (void)name; return &objective; }
+"""
+
+# plugin whose create() fails with a message
+CREATE_FAILS = r"""
+#include <stddef.h>
+#include "plugin.h"
+static void* Create(unsigned int dimension, const char* options){ (void)dimension; (void)options; return NULL; }
+static void Destroy(void* state){ (void)state; }
+static void Bounds(void* state, double* lower, double* upper){ (void)state; (void)lower; (void)upper; }
+static double Evaluate(void* state, const double* x, unsigned int n){ (void)state; (void)x; (void)n; return 0.0; }
+static const char* Error(void){ return "no such configuration"; }
+static const DEObjectivePlugin objective = {
+    DE_PLUGIN_ABI_VERSION, 0, "failing", Create, Destroy, Bounds, Evaluate, NULL, Error
+};
+const DEObjectivePlugin* de_objective_plugin(const char* name){ (void)name; return &objective; }
+"""
+
+# plugin whose parameter 1 is bounded below only
+HALF_BOUNDED = r"""
+#include <math.h>
+#include "plugin.h"
+static int dummy;
+static void* Create(unsigned int dimension, const char* options){ (void)dimension; (void)options; return &dummy; }
+static void Destroy(void* state){ (void)state; }
+static void Bounds(void* state, double* lower, double* upper){
+    (void)state; lower[0] = -1.0; upper[0] = 1.0; lower[1] = 0.0; upper[1] = INFINITY;
+}
+static double Evaluate(void* state, const double* x, unsigned int n){ (void)state; (void)x; (void)n; return 0.0; }
+static const DEObjectivePlugin objective = {
+    DE_PLUGIN_ABI_VERSION, 0, "half", Create, Destroy, Bounds, Evaluate, NULL, NULL
+};
+const DEObjectivePlugin* de_objective_plugin(const char* name){ (void)name; return &objective; }
+"""
+
+
+def compiler(variable, default):
+    path = shutil.which(os.environ.get(variable, default))
+    if path is None:
+        pytest.skip("no " + default + " compiler")
+    return path
+
+
+def build_plugin(directory, name, source):
+    path = os.path.join(directory, "lib" + name + ".so")
+    subprocess.run([compiler("CC", "cc"), "-O2", "-shared", "-fPIC", "-I", INCLUDE, source, "-o", path, "-lm"],
+                   check=True)
+    return path
+
+
+@pytest.fixture(scope="module")
+def build(tmp_path_factory):
+    directory = str(tmp_path_factory.mktemp("runner"))
+    runner = os.environ.get("DE_RUNNER")
+    if not runner:
+        runner = os.path.join(directory, "DE")
+        subprocess.run([compiler("CXX", "c++"), "-std=c++17", "-O2", "-pthread",
+                        os.path.join(SOURCE, "main.cpp"), "-o", runner, "-ldl"], check=True)
+    plugin = os.environ.get("DE_PLUGIN") or build_plugin(directory, "rastrigin",
+                                                         os.path.join(SOURCE, "plugins", "rastrigin.c"))
+    return directory, runner, plugin
+
+
+def run(runner, *args):
+    return subprocess.run([runner] + [str(a) for a in args], capture_output=True, text=True, timeout=120)
+
+
+class TestRunner:
+
+    def test_plugin_run_writes_json(self, build):
+        """One run per seed, with the plugin's name and a summary over the seeds"""
+        directory, runner, plugin = build
+        output = os.path.join(directory, "results.json")
+        process = run(runner, "--plugin", plugin, "--objective", "sphere", "--dimension", 3,
+                      "--generations", 200, "--seeds", "1-3", "--output", output)
+        assert process.returncode == 0, process.stderr
+        with open(output) as f:
+            results = json.load(f)
+        assert results["objective"]["name"] == "sphere"
+        assert results["objective"]["dimension"] == 3
+        assert [r["seed"] for r in results["runs"]] == [1, 2, 3]
+        for r in results["runs"]:
+            assert len(r["bestAgent"]) == 3
+            assert r["bestCost"] == pytest.approx(sum(v * v for v in r["bestAgent"]))
+            assert r["stopReason"] == "generations"
+            assert r["evaluations"] > 0
+        assert results["summary"]["runs"] == 3
+        assert results["summary"]["bestCost"] == min(r["bestCost"] for r in results["runs"])
+        assert results["summary"]["bestCost"] < 1e-3
+
+    def test_batch_and_threads(self, build):
+        """Batch mode uses evaluateBatch; the JSON goes to standard output by default"""
+        _, runner, plugin = build
+        for args in (("--mode", "batch"), ("--threads", 2)):
+            process = run(runner, "--plugin", plugin, "--dimension", 2, "--generations", 50, *args)
+            assert process.returncode == 0, process.stderr
+            results = json.loads(process.stdout)
+            assert results["objective"]["name"] == "rastrigin"
+            assert len(results["runs"]) == 1
+
+    def test_config_file(self, build):
+        """Flags override the config file"""
+        directory, runner, plugin = build
+        config = os.path.join(directory, "run.cfg")
+        with open(config, "w") as f:
+            f.write("# sphere in 2D\nplugin = %s\nobjective = sphere\ndimension = 2\ngenerations = 10\n"
+                "strategy = rand1bin\n" % plugin)
+        process = run(runner, "--config", config, "--dimension", 4)
+        assert process.returncode == 0, process.stderr
+        results = json.loads(process.stdout)
+        assert results["objective"]["dimension"] == 4
+        assert results["config"]["generations"] == 10
+        assert results["config"]["strategy"] == "rand1bin"
+
+    def test_errors(self, build):
+        """Every error exits with status 2 and a message naming its cause"""
+        directory, runner, plugin = build
+        cases = [
+            (("--plugin", os.path.join(directory, "missing.so")), "cannot load"),
+            (("--plugin", plugin, "--objective", "nosuch"), "has no objective \"nosuch\""),
+            (("--plugin", build_plugin(directory, "future", write(directory, "future.c", ABI_MISMATCH))),
+             "ABI version"),
+            (("--plugin", build_plugin(directory, "failing", write(directory, "failing.c", CREATE_FAILS))),
+             "no such configuration"),
+            (("--plugin", build_plugin(directory, "half", write(directory, "half.c", HALF_BOUNDED)),
+              "--dimension", 2), "parameter 1 must be bounded on both sides or on neither"),
+            (("--dimension", "abc"), "invalid value \"abc\" for dimension"),
+            (("--dimension", "-1"), "invalid value \"-1\" for dimension"),
+            (("--F", "0.5x"), "invalid value \"0.5x\" for F"),
+            (("--seeds", "1,x"), "invalid value \"x\" for seeds"),
+            (("--strategy", "best1bin"), "unknown strategy \"best1bin\" (only rand1bin is available)"),
+            (("--frobnicate", 1), "unknown option"),
+        ]
+        for args, message in cases:
+            process = run(runner, "--generations", 1, *args)
+            assert process.returncode == 2, (args, process.stdout)
+            assert message in process.stderr, (args, process.stderr)
+            assert process.stdout == ""
+
+
+def write(directory, name, text):
+    path = os.path.join(directory, name)
+    with open(path, "w") as f:
+        f.write(text)
+    return path